@@ -1,8 +1,9 @@
 #version 450
 
-layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 colour;
-layout(location = 2) in vec3 normal;
+// Compact vertex (Model::PackedVertex + Model::ColourVertex)
+layout(location = 0) in vec4 position; // Quantised to the mesh bounds, modelMatrix dequantises
+layout(location = 1) in vec4 colour;
+layout(location = 2) in vec2 normalOct; // Octahedral encoded
 layout(location = 3) in vec2 UV;
 
 layout(location = 0) out vec3 outFragColour;
@@ -37,16 +38,24 @@ layout(push_constant) uniform PushConstants
     mat4 prevModel;
 } push;
 
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
 void main()
 {
-    vec4 positionToWorld = push.modelMatrix * vec4(position, 1.0);
-    vec4 prevPositionToWorld = push.prevModel * vec4(position, 1.0);
+    vec4 positionToWorld = push.modelMatrix * vec4(position.xyz, 1.0);
+    vec4 prevPositionToWorld = push.prevModel * vec4(position.xyz, 1.0);
     outCurrClip = ubo.projection * (ubo.view * positionToWorld);
     outPrevClip = ubo.prevProjection * (ubo.prevView * prevPositionToWorld);
 
     gl_Position = outCurrClip;
 
-    outFragNormalWorld = normalize(mat3(push.normalMatrix) * normal);
+    outFragNormalWorld = normalize(mat3(push.normalMatrix) * decodeOctahedral(normalOct));
     outPosWorld = positionToWorld.xyz;
-    outFragColour = colour;
+    outFragColour = colour.rgb;
 }
\ No newline at end of file
@@ -1,10 +1,24 @@
 C:\VulkanSDK\1.4.313.2\Bin\glslc.exe Shaders\Basic\Vertex.vert -o Shaders\Basic\Vertex.vert.spv
+C:\VulkanSDK\1.4.313.2\Bin\spirv-val.exe --target-env vulkan1.3 Shaders\Basic\Vertex.vert.spv
 C:\VulkanSDK\1.4.313.2\Bin\glslc.exe Shaders\Basic\Fragment.frag -o Shaders\Basic\Fragment.frag.spv
+C:\VulkanSDK\1.4.313.2\Bin\spirv-val.exe --target-env vulkan1.3 Shaders\Basic\Fragment.frag.spv
 
 C:\VulkanSDK\1.4.313.2\Bin\glslc.exe Shaders\PointLight.vert -o Shaders\PointLight.vert.spv
+C:\VulkanSDK\1.4.313.2\Bin\spirv-val.exe --target-env vulkan1.3 Shaders\PointLight.vert.spv
 C:\VulkanSDK\1.4.313.2\Bin\glslc.exe Shaders\PointLight.frag -o Shaders\PointLight.frag.spv
+C:\VulkanSDK\1.4.313.2\Bin\spirv-val.exe --target-env vulkan1.3 Shaders\PointLight.frag.spv
 
 C:\VulkanSDK\1.4.313.2\Bin\glslc.exe Shaders\TextureShader.vert -o Shaders\TextureShader.vert.spv
+C:\VulkanSDK\1.4.313.2\Bin\spirv-val.exe --target-env vulkan1.3 Shaders\TextureShader.vert.spv
 C:\VulkanSDK\1.4.313.2\Bin\glslc.exe Shaders\TextureShader.frag -o Shaders\TextureShader.frag.spv
+C:\VulkanSDK\1.4.313.2\Bin\spirv-val.exe --target-env vulkan1.3 Shaders\TextureShader.frag.spv
+
+C:\VulkanSDK\1.4.313.2\Bin\glslc.exe Shaders\MeshletCull.comp -o Shaders\MeshletCull.comp.spv
+C:\VulkanSDK\1.4.313.2\Bin\spirv-val.exe --target-env vulkan1.3 Shaders\MeshletCull.comp.spv
+
+C:\VulkanSDK\1.4.313.2\Bin\glslc.exe Shaders\Upscale.comp -o Shaders\Upscale.comp.spv
+C:\VulkanSDK\1.4.313.2\Bin\spirv-val.exe --target-env vulkan1.3 Shaders\Upscale.comp.spv
+C:\VulkanSDK\1.4.313.2\Bin\glslc.exe Shaders\Sharpen.comp -o Shaders\Sharpen.comp.spv
+C:\VulkanSDK\1.4.313.2\Bin\spirv-val.exe --target-env vulkan1.3 Shaders\Sharpen.comp.spv
 
 pause
\ No newline at end of file
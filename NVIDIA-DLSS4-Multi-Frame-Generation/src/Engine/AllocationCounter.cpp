@@ -0,0 +1,83 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifndef NDEBUG
+namespace
+{
+    std::atomic<uint64_t> g_allocationCount{ 0 };
+
+    void* countedAlloc(size_t _size)
+    {
+        g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        if (_size == 0) _size = 1;
+        if (void* ptr = std::malloc(_size))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void* countedAlignedAlloc(size_t _size, std::align_val_t _alignment)
+    {
+        g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        size_t alignment = static_cast<size_t>(_alignment);
+        if (_size == 0) _size = alignment;
+#ifdef _WIN32
+        void* ptr = _aligned_malloc(_size, alignment);
+#else
+        void* ptr = std::aligned_alloc(alignment, (_size + alignment - 1) & ~(alignment - 1));
+#endif
+        if (ptr) return ptr;
+        throw std::bad_alloc();
+    }
+
+    void alignedFree(void* _ptr)
+    {
+#ifdef _WIN32
+        _aligned_free(_ptr);
+#else
+        std::free(_ptr);
+#endif
+    }
+}
+
+// Replacement global allocation functions, debug builds only
+void* operator new(size_t _size) { return countedAlloc(_size); }
+void* operator new[](size_t _size) { return countedAlloc(_size); }
+void* operator new(size_t _size, const std::nothrow_t&) noexcept
+{
+    try { return countedAlloc(_size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t _size, const std::nothrow_t&) noexcept
+{
+    try { return countedAlloc(_size); } catch (...) { return nullptr; }
+}
+void* operator new(size_t _size, std::align_val_t _alignment) { return countedAlignedAlloc(_size, _alignment); }
+void* operator new[](size_t _size, std::align_val_t _alignment) { return countedAlignedAlloc(_size, _alignment); }
+
+void operator delete(void* _ptr) noexcept { std::free(_ptr); }
+void operator delete[](void* _ptr) noexcept { std::free(_ptr); }
+void operator delete(void* _ptr, size_t) noexcept { std::free(_ptr); }
+void operator delete[](void* _ptr, size_t) noexcept { std::free(_ptr); }
+void operator delete(void* _ptr, const std::nothrow_t&) noexcept { std::free(_ptr); }
+void operator delete[](void* _ptr, const std::nothrow_t&) noexcept { std::free(_ptr); }
+void operator delete(void* _ptr, std::align_val_t) noexcept { alignedFree(_ptr); }
+void operator delete[](void* _ptr, std::align_val_t) noexcept { alignedFree(_ptr); }
+void operator delete(void* _ptr, size_t, std::align_val_t) noexcept { alignedFree(_ptr); }
+void operator delete[](void* _ptr, size_t, std::align_val_t) noexcept { alignedFree(_ptr); }
+#endif
+
+namespace Engine
+{
+    namespace AllocationCounter
+    {
+#ifndef NDEBUG
+        bool isEnabled() { return true; }
+        uint64_t totalAllocations() { return g_allocationCount.load(std::memory_order_relaxed); }
+#else
+        bool isEnabled() { return false; }
+        uint64_t totalAllocations() { return 0; }
+#endif
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+namespace Engine
+{
+    /*
+     * Counts calls to the global operator new. Only active in debug builds,
+     * where AllocationCounter.cpp replaces the global allocation functions.
+     */
+    namespace AllocationCounter
+    {
+        bool isEnabled();
+        uint64_t totalAllocations();
+    }
+}
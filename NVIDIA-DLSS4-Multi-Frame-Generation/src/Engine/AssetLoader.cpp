@@ -0,0 +1,171 @@
+#include "AssetLoader.h"
+
+#include <cstdio>
+#include <iostream>
+
+namespace Engine
+{
+    AssetLoader::AssetLoader(EngineDevice& _device, uint32_t _threadCount) :
+        m_device(_device),
+        m_pool(_threadCount)
+    {
+    }
+
+    void AssetLoader::beginBatch()
+    {
+        if (pendingCount() == 0)
+        {
+            m_batchStart = std::chrono::high_resolution_clock::now();
+            m_batchSize = 0;
+        }
+        m_batchSize++;
+    }
+
+    AssetHandle<Model> AssetLoader::loadModel(const std::string& _filePath)
+    {
+        const std::string key = AssetRegistry::makeKey("model", _filePath, 0);
+        if (auto state = m_registry.find<Model>(key))
+            return { state };
+
+        auto state = std::make_shared<AssetHandle<Model>::State>();
+        state->m_path = _filePath;
+        m_registry.insert(key, state);
+        beginBatch();
+
+        m_pendingModels.push_back({ key, state, m_pool.submit([_filePath]()
+            {
+                // Single threaded parse, the pool already runs one load per worker
+                auto prepared = std::make_unique<PreparedMesh>();
+                prepared->m_view = prepared->m_cache.openOrBuild(_filePath, prepared->m_packed, 1);
+                return prepared;
+            }) });
+        return { state };
+    }
+
+    AssetHandle<Texture> AssetLoader::loadTexture(const std::string& _filePath, bool _preferCompressed)
+    {
+        const std::string key = AssetRegistry::makeKey("texture", _filePath, _preferCompressed ? 0 : 1);
+        if (auto state = m_registry.find<Texture>(key))
+            return { state };
+
+        auto state = std::make_shared<AssetHandle<Texture>::State>();
+        state->m_path = _filePath;
+        m_registry.insert(key, state);
+        beginBatch();
+
+        m_pendingTextures.push_back({ key, state, m_pool.submit([&device = m_device, _filePath, _preferCompressed]()
+            {
+                auto source = std::make_unique<Texture::SourceImage>();
+                Texture::loadSource(device, _filePath, *source, _preferCompressed);
+                return source;
+            }) });
+        return { state };
+    }
+
+    void AssetLoader::onReady(const AssetHandle<Model>& _handle, std::function<void(const std::shared_ptr<Model>&)> _callback)
+    {
+        if (_handle.isReady())
+            _callback(_handle.get());
+        else if (!_handle.hasFailed())
+            _handle.m_state->m_onReady.push_back(std::move(_callback));
+    }
+
+    void AssetLoader::onReady(const AssetHandle<Texture>& _handle, std::function<void(const std::shared_ptr<Texture>&)> _callback)
+    {
+        if (_handle.isReady())
+            _callback(_handle.get());
+        else if (!_handle.hasFailed())
+            _handle.m_state->m_onReady.push_back(std::move(_callback));
+    }
+
+    std::shared_ptr<Model> AssetLoader::createResource(const PreparedMesh& _prepared)
+    {
+        return std::make_shared<Model>(m_device, _prepared.m_view);
+    }
+
+    std::shared_ptr<Texture> AssetLoader::createResource(const Texture::SourceImage& _prepared)
+    {
+        return std::make_shared<Texture>(m_device, _prepared);
+    }
+
+    template<typename T, typename Prepared>
+    bool AssetLoader::finish(Pending<T, Prepared>& _pending)
+    {
+        if (_pending.m_prepared.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+
+        auto& state = *_pending.m_state;
+        try
+        {
+            std::unique_ptr<Prepared> prepared = _pending.m_prepared.get();
+            state.m_resource = createResource(*prepared);
+            state.m_residentBytes = state.m_resource->getMemorySize();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Failed to load " << state.m_path << ": " << e.what() << std::endl;
+            state.m_failed = true;
+            state.m_onReady.clear();
+            m_registry.erase(_pending.m_key);
+            return true;
+        }
+
+        // Callbacks first, so the references they take keep the new asset from being evicted straight away
+        for (auto& callback : state.m_onReady)
+            callback(state.m_resource);
+        state.m_onReady.clear();
+        m_registry.onResident(state);
+        return true;
+    }
+
+    uint32_t AssetLoader::update(uint32_t _maxUploads)
+    {
+        // Users let go of assets without telling the registry, so the budget is checked every frame,
+        // not only when the next load becomes resident
+        m_registry.evict();
+        if (pendingCount() == 0) return 0;
+
+        uint32_t uploads = 0;
+        auto pump = [&](auto& _pending)
+        {
+            for (size_t i = 0; i < _pending.size() && uploads < _maxUploads;)
+            {
+                if (finish(_pending[i]))
+                {
+                    if (i + 1 != _pending.size())
+                        _pending[i] = std::move(_pending.back());
+                    _pending.pop_back();
+                    uploads++;
+                }
+                else
+                {
+                    i++;
+                }
+            }
+        };
+        pump(m_pendingModels);
+        pump(m_pendingTextures);
+
+        if (pendingCount() == 0)
+        {
+            const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_batchStart).count();
+            std::printf("%u assets resident in %.1f ms (%u loader threads)\n", m_batchSize, milliseconds, m_pool.threadCount());
+        }
+        return uploads;
+    }
+
+    void AssetLoader::waitAll()
+    {
+        while (pendingCount() > 0)
+        {
+            // Upload whatever is done first, then block on the oldest remaining load
+            if (update() == 0)
+            {
+                if (!m_pendingModels.empty())
+                    m_pendingModels.front().m_prepared.wait();
+                else
+                    m_pendingTextures.front().m_prepared.wait();
+            }
+        }
+    }
+}
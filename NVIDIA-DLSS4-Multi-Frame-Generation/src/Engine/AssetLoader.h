@@ -0,0 +1,86 @@
+#pragma once
+#include "AssetRegistry.h"
+#include "MeshCache.h"
+#include "Texture.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    /*
+     * Loads models and textures in the background. File reads, OBJ parsing, mesh processing and
+     * image decoding run on a thread pool. Buffer and image creation stays on the main thread,
+     * because the device's single time command pool isn't thread safe. update() creates the GPU
+     * resources of finished loads each frame and runs their onReady callbacks, so scenes can be
+     * built with empty placeholders and fill in as assets become resident.
+     * Requests go through an AssetRegistry first, so a file already loading or resident, including
+     * one left over from a previous scene, shares its handle instead of loading again.
+     */
+    struct AssetLoader
+    {
+        AssetLoader(EngineDevice& _device, uint32_t _threadCount = 0);
+
+        AssetLoader(const AssetLoader&) = delete;
+        AssetLoader& operator=(const AssetLoader&) = delete;
+
+        AssetHandle<Model> loadModel(const std::string& _filePath);
+        // _preferCompressed picks up an up to date KTX2 next to the file, see Texture::loadSource
+        AssetHandle<Texture> loadTexture(const std::string& _filePath, bool _preferCompressed = true);
+
+        // _callback runs on the main thread inside update(), or immediately when already resident
+        void onReady(const AssetHandle<Model>& _handle, std::function<void(const std::shared_ptr<Model>&)> _callback);
+        void onReady(const AssetHandle<Texture>& _handle, std::function<void(const std::shared_ptr<Texture>&)> _callback);
+
+        // Main thread, once per frame. Evicts down to the registry's budget, then uploads up to _maxUploads
+        // finished loads, returns how many were uploaded
+        uint32_t update(uint32_t _maxUploads = UINT32_MAX);
+        // Main thread. Blocks until every request is resident or failed
+        void waitAll();
+
+        size_t pendingCount() const { return m_pendingModels.size() + m_pendingTextures.size(); }
+        AssetRegistry& registry() { return m_registry; }
+        const AssetRegistry& registry() const { return m_registry; }
+        uint32_t threadCount() const { return m_pool.threadCount(); }
+
+    private:
+        // CPU results, uploaded by update()
+        struct PreparedMesh
+        {
+            MeshCache m_cache;
+            Model::PackedData m_packed;
+            Model::PackedView m_view{};
+        };
+
+        template<typename T, typename Prepared>
+        struct Pending
+        {
+            std::string m_key;
+            std::shared_ptr<typename AssetHandle<T>::State> m_state;
+            std::future<std::unique_ptr<Prepared>> m_prepared;
+        };
+
+        // Creates the GPU resource once the CPU work is done. False while it is still running
+        template<typename T, typename Prepared>
+        bool finish(Pending<T, Prepared>& _pending);
+        std::shared_ptr<Model> createResource(const PreparedMesh& _prepared);
+        std::shared_ptr<Texture> createResource(const Texture::SourceImage& _prepared);
+        void beginBatch();
+
+        EngineDevice& m_device;
+        ThreadPool m_pool;
+
+        AssetRegistry m_registry;
+        std::vector<Pending<Model, PreparedMesh>> m_pendingModels;
+        std::vector<Pending<Texture, Texture::SourceImage>> m_pendingTextures;
+
+        // Time from the first request of a batch until nothing is pending, logged by update()
+        std::chrono::high_resolution_clock::time_point m_batchStart;
+        uint32_t m_batchSize = 0;
+    };
+}
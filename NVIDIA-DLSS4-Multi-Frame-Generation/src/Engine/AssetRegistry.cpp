@@ -0,0 +1,82 @@
+#include "AssetRegistry.h"
+
+#include <cctype>
+#include <filesystem>
+
+namespace Engine
+{
+    std::string AssetRegistry::makeKey(const char* _type, const std::string& _path, uint64_t _settings)
+    {
+        // Different spellings of one file ("./a/../b.png", "b.png") resolve to the same key
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::absolute(_path, error);
+        if (!error)
+            canonical = std::filesystem::weakly_canonical(canonical, error);
+        if (error)
+            canonical = std::filesystem::path(_path).lexically_normal();
+
+        std::string path = canonical.generic_string();
+#ifdef _WIN32
+        for (char& c : path)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+#endif
+        return std::string(_type) + ":" + std::to_string(_settings) + ":" + path;
+    }
+
+    std::shared_ptr<AssetStateBase> AssetRegistry::findState(const std::string& _key)
+    {
+        auto found = m_entries.find(_key);
+        if (found == m_entries.end())
+        {
+            m_stats.m_misses++;
+            return nullptr;
+        }
+
+        m_stats.m_hits++;
+        m_lru.splice(m_lru.begin(), m_lru, found->second.m_lruPosition);
+        return found->second.m_state;
+    }
+
+    void AssetRegistry::insert(const std::string& _key, std::shared_ptr<AssetStateBase> _state)
+    {
+        m_lru.push_front(_key);
+        m_entries[_key] = { std::move(_state), m_lru.begin() };
+        m_stats.m_entries = m_entries.size();
+    }
+
+    void AssetRegistry::onResident(const AssetStateBase& _state)
+    {
+        m_stats.m_residentBytes += _state.m_residentBytes;
+        evict();
+    }
+
+    void AssetRegistry::erase(const std::string& _key)
+    {
+        auto found = m_entries.find(_key);
+        if (found == m_entries.end()) return;
+
+        m_stats.m_residentBytes -= found->second.m_state->m_residentBytes;
+        m_lru.erase(found->second.m_lruPosition);
+        m_entries.erase(found);
+        m_stats.m_entries = m_entries.size();
+    }
+
+    void AssetRegistry::evict()
+    {
+        // Walk from the least recently used end. Referenced and still loading entries are skipped
+        for (auto it = m_lru.end(); m_stats.m_residentBytes > m_budget && it != m_lru.begin();)
+        {
+            --it;
+            auto entry = m_entries.find(*it);
+            const AssetStateBase& state = *entry->second.m_state;
+            const bool loading = state.m_residentBytes == 0 && !state.m_failed;
+            if (loading || state.isReferenced()) continue;
+
+            m_stats.m_residentBytes -= state.m_residentBytes;
+            m_stats.m_evictions++;
+            m_entries.erase(entry);
+            it = m_lru.erase(it);
+        }
+        m_stats.m_entries = m_entries.size();
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+    // Type independent part of an asset's shared state, what the registry needs for eviction
+    struct AssetStateBase
+    {
+        virtual ~AssetStateBase() = default;
+
+        // True while anything besides this state holds the resource
+        virtual bool isReferenced() const = 0;
+
+        std::string m_path;
+        bool m_failed = false;
+        VkDeviceSize m_residentBytes = 0; // Set once the resource is created
+    };
+
+    // Shared handle to an asset that may still be loading. get() is null until the asset is
+    // resident, and stays null if loading failed
+    template<typename T>
+    struct AssetHandle
+    {
+        struct State : AssetStateBase
+        {
+            bool isReferenced() const override { return m_resource.use_count() > 1; }
+
+            std::shared_ptr<T> m_resource;
+            std::vector<std::function<void(const std::shared_ptr<T>&)>> m_onReady;
+        };
+
+        std::shared_ptr<T> get() const { return m_state ? m_state->m_resource : nullptr; }
+        bool isReady() const { return m_state && m_state->m_resource != nullptr; }
+        bool hasFailed() const { return m_state && m_state->m_failed; }
+        explicit operator bool() const { return m_state != nullptr; }
+
+        std::shared_ptr<State> m_state;
+    };
+
+    /*
+     * Asset states keyed by type, canonical path and import settings, so every request for the
+     * same file shares one load and one GPU resource. Resident assets stay cached after their
+     * last user lets go, and once the cache passes its budget the least recently requested ones
+     * that nothing references are dropped.
+     */
+    struct AssetRegistry
+    {
+        static constexpr VkDeviceSize DEFAULT_BUDGET = 256ull * 1024 * 1024;
+
+        struct Stats
+        {
+            uint64_t m_hits = 0;
+            uint64_t m_misses = 0;
+            uint64_t m_evictions = 0;
+            size_t m_entries = 0;
+            VkDeviceSize m_residentBytes = 0;
+        };
+
+        explicit AssetRegistry(VkDeviceSize _budget = DEFAULT_BUDGET) : m_budget(_budget) {}
+
+        AssetRegistry(const AssetRegistry&) = delete;
+        AssetRegistry& operator=(const AssetRegistry&) = delete;
+
+        // _type separates asset kinds sharing a file, _settings is a hash of the import
+        // settings that change the loaded result, 0 for defaults
+        static std::string makeKey(const char* _type, const std::string& _path, uint64_t _settings);
+
+        // Counts a hit and marks the entry as most recently used, or counts a miss and returns null
+        template<typename T>
+        std::shared_ptr<typename AssetHandle<T>::State> find(const std::string& _key)
+        {
+            return std::static_pointer_cast<typename AssetHandle<T>::State>(findState(_key));
+        }
+
+        void insert(const std::string& _key, std::shared_ptr<AssetStateBase> _state);
+
+        // Call when an entry's resource was created and its first users hold it, then evicts down to the budget
+        void onResident(const AssetStateBase& _state);
+        // Drops an entry whose load failed, so the next request tries again
+        void erase(const std::string& _key);
+
+        // Drops unreferenced entries, least recently used first, while over the budget. Cheap when under it,
+        // AssetLoader::update() calls it every frame to catch entries whose last user has let go
+        void evict();
+        void setBudget(VkDeviceSize _budget) { m_budget = _budget; evict(); }
+
+        const Stats& stats() const { return m_stats; }
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<AssetStateBase> m_state;
+            std::list<std::string>::iterator m_lruPosition;
+        };
+
+        std::shared_ptr<AssetStateBase> findState(const std::string& _key);
+
+        std::unordered_map<std::string, Entry> m_entries;
+        std::list<std::string> m_lru; // Most recently used first
+        VkDeviceSize m_budget;
+        Stats m_stats;
+    };
+}
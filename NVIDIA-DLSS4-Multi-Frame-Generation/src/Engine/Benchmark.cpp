@@ -0,0 +1,558 @@
+#include "Benchmark.h"
+#include "GameObject.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include "Utils.h"
+#include "VertexDedupe.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+    namespace
+    {
+        using Clock = std::chrono::high_resolution_clock;
+
+        double elapsedMs(Clock::time_point _start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - _start).count();
+        }
+
+        // Same per-object work the frame loop does: move it and snapshot its model matrix
+        void updateObject(GameObject& _obj, float _dt)
+        {
+            _obj.m_transform.m_translation.x += _dt;
+            _obj.m_transform.m_rotation.y += _dt;
+            _obj.m_transform.m_prevModelMatrix = _obj.m_transform.mat4();
+        }
+
+        GameObject makeObject(size_t _i)
+        {
+            GameObject obj = GameObject::createGameObject();
+            obj.m_transform.m_translation = { static_cast<float>(_i % 1000), 0.0f, static_cast<float>(_i / 1000) };
+            return obj;
+        }
+
+        struct StorageTimes
+        {
+            double m_iterateMs = 0.0;
+            double m_lookupMs = 0.0;
+            double m_churnMs = 0.0;
+            float m_checksum = 0.0f;
+        };
+
+        StorageTimes benchUnorderedMap(size_t _count, int _passes, const std::vector<uint32_t>& _lookupOrder)
+        {
+            StorageTimes times;
+            std::unordered_map<uint32_t, GameObject> objects;
+            for (uint32_t i = 0; i < _count; i++)
+                objects.emplace(i, makeObject(i));
+
+            auto start = Clock::now();
+            for (int pass = 0; pass < _passes; pass++)
+                for (auto& [id, obj] : objects)
+                    updateObject(obj, 0.001f);
+            times.m_iterateMs = elapsedMs(start) / _passes;
+
+            start = Clock::now();
+            for (uint32_t i : _lookupOrder)
+                objects.find(i)->second.m_transform.m_translation.y += 1.0f;
+            times.m_lookupMs = elapsedMs(start);
+
+            // Replace a tenth of the scene, like a streaming or spawning heavy frame
+            start = Clock::now();
+            uint32_t nextId = static_cast<uint32_t>(_count);
+            for (size_t i = 0; i < _count / 10; i++)
+            {
+                objects.erase(_lookupOrder[i]);
+                objects.emplace(nextId++, makeObject(i));
+            }
+            times.m_churnMs = elapsedMs(start);
+
+            for (auto& [id, obj] : objects)
+                times.m_checksum += obj.m_transform.m_translation.x;
+            return times;
+        }
+
+        StorageTimes benchSlotMap(size_t _count, int _passes, const std::vector<uint32_t>& _lookupOrder)
+        {
+            StorageTimes times;
+            GameObject::Map objects;
+            std::vector<GameObject::id_t> ids;
+            ids.reserve(_count);
+            for (size_t i = 0; i < _count; i++)
+                ids.push_back(objects.insert(makeObject(i)));
+
+            auto start = Clock::now();
+            for (int pass = 0; pass < _passes; pass++)
+                for (GameObject& obj : objects)
+                    updateObject(obj, 0.001f);
+            times.m_iterateMs = elapsedMs(start) / _passes;
+
+            start = Clock::now();
+            for (uint32_t i : _lookupOrder)
+                objects.get(ids[i])->m_transform.m_translation.y += 1.0f;
+            times.m_lookupMs = elapsedMs(start);
+
+            start = Clock::now();
+            for (size_t i = 0; i < _count / 10; i++)
+            {
+                objects.erase(ids[_lookupOrder[i]]);
+                objects.insert(makeObject(i));
+            }
+            times.m_churnMs = elapsedMs(start);
+
+            for (GameObject& obj : objects)
+                times.m_checksum += obj.m_transform.m_translation.x;
+            return times;
+        }
+
+        // Stand-in for the staging buffer write, so both paths end with the bytes the GPU needs
+        size_t copyToStaging(const Model::PackedView& _mesh, std::vector<uint8_t>& _staging)
+        {
+            size_t vertexBytes = size_t(_mesh.m_vertexCount) * sizeof(Model::PackedVertex);
+            size_t colourBytes = size_t(_mesh.m_colourCount) * sizeof(Model::ColourVertex);
+            size_t indexBytes = size_t(_mesh.m_indexCount) * _mesh.m_indexSize;
+            _staging.resize(vertexBytes + colourBytes + indexBytes);
+            if (vertexBytes) std::memcpy(_staging.data(), _mesh.m_vertices, vertexBytes);
+            if (colourBytes) std::memcpy(_staging.data() + vertexBytes, _mesh.m_colours, colourBytes);
+            if (indexBytes) std::memcpy(_staging.data() + vertexBytes + colourBytes, _mesh.m_indices, indexBytes);
+            return _staging.size();
+        }
+
+        // The loaders' previous dedupe: hashCombine over std::hash of each field, count() then operator[]
+        struct LegacyVertexHash
+        {
+            size_t operator()(const Model::Vertex& _vertex) const
+            {
+                size_t seed = 0;
+                hashCombine(seed, _vertex.m_position, _vertex.m_colour, _vertex.m_normal, _vertex.m_uv);
+                return seed;
+            }
+        };
+
+        void dedupeLegacy(const std::vector<Model::Vertex>& _corners, Model::Data& _outData)
+        {
+            std::unordered_map<Model::Vertex, uint32_t, LegacyVertexHash> uniqueVertices{};
+            for (const Model::Vertex& vertex : _corners)
+            {
+                if (uniqueVertices.count(vertex) == 0)
+                {
+                    uniqueVertices[vertex] = static_cast<uint32_t>(_outData.m_vertices.size());
+                    _outData.m_vertices.push_back(vertex);
+                }
+                _outData.m_indices.push_back(uniqueVertices[vertex]);
+            }
+        }
+
+        void dedupeOpenAddressing(const std::vector<Model::Vertex>& _corners, Model::Data& _outData)
+        {
+            _outData.m_indices.reserve(_corners.size());
+            VertexDedupe uniqueVertices(_outData.m_vertices, _corners.size());
+            for (const Model::Vertex& vertex : _corners)
+                _outData.m_indices.push_back(uniqueVertices.insert(vertex));
+        }
+
+        // Unindexed corners of a _size x _size grid, two triangles per cell, like a loader sees before dedupe
+        std::vector<Model::Vertex> gridCorners(uint32_t _size)
+        {
+            std::vector<Model::Vertex> corners;
+            corners.reserve(size_t(_size) * _size * 6);
+            auto corner = [_size](uint32_t _x, uint32_t _y)
+            {
+                Model::Vertex vertex{};
+                vertex.m_position = { static_cast<float>(_x), std::sin(_x * 0.1f) * std::cos(_y * 0.1f), static_cast<float>(_y) };
+                vertex.m_colour = { 1.0f, 1.0f, 1.0f };
+                vertex.m_normal = glm::normalize(glm::vec3(std::sin(_x * 0.3f), 1.0f, std::cos(_y * 0.3f)));
+                vertex.m_uv = { _x / static_cast<float>(_size), _y / static_cast<float>(_size) };
+                return vertex;
+            };
+            for (uint32_t y = 0; y < _size; y++)
+            {
+                for (uint32_t x = 0; x < _size; x++)
+                {
+                    corners.insert(corners.end(), { corner(x, y), corner(x + 1, y), corner(x + 1, y + 1) });
+                    corners.insert(corners.end(), { corner(x, y), corner(x + 1, y + 1), corner(x, y + 1) });
+                }
+            }
+            return corners;
+        }
+
+        void benchDedupe(const std::string& _name, const std::vector<Model::Vertex>& _corners)
+        {
+            constexpr int RUNS = 3;
+            double legacyMs = 1.0e30;
+            double openMs = 1.0e30;
+            Model::Data legacy;
+            Model::Data open;
+            for (int run = 0; run < RUNS; run++)
+            {
+                legacy = {};
+                auto start = Clock::now();
+                dedupeLegacy(_corners, legacy);
+                legacyMs = std::min(legacyMs, elapsedMs(start));
+
+                open = {};
+                start = Clock::now();
+                dedupeOpenAddressing(_corners, open);
+                openMs = std::min(openMs, elapsedMs(start));
+            }
+
+            const double millions = _corners.size() / 1.0e6;
+            bool parity = legacy.m_indices == open.m_indices && legacy.m_vertices == open.m_vertices;
+            std::printf("%-40s %10zu %10zu %14.2f %14.2f %9.1fx %s\n", _name.c_str(), _corners.size(), open.m_vertices.size(),
+                legacyMs / millions, openMs / millions, legacyMs / openMs, parity ? "match" : "MISMATCH");
+        }
+
+        void benchMeshOptimizer(const std::string& _name, Model::Data _data)
+        {
+            const size_t indexBytesBefore = _data.m_indices.size() * sizeof(uint32_t);
+            MeshOptimizer::Report report = MeshOptimizer::optimize(_data);
+
+            Model::PackedData packed;
+            packed.pack(_data);
+            const Model::PackedView view = packed.view();
+
+            std::printf("%-40s %10zu %8.3f %8.3f %8.3f %8.3f %10.1f %7zu -> %zu KB\n", _name.c_str(), _data.m_indices.size() / 3,
+                report.m_before.m_acmr, report.m_after.m_acmr, report.m_before.m_atvr, report.m_after.m_atvr, report.m_milliseconds,
+                indexBytesBefore / 1024, size_t(view.m_indexCount) * view.m_indexSize / 1024);
+        }
+
+        void benchMeshLods(const std::string& _name, Model::Data _data)
+        {
+            MeshOptimizer::optimize(_data);
+            auto start = Clock::now();
+            MeshOptimizer::buildLods(_data);
+            const double buildMs = elapsedMs(start);
+
+            glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+            glm::vec3 boundsMax{ std::numeric_limits<float>::lowest() };
+            for (const Model::Vertex& vertex : _data.m_vertices)
+            {
+                boundsMin = glm::min(boundsMin, vertex.m_position);
+                boundsMax = glm::max(boundsMax, vertex.m_position);
+            }
+            const float radius = std::max(glm::length(boundsMax - boundsMin) * 0.5f, 1.0e-6f);
+
+            const std::vector<Model::Lod>& lods = _data.m_lods;
+            std::printf("%s: %zu LODs in %.1f ms\n", _name.c_str(), lods.size(), buildMs);
+            for (size_t lod = 0; lod < lods.size(); lod++)
+            {
+                std::printf("  LOD %zu %10u triangles %6.1f%%   error %.5f (%.3f%% of radius)\n", lod, lods[lod].m_indexCount / 3,
+                    100.0 * lods[lod].m_indexCount / lods[0].m_indexCount, lods[lod].m_error, 100.0f * lods[lod].m_error / radius);
+            }
+
+            // The 100x100 grid scene with 0.25 spacing, each instance scaled to a 0.1 radius,
+            // seen from where the camera pan starts with a 60 degree fov at 1080p
+            const glm::vec3 eye{ 0.0f, -2.5f, -8.5f };
+            const float scale = 0.1f / radius;
+            const float pixelsPerUnit = 1.0f / std::tan(glm::radians(30.0f)) * 1080.0f * 0.5f;
+
+            std::printf("  %-12s %14s   %s\n", "policy", "triangles", "objects per LOD");
+            for (float pixelError : { 0.0f, 0.5f, 1.0f, 2.0f, 4.0f })
+            {
+                uint64_t triangles = 0;
+                uint32_t perLod[Model::MAX_LODS] = {};
+                for (int z = 0; z < 100; z++)
+                {
+                    for (int x = 0; x < 100; x++)
+                    {
+                        const glm::vec3 centre{ (x - 49.5f) * 0.25f, 0.0f, (z - 49.5f) * 0.25f };
+                        const float distance = glm::length(centre - eye) - radius * scale;
+                        uint32_t lod = 0;
+                        if (pixelError > 0.0f && distance > 0.0f)
+                            lod = Model::selectLod(lods.data(), static_cast<uint32_t>(lods.size()), distance, pixelsPerUnit / pixelError * scale);
+                        perLod[lod]++;
+                        triangles += lods[lod].m_indexCount / 3;
+                    }
+                }
+
+                char policy[32];
+                if (pixelError > 0.0f)
+                    std::snprintf(policy, sizeof(policy), "%.1f px", pixelError);
+                else
+                    std::snprintf(policy, sizeof(policy), "off");
+                std::printf("  %-12s %14llu  ", policy, static_cast<unsigned long long>(triangles));
+                for (size_t lod = 0; lod < lods.size(); lod++)
+                    std::printf(" %6u", perLod[lod]);
+                std::printf("\n");
+            }
+        }
+    }
+
+    namespace Benchmark
+    {
+        int run(const std::string& _name, const std::vector<std::string>& _args)
+        {
+            if (_name == "scene")
+            {
+                sceneStorage();
+                return 0;
+            }
+            if (_name == "mesh-load")
+                return meshLoad(_args);
+            if (_name == "obj-parse")
+                return objParse(_args);
+            if (_name == "vertex-dedupe")
+                return vertexDedupe(_args);
+            if (_name == "mesh-opt")
+                return meshOptimize(_args);
+            if (_name == "mesh-lod")
+                return meshLod(_args);
+
+            std::printf("Unknown benchmark '%s'. Available: scene, mesh-load <file.obj>..., obj-parse <file.obj>..., "
+                "vertex-dedupe [file.obj]..., mesh-opt [file.obj]..., mesh-lod [file.obj]...\n", _name.c_str());
+            return 1;
+        }
+
+        void sceneStorage()
+        {
+            std::printf("Scene storage: std::unordered_map vs GameObject::Map (slot map)\n");
+            std::printf("%10s %-14s %12s %12s %12s %12s\n", "objects", "container", "iterate ms", "ns/object", "lookup ms", "churn ms");
+
+            for (size_t count : { size_t(10000), size_t(100000), size_t(1000000) })
+            {
+                // Keep total work roughly constant so the small scenes still get a stable average
+                const int passes = static_cast<int>(std::max<size_t>(3, 10000000 / count));
+
+                std::vector<uint32_t> lookupOrder(count);
+                std::iota(lookupOrder.begin(), lookupOrder.end(), 0u);
+                std::shuffle(lookupOrder.begin(), lookupOrder.end(), std::mt19937(1234));
+
+                StorageTimes mapTimes = benchUnorderedMap(count, passes, lookupOrder);
+                StorageTimes slotTimes = benchSlotMap(count, passes, lookupOrder);
+
+                auto print = [count](const char* _container, const StorageTimes& _times)
+                {
+                    std::printf("%10zu %-14s %12.3f %12.2f %12.3f %12.3f\n", count, _container,
+                        _times.m_iterateMs, _times.m_iterateMs * 1.0e6 / count, _times.m_lookupMs, _times.m_churnMs);
+                };
+                print("unordered_map", mapTimes);
+                print("slot map", slotTimes);
+
+                // Both containers ran identical updates, so a mismatch means one of them skipped objects
+                if (std::abs(mapTimes.m_checksum - slotTimes.m_checksum) > std::abs(mapTimes.m_checksum) * 1.0e-3f)
+                    std::printf("  warning: checksums differ (%f vs %f)\n", mapTimes.m_checksum, slotTimes.m_checksum);
+            }
+        }
+
+        int meshLoad(const std::vector<std::string>& _files)
+        {
+            if (_files.empty())
+            {
+                std::printf("Usage: --bench mesh-load <file.obj>...\n");
+                return 1;
+            }
+
+            constexpr int RUNS = 3;
+            std::vector<uint8_t> staging;
+
+            std::printf("Mesh load: OBJ parse + pack vs mapped mesh cache (best of %d, warm file cache)\n", RUNS);
+            std::printf("%-40s %10s %12s %12s %10s\n", "file", "OBJ MB", "parse ms", "cache ms", "speedup");
+
+            for (const std::string& file : _files)
+            {
+                std::error_code error;
+                double sourceMB = static_cast<double>(std::filesystem::file_size(file, error)) / (1024.0 * 1024.0);
+                if (error)
+                {
+                    std::printf("%-40s missing\n", file.c_str());
+                    continue;
+                }
+
+                double parseMs = 1.0e30;
+                Model::PackedData packed;
+                for (int run = 0; run < RUNS; run++)
+                {
+                    auto start = Clock::now();
+                    Model::Data data;
+                    data.loadModel(file);
+                    MeshOptimizer::optimize(data);
+                    MeshOptimizer::buildLods(data);
+                    packed.pack(data);
+                    copyToStaging(packed.view(), staging);
+                    parseMs = std::min(parseMs, elapsedMs(start));
+                }
+
+                if (!MeshCache::write(file, packed.view()))
+                {
+                    std::printf("%-40s failed to write cache\n", file.c_str());
+                    continue;
+                }
+
+                double cacheMs = 1.0e30;
+                for (int run = 0; run < RUNS; run++)
+                {
+                    auto start = Clock::now();
+                    MeshCache cache;
+                    if (!cache.open(file)) break;
+                    copyToStaging(cache.view(), staging);
+                    cacheMs = std::min(cacheMs, elapsedMs(start));
+                }
+
+                std::printf("%-40s %10.2f %12.2f %12.2f %9.1fx\n", file.c_str(), sourceMB, parseMs, cacheMs, parseMs / cacheMs);
+            }
+            return 0;
+        }
+
+        int objParse(const std::vector<std::string>& _files)
+        {
+            if (_files.empty())
+            {
+                std::printf("Usage: --bench obj-parse <file.obj>...\n");
+                return 1;
+            }
+
+            constexpr int RUNS = 3;
+
+            std::printf("OBJ parse: tinyobjloader vs ObjParser (best of %d, warm file cache)\n", RUNS);
+            std::printf("%-40s %10s %12s %12s %8s %12s %12s %10s %s\n", "file", "MB", "tinyobj ms", "tinyobj MB/s",
+                "threads", "native ms", "native MB/s", "speedup", "parity");
+
+            for (const std::string& file : _files)
+            {
+                std::error_code error;
+                double sourceMB = static_cast<double>(std::filesystem::file_size(file, error)) / (1024.0 * 1024.0);
+                if (error)
+                {
+                    std::printf("%-40s missing\n", file.c_str());
+                    continue;
+                }
+
+                double tinyMs = 1.0e30;
+                Model::Data reference;
+                for (int run = 0; run < RUNS; run++)
+                {
+                    auto start = Clock::now();
+                    reference = {};
+                    reference.loadModelTinyObj(file);
+                    tinyMs = std::min(tinyMs, elapsedMs(start));
+                }
+
+                ObjParser::Stats best;
+                best.m_totalMs = 1.0e30;
+                Model::Data data;
+                for (int run = 0; run < RUNS; run++)
+                {
+                    data = {};
+                    ObjParser::Stats stats = ObjParser::load(file, data);
+                    if (stats.m_totalMs < best.m_totalMs) best = stats;
+                }
+
+                // The renderer must not be able to tell which loader ran
+                bool parity = data.m_indices == reference.m_indices && data.m_vertices == reference.m_vertices;
+
+                std::printf("%-40s %10.2f %12.2f %12.1f %8u %12.2f %12.1f %9.1fx %s\n", file.c_str(), sourceMB, tinyMs, sourceMB / (tinyMs / 1000.0),
+                    best.m_threads, best.m_totalMs, best.megabytesPerSecond(), tinyMs / best.m_totalMs, parity ? "match" : "MISMATCH");
+                std::printf("%-40s %10s parse %.2f ms, build %.2f ms\n", "", "", best.m_parseMs, best.m_buildMs);
+            }
+            return 0;
+        }
+
+        int vertexDedupe(const std::vector<std::string>& _files)
+        {
+            std::printf("Vertex dedupe: std::unordered_map vs VertexDedupe (best of 3)\n");
+            std::printf("%-40s %10s %10s %14s %14s %10s %s\n", "mesh", "indices", "vertices", "legacy ms/M", "open ms/M", "speedup", "parity");
+
+            for (uint32_t size : { 410u, 1000u })
+                benchDedupe("grid " + std::to_string(size) + "x" + std::to_string(size), gridCorners(size));
+
+            // Real meshes, expanded back to one vertex per index
+            for (const std::string& file : _files)
+            {
+                Model::Data data;
+                try
+                {
+                    data.loadModel(file);
+                }
+                catch (const std::exception& e)
+                {
+                    std::printf("%-40s %s\n", file.c_str(), e.what());
+                    continue;
+                }
+
+                std::vector<Model::Vertex> corners;
+                corners.reserve(data.m_indices.size());
+                for (uint32_t index : data.m_indices)
+                    corners.push_back(data.m_vertices[index]);
+                benchDedupe(file, corners);
+            }
+            return 0;
+        }
+
+        int meshOptimize(const std::vector<std::string>& _files)
+        {
+            std::printf("Mesh optimisation: ACMR / ATVR with a %u entry FIFO cache, before -> after\n", MeshOptimizer::CACHE_SIZE);
+            std::printf("%-40s %10s %8s %8s %8s %8s %10s %s\n", "mesh", "triangles", "ACMR", "ACMR'", "ATVR", "ATVR'", "opt ms", "index buffer");
+
+            // Grid in row order, which is already decent, and with its triangles shuffled like a badly exported mesh
+            Model::Data grid;
+            dedupeOpenAddressing(gridCorners(200), grid);
+            benchMeshOptimizer("grid 200x200", grid);
+
+            std::vector<uint32_t> order(grid.m_indices.size() / 3);
+            std::iota(order.begin(), order.end(), 0u);
+            std::shuffle(order.begin(), order.end(), std::mt19937(1234));
+            Model::Data shuffled = grid;
+            for (size_t t = 0; t < order.size(); t++)
+                for (int k = 0; k < 3; k++)
+                    shuffled.m_indices[t * 3 + k] = grid.m_indices[size_t(order[t]) * 3 + k];
+            benchMeshOptimizer("grid 200x200 shuffled", shuffled);
+
+            for (const std::string& file : _files)
+            {
+                Model::Data data;
+                try
+                {
+                    data.loadModel(file);
+                }
+                catch (const std::exception& e)
+                {
+                    std::printf("%-40s %s\n", file.c_str(), e.what());
+                    continue;
+                }
+                benchMeshOptimizer(file, data);
+            }
+            return 0;
+        }
+
+        int meshLod(const std::vector<std::string>& _files)
+        {
+            std::printf("Mesh LODs: quadric simplification, then triangles submitted per LOD policy (allowed error in pixels)\n");
+
+            Model::Data grid;
+            dedupeOpenAddressing(gridCorners(200), grid);
+            benchMeshLods("heightfield 200x200", grid);
+
+            for (const std::string& file : _files)
+            {
+                Model::Data data;
+                try
+                {
+                    data.loadModel(file);
+                }
+                catch (const std::exception& e)
+                {
+                    std::printf("%-40s %s\n", file.c_str(), e.what());
+                    continue;
+                }
+                benchMeshLods(file, data);
+            }
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    /*
+     * Headless micro benchmarks, run with "--bench <name> [args]" instead of opening the window.
+     * Results are printed to stdout.
+     */
+    namespace Benchmark
+    {
+        // Returns the process exit code. An unknown name lists the available benchmarks
+        int run(const std::string& _name, const std::vector<std::string>& _args);
+
+        // Iterate, update and look up 10k-1M game objects: std::unordered_map against GameObject::Map
+        void sceneStorage();
+
+        // OBJ parse + pack against mapping the mesh cache, for each file in _files
+        int meshLoad(const std::vector<std::string>& _files);
+
+        // tinyobjloader against ObjParser in MB/s, checking both produce identical Model::Data
+        int objParse(const std::vector<std::string>& _files);
+
+        // Per million indices, the old std::unordered_map dedupe against VertexDedupe.
+        // Runs on generated grids plus each file in _files
+        int vertexDedupe(const std::vector<std::string>& _files);
+
+        // ACMR and ATVR before and after MeshOptimizer, on generated grids plus each file in _files
+        int meshOptimize(const std::vector<std::string>& _files);
+
+        // LOD chain triangles, error and build time, then the triangles each LOD policy submits for
+        // the 100x100 grid scene. On a generated heightfield plus each file in _files
+        int meshLod(const std::vector<std::string>& _files);
+    }
+}
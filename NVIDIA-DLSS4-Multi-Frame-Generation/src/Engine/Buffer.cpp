@@ -26,7 +26,8 @@ namespace Engine
         uint32_t _instanceCount,
         VkBufferUsageFlags _usageFlags,
         VkMemoryPropertyFlags _memoryPropertyFlags,
-        VkDeviceSize _minOffsetAlignment)
+        VkDeviceSize _minOffsetAlignment,
+        ResourceTag _tag)
         : m_device(_device),
         m_instanceSize(_instanceSize),
         m_instanceCount(_instanceCount),
@@ -35,14 +36,13 @@ namespace Engine
     {
         m_alignmentSize = getAlignment(_instanceSize, _minOffsetAlignment);
         m_bufferSize = m_alignmentSize * _instanceCount;
-        m_device.createBuffer(m_bufferSize, _usageFlags, _memoryPropertyFlags, m_buffer, m_memory);
+        m_device.createBuffer(m_bufferSize, _usageFlags, _memoryPropertyFlags, m_buffer, m_memory, _tag);
     }
 
     Buffer::~Buffer() 
     {
         unmap();
-        vkDestroyBuffer(m_device.device(), m_buffer, nullptr);
-        vkFreeMemory(m_device.device(), m_memory, nullptr);
+        m_device.destroyBuffer(m_buffer, m_memory);
     }
 
     VkResult Buffer::map(VkDeviceSize _size, VkDeviceSize _offset) 
@@ -11,7 +11,8 @@ namespace Engine
             uint32_t _instanceCount,
             VkBufferUsageFlags _usageFlags,
             VkMemoryPropertyFlags _memoryPropertyFlags,
-            VkDeviceSize _minOffsetAlignment = 1);
+            VkDeviceSize _minOffsetAlignment = 1,
+            ResourceTag _tag = ResourceTag::Other);
         ~Buffer();
 
         Buffer(const Buffer&) = delete;
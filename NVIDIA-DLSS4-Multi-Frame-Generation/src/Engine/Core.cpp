@@ -2,11 +2,16 @@
 #include "Buffer.h"
 #include "..\Systems\PointLightSystem.h"
 #include "..\Systems\TextureRenderSystem.h"
+#include "..\Systems\MeshletCullingSystem.h"
 
 #include <glm/gtc/constants.hpp>
 
 #include <stdexcept>
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 
 namespace Engine
@@ -25,6 +30,7 @@ namespace Engine
             .setMaxSets(1000)
             .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000)
             .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1000)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1000)
             .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
         for (int i = 0; i < framePools.size(); i++) 
@@ -34,7 +40,10 @@ namespace Engine
 
         m_renderer.setFrameGen(&m_frameGenerationHandler);
 
-        loadGameObjects();
+        // Unless Reflex's low latency mode is active, nothing else keeps the CPU from queueing frames ahead
+        m_renderer.getLatencyLimiter().setEnabled(!m_frameGenerationHandler.isReflexLowLatencyActive());
+
+        loadGameObjects(SceneTester::SceneType::CameraPan);
     }
 
     Core::~Core(){}
@@ -49,7 +58,9 @@ namespace Engine
                 sizeof(GlobalUbo),
                 1,
                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                1,
+                ResourceTag::Uniform
             );
             uboBuffers[i]->map();
         }
@@ -70,22 +81,32 @@ namespace Engine
         RenderSystem renderSystem(m_device, m_renderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout());
         PointLightSystem pointLightSystem(m_device, m_renderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout());
         TextureRenderSystem textureRenderSystem(m_device, m_renderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout());
+        MeshletCullingSystem meshletCullingSystem(m_device);
 
         Camera camera{};
-        camera.setViewTarget(glm::vec3(-1.0f, -2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 2.0f));
-        GameObject viewerObject = GameObject::createGameObject(); // Camera object used to store the state
-        viewerObject.m_transform.m_translation = glm::vec3(0.0f, 0.0f, -2.5f);
-
         InputHandler inputHandler{};
 
         // Delta time tracking
         auto currentTime = std::chrono::high_resolution_clock::now();
-        double fpsAccumTime = 0.0;
-        uint64_t accumFrames = 0;
+
+        beginLodPolicy(m_lodPolicy);
+        if (m_sweepStepSeconds > 0.0f)
+            beginSweepStep();
+        if (m_resizeBenchSeconds > 0.0f)
+            beginResizeBenchPhase();
+        if (m_upscalerTest)
+            beginUpscalerTest();
+        if (m_allocationCheckFrames > 0)
+            beginAllocationCheck();
 
         m_terminateApplication = false;
         while (!m_window->shouldClose() && !m_terminateApplication)
         {
+            // Hold the frame back until it can start just in time for its display slot, when pacing is on,
+            // or for the GPU going idle, when the latency limiter is
+            m_renderer.getFramePacer().waitForNextFrame();
+            m_renderer.getLatencyLimiter().waitForNextFrame();
+
             // Poll events
             glfwPollEvents();
 
@@ -94,47 +115,40 @@ namespace Engine
             float deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
             currentTime = newTime;
 
-            // Update previous matrices
-            m_prevViewMatrix = camera.getViewMatrix();
-            m_prevProjectionMatrix = camera.getProjectionMatrix();
-            for (auto& [id, obj] : m_gameObjects) 
-            {
-                obj.m_transform.m_prevModelMatrix = obj.m_transform.mat4();
-            }
+            // Input is sampled here, the simulation applies it to the step after the one rendered now
+            m_renderer.markInputSampled();
+            m_simulation.setInput(inputHandler.sampleMovement(m_window->getGLFWWindow()));
+            m_loader.updateAssets();
 
-            // Gather Input and update camera
-            if (m_loader.m_sceneType == SceneTester::SceneType::CameraPan)
-            {
-                m_panCameraController.update(deltaTime, viewerObject);
-            }
-            else
-            {
-                inputHandler.moveInPlaneXZ(m_window->getGLFWWindow(), deltaTime, viewerObject);
-            }
-            camera.setViewYXZ(viewerObject.m_transform.m_translation, viewerObject.m_transform.m_rotation);
+            // Camera and moved objects as simulated while the previous frame was recorded
+            const SceneSnapshot& snapshot = m_simulation.nextSnapshot();
+            m_simulation.apply(snapshot, m_gameObjects);
 
             // Update Camera aspect ratio and projection
+            m_prevProjectionMatrix = camera.getProjectionMatrix();
+            camera = snapshot.m_camera;
+            // The upscaler test compares frames of one view, so it holds the camera still
+            if (m_upscalerTest)
+                camera.setViewTarget(UPSCALER_TEST_EYE, UPSCALER_TEST_TARGET);
+            const glm::mat4 prevView = m_upscalerTest ? camera.getViewMatrix() : snapshot.m_prevView;
             float aspectRatio = m_renderer.getAspectRatio();
             camera.setPerspectiveProjection(glm::radians(60.0f), aspectRatio, 0.1f, 100.0f);
 
-            if (m_loader.m_sceneType == SceneTester::SceneType::MovingScene) 
-            {
-                m_loader.updateMovingScene(deltaTime, m_gameObjects);
-            }
-
             // Render
+            uint64_t frameTriangles = 0;
             if (VkCommandBuffer commandBuffer = m_renderer.beginFrame())
             {
                 int frameIndex = m_renderer.getCurrentFrameIndex();
                 framePools[frameIndex]->resetPool();
                 FrameInfo frameInfo{
                     frameIndex,
-                    deltaTime,
+                    snapshot.m_deltaTime,
                     commandBuffer,
                     camera,
                     globalDescriptorSets[frameIndex],
                     *framePools[frameIndex],
-                    m_gameObjects
+                    m_gameObjects,
+                    m_renderer.getFrameArena()
                 };
 
                 // Update
@@ -143,17 +157,12 @@ namespace Engine
                 ubo.m_view = camera.getViewMatrix();
                 ubo.m_inverseView = camera.getInverseViewMatrix();
                 ubo.m_prevProjection = m_prevProjectionMatrix;
-                ubo.m_prevView = m_prevViewMatrix; 
-                ubo.m_renderSize = { m_renderer.getSwapChainExtent().width, m_renderer.getSwapChainExtent().height };
+                ubo.m_prevView = prevView;
+                // Motion vectors are written in render pixels and scaled back to UV space by Streamline
+                const VkExtent2D renderExtent = m_renderer.getRenderExtent();
+                ubo.m_renderSize = { renderExtent.width, renderExtent.height };
 
-                if (m_loader.m_sceneType == SceneTester::SceneType::CameraPan)
-                {
-                    pointLightSystem.update(frameInfo, ubo, false);
-                }
-                else
-                {
-                    pointLightSystem.update(frameInfo, ubo, true);
-                }
+                pointLightSystem.update(frameInfo, ubo);
 
                 uboBuffers[frameIndex]->writeToBuffer(&ubo);
                 uboBuffers[frameIndex]->flush();
@@ -161,12 +170,16 @@ namespace Engine
                 // Set common constants for Streamline
                 m_renderer.pushSLCommonConstants(
                     camera.getViewMatrix(), camera.getProjectionMatrix(),
-                    m_prevViewMatrix, m_prevProjectionMatrix,
+                    prevView, m_prevProjectionMatrix,
                     0.1f, 100.0f,
-                    false, // DepthInverted
-                    glm::vec2(1.0f / m_renderer.getSwapChainExtent().width, 1.0f / m_renderer.getSwapChainExtent().height)
+                    false // DepthInverted
                 );
 
+                // Compute work has to be recorded outside the render pass
+                frameInfo.m_lodErrorScale = lodErrorScale(camera);
+                meshletCullingSystem.cull(frameInfo);
+                frameInfo.m_meshletCulling = &meshletCullingSystem;
+
                 // Render
                 m_renderer.beginSwapChainRenderPass(commandBuffer);
 
@@ -177,41 +190,79 @@ namespace Engine
 
                 m_renderer.endSwapChainRenderPass(commandBuffer);
                 m_renderer.endFrame();
+                frameTriangles = frameInfo.m_trianglesSubmitted;
             }
 
-            fpsAccumTime += deltaTime;
-            accumFrames += 1;
-
-            if (fpsAccumTime >= 1.0)
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.DUMP_RESOURCE_REPORT))
             {
-                FrameStats frameStats{};
-                m_frameGenerationHandler.getFrameStats(frameStats);
-
-                // Update title
-                char title[256];
-                if (frameStats.m_isFrameGenerationEnabled)
-                {                    
-                    uint64_t genframes = accumFrames * frameStats.m_totalPresentedFrameCount;
-                    uint64_t totalFrames = accumFrames + genframes;
-                    double percentIncrease = ((totalFrames - accumFrames) / accumFrames) * 100;
-
-                    std::snprintf(title, sizeof(title),
-                        "Vulkan Engine | Render: %d FPS | Output: %d FPS | FG: +%d FPS (+%.0f%%)",
-                        accumFrames, totalFrames, genframes, percentIncrease);
-                }
-                else
-                {
-                    std::snprintf(title, sizeof(title),
-                        "Vulkan Engine | Render: %d FPS (FG off)", 
-                        accumFrames);
-                }
+                m_telemetry.dumpReport();
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.CYCLE_LOD_POLICY))
+            {
+                beginLodPolicy((m_lodPolicy + 1) % std::size(LOD_PIXEL_ERRORS));
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.TOGGLE_TEXTURE_MIPS))
+            {
+                setTextureMips(!m_textureMips);
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.CYCLE_SCENE))
+            {
+                loadGameObjects(static_cast<SceneTester::SceneType>((static_cast<int>(m_loader.m_sceneType) + 1) % SceneTester::SCENE_COUNT));
 
-                glfwSetWindowTitle(m_window->getGLFWWindow(), title);
+                const AssetRegistry::Stats& stats = m_loader.assetStats();
+                std::printf("Asset registry: %llu hits, %llu misses, %llu evictions, %zu entries, %.1f MB resident\n",
+                    static_cast<unsigned long long>(stats.m_hits), static_cast<unsigned long long>(stats.m_misses),
+                    static_cast<unsigned long long>(stats.m_evictions), stats.m_entries, stats.m_residentBytes / (1024.0 * 1024.0));
+            }
 
-                fpsAccumTime = 0.0;
-                accumFrames = 0.0;
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.CYCLE_FRAME_PACING))
+            {
+                beginPresentation((m_framePacingProfile + 1) % std::size(FRAME_PACING_PROFILES), m_presentMode, m_frameGeneration);
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.TOGGLE_FRAME_GENERATION))
+            {
+                beginPresentation(m_framePacingProfile, m_presentMode, !m_frameGeneration);
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.CYCLE_PRESENT_MODE))
+            {
+                beginPresentation(m_framePacingProfile, (m_presentMode + 1) % std::size(PRESENT_MODES), m_frameGeneration);
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.TOGGLE_FRAME_PACER))
+            {
+                setFramePacer(!m_renderer.getFramePacer().isEnabled());
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.TOGGLE_LATENCY_LIMITER))
+            {
+                setLatencyLimiter(!m_renderer.getLatencyLimiter().isEnabled());
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.TOGGLE_DYNAMIC_RESOLUTION))
+            {
+                setDynamicResolution(!m_renderer.getDynamicResolution().isEnabled());
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.CYCLE_UPSCALER_PRESET))
+            {
+                setUpscalerPreset((m_renderer.getUpscaler().getPreset() + 1) % std::size(Upscaler::PRESETS));
+            }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.TOGGLE_SIMULATION_THREAD))
+            {
+                setSimulationThread(!m_simulation.isThreaded());
             }
+            if (inputHandler.wasKeyPressed(m_window->getGLFWWindow(), inputHandler.m_keys.TOGGLE_PRESENT_THREAD))
+            {
+                m_renderer.setPresentThread(!m_renderer.getPresentThread());
+                beginPresentation(m_framePacingProfile, m_presentMode, m_frameGeneration);
+            }
+            updateSweep(deltaTime);
+            updateResizeBench(deltaTime);
+            updateUpscalerTest();
+
+            m_telemetry.tick(deltaTime, m_window->getGLFWWindow(), m_renderer.getFrameArenaHighWater(), m_renderer.getGpuSceneMs(),
+                m_renderer.getFrameLatencyMs(), m_renderer.getSubmitWaitMs(), frameTriangles);
+            updateAllocationCheck();
         }
+        m_simulation.stop();
+        m_renderer.setPresentThread(false); // The device wait must not overlap a present
+        m_renderer.getFramePacer().stop(); // Its thread waits on presents through the Streamline proxies
         vkDeviceWaitIdle(m_device.device()); // Wait for the device to finish all operations before exiting
         m_frameGenerationHandler.shutDownStreamline(); // Clean up Streamline resources before Vulkan shutdown
     }
@@ -221,14 +272,385 @@ namespace Engine
         m_terminateApplication = true;
     }
 
-    void Core::loadGameObjects()
+    void Core::beginLodPolicy(size_t _policy)
     {
-        SceneTester::SceneType type = SceneTester::SceneType::CameraPan;
+        m_lodPolicy = _policy;
+        const float pixelError = LOD_PIXEL_ERRORS[m_lodPolicy];
+
+        char label[64];
+        if (pixelError > 0.0f)
+            std::snprintf(label, sizeof(label), "LOD policy %.1f px", pixelError);
+        else
+            std::snprintf(label, sizeof(label), "LOD policy off");
+        std::cout << label << std::endl;
+        m_telemetry.beginSection(label);
+    }
+
+    void Core::setTextureMips(bool _enabled)
+    {
+        m_textureMips = _enabled;
+        for (GameObject& obj : m_gameObjects)
+        {
+            if (obj.m_diffuseMap != nullptr)
+                obj.m_diffuseMap->setMipmapsEnabled(_enabled);
+        }
 
-        switch (type)
+        const char* label = _enabled ? "Texture mips on" : "Texture mips off";
+        std::cout << label << std::endl;
+        m_telemetry.beginSection(label);
+    }
+
+    void Core::setSimulationThread(bool _enabled)
+    {
+        m_simulation.setThreaded(_enabled);
+
+        const char* label = _enabled ? "Simulation thread on" : "Simulation thread off";
+        std::cout << label << std::endl;
+        m_telemetry.beginSection(label);
+    }
+
+    void Core::enableDynamicResolution(double _targetMs)
+    {
+        m_renderer.getDynamicResolution().setTargetMs(_targetMs);
+        m_renderer.getDynamicResolution().setEnabled(true);
+    }
+
+    void Core::setDynamicResolution(bool _enabled)
+    {
+        DynamicResolution& dynamicResolution = m_renderer.getDynamicResolution();
+        if (dynamicResolution.isEnabled())
+        {
+            const DynamicResolution::Stats stats = dynamicResolution.stats();
+            std::printf("Dynamic resolution: GPU %.2f ms for a %.2f ms target, scale %.2f (%.2f to %.2f), %llu of %llu frames over target\n",
+                stats.m_gpuMs, dynamicResolution.targetMs(), stats.m_averageScale, stats.m_minScale, stats.m_maxScale,
+                static_cast<unsigned long long>(stats.m_overTarget), static_cast<unsigned long long>(stats.m_frames));
+        }
+
+        dynamicResolution.setEnabled(_enabled);
+
+        char label[64];
+        if (_enabled)
+            std::snprintf(label, sizeof(label), "Dynamic resolution on (%.2f ms GPU target)", dynamicResolution.targetMs());
+        else
+            std::snprintf(label, sizeof(label), "Dynamic resolution off");
+        std::cout << label << std::endl;
+        m_telemetry.beginSection(label);
+    }
+
+    void Core::enableUpscalerPreset(size_t _preset)
+    {
+        m_renderer.getUpscaler().setPreset(std::min(_preset, std::size(Upscaler::PRESETS) - 1));
+    }
+
+    void Core::setUpscalerPreset(size_t _preset)
+    {
+        Upscaler& upscaler = m_renderer.getUpscaler();
+        const Upscaler::Stats stats = upscaler.stats();
+        if (stats.m_frames > 0)
+        {
+            std::printf("Upscaler %s: %.3f ms GPU over %llu frames\n",
+                upscaler.getPresetInfo().m_name, stats.m_gpuMs, static_cast<unsigned long long>(stats.m_frames));
+        }
+
+        upscaler.setPreset(_preset);
+
+        // Dynamic resolution overrides the preset's render scale, the sharpening still applies
+        const Upscaler::Preset& preset = upscaler.getPresetInfo();
+        char label[96];
+        std::snprintf(label, sizeof(label), "Upscaler %s (render scale %.2f, sharpness %.2f%s)",
+            preset.m_name, preset.m_renderScale, preset.m_sharpness,
+            m_renderer.getDynamicResolution().isEnabled() ? ", dynamic resolution" : "");
+        std::cout << label << std::endl;
+        m_telemetry.beginSection(label);
+    }
+
+    void Core::beginPresentation(size_t _profile, size_t _presentMode, bool _frameGeneration)
+    {
+        m_framePacingProfile = _profile;
+        m_presentMode = _presentMode;
+        const FramePacingProfile& profile = FRAME_PACING_PROFILES[m_framePacingProfile];
+        m_renderer.setFramesInFlight(profile.m_framesInFlight);
+        m_renderer.setPresentMode(PRESENT_MODES[m_presentMode]);
+
+        if (_frameGeneration != m_frameGeneration)
+        {
+            m_frameGeneration = _frameGeneration;
+            m_frameGenerationHandler.setDLSSGOptions(_frameGeneration);
+            m_frameGenerationHandler.triggerReset();
+        }
+
+        // Each rendered frame covers 1 + generated frames on screen
+        FramePacer& pacer = m_renderer.getFramePacer();
+        pacer.setFrameMultiplier(m_frameGeneration ? m_frameGenerationHandler.m_DLSSGOptions.numFramesToGenerate + 1 : 1);
+
+        // Labelled with the requested mode, the swap chain logs a fallback if it isn't supported
+        char label[160];
+        std::snprintf(label, sizeof(label), "%s (%u frames in flight), %s, FG %s%s%s%s", profile.m_name, profile.m_framesInFlight,
+            SwapChain::presentModeName(PRESENT_MODES[m_presentMode]), m_frameGeneration ? "on" : "off", pacer.isEnabled() ? ", paced" : "",
+            m_renderer.getLatencyLimiter().isEnabled() ? ", latency limited" : "", m_renderer.getPresentThread() ? ", present thread" : "");
+        std::cout << label << std::endl;
+        m_telemetry.beginSection(label);
+    }
+
+    void Core::setFramePacer(bool _enabled)
+    {
+        FramePacer& pacer = m_renderer.getFramePacer();
+        if (_enabled && !pacer.isSupported())
+        {
+            std::cout << "Frame pacer unavailable, present wait is not supported" << std::endl;
+            return;
+        }
+
+        if (pacer.isEnabled())
+        {
+            const FramePacer::Stats stats = pacer.stats();
+            std::printf("Frame pacer: refresh %.2f ms, display interval %.2f ms (jitter %.2f ms), lead %.2f ms, %llu of %llu frames missed their slot\n",
+                stats.m_refreshMs, stats.m_displayIntervalMs, stats.m_displayJitterMs, stats.m_leadMs,
+                static_cast<unsigned long long>(stats.m_missed), static_cast<unsigned long long>(stats.m_displayed));
+        }
+
+        if (_enabled)
+            m_renderer.getLatencyLimiter().setEnabled(false);
+        pacer.setEnabled(_enabled);
+        beginPresentation(m_framePacingProfile, m_presentMode, m_frameGeneration);
+    }
+
+    void Core::setLatencyLimiter(bool _enabled)
+    {
+        LatencyLimiter& limiter = m_renderer.getLatencyLimiter();
+        if (limiter.isEnabled())
+        {
+            const LatencyLimiter::Stats stats = limiter.stats();
+            std::printf("Latency limiter: CPU %.2f ms, GPU %.2f ms, margin %.2f ms, GPU idle before %llu of %llu frames\n",
+                stats.m_cpuMs, stats.m_gpuMs, stats.m_marginMs,
+                static_cast<unsigned long long>(stats.m_gpuIdle), static_cast<unsigned long long>(stats.m_frames));
+        }
+
+        if (_enabled)
+            m_renderer.getFramePacer().setEnabled(false);
+        limiter.setEnabled(_enabled);
+        beginPresentation(m_framePacingProfile, m_presentMode, m_frameGeneration);
+    }
+
+    void Core::beginSweepStep()
+    {
+        // Each setting with frame generation on, then off, or for the latency limiter sweep without the limiter, then with it
+        const size_t setting = m_sweepStep / 2;
+        const bool frameGeneration = m_sweepStep % 2 == 0;
+
+        // The pacing and present sweeps measure the settings alone, without the limiter holding frames back
+        if (m_sweep != Sweep::LatencyLimiter)
+            m_renderer.getLatencyLimiter().setEnabled(false);
+
+        if (m_sweep == Sweep::FramePacing)
+            beginPresentation(setting, m_presentMode, frameGeneration);
+        else if (m_sweep == Sweep::PresentModes)
+            beginPresentation(m_framePacingProfile, setting, frameGeneration);
+        else
+        {
+            m_framePacingProfile = setting;
+            setLatencyLimiter(!frameGeneration);
+        }
+    }
+
+    void Core::updateSweep(float _deltaTime)
+    {
+        if (m_sweepStepSeconds <= 0.0f) return;
+
+        m_sweepElapsed += _deltaTime;
+        if (m_sweepElapsed < m_sweepStepSeconds) return;
+        m_sweepElapsed = 0.0f;
+
+        const size_t settings = m_sweep == Sweep::PresentModes ? std::size(PRESENT_MODES) : std::size(FRAME_PACING_PROFILES);
+        if (++m_sweepStep >= settings * 2)
+        {
+            m_telemetry.beginSection(""); // Prints the last step
+            if (m_sweep == Sweep::LatencyLimiter)
+                setLatencyLimiter(false); // Prints the limiter's stats for the last step
+            m_sweepStepSeconds = 0.0f;
+            stop();
+            return;
+        }
+        beginSweepStep();
+    }
+
+    void Core::beginResizeBenchPhase()
+    {
+        const bool reuse = m_resizeBenchPhase == 1;
+        m_renderer.setReuseRenderTargets(reuse);
+        m_renderer.resetRecreateStats();
+        m_resizeBenchElapsed = 0.0f;
+        m_resizeBenchFrame = 0;
+        m_resizeBenchFrameMs.clear();
+        std::cout << "Resize benchmark: " << (reuse ? "fast path" : "full rebuild") << std::endl;
+    }
+
+    void Core::updateResizeBench(float _deltaTime)
+    {
+        if (m_resizeBenchSeconds <= 0.0f) return;
+
+        m_resizeBenchFrameMs.push_back(_deltaTime * 1000.0f);
+        m_resizeBenchElapsed += _deltaTime;
+
+        if (m_resizeBenchElapsed < m_resizeBenchSeconds)
+        {
+            // Same size sequence in both phases, swinging between 60% and 100% of the default window
+            if (m_resizeBenchFrame++ % 2 == 0)
+            {
+                const float scale = 0.8f + 0.2f * std::sin(static_cast<float>(m_resizeBenchFrame) * 0.35f);
+                glfwSetWindowSize(m_window->getGLFWWindow(), static_cast<int>(WIDTH * scale), static_cast<int>(HEIGHT * scale));
+            }
+            return;
+        }
+
+        std::vector<float> frameMs = m_resizeBenchFrameMs;
+        std::sort(frameMs.begin(), frameMs.end());
+        double totalMs = 0.0;
+        for (float ms : frameMs)
+            totalMs += ms;
+
+        const Renderer::RecreateStats& recreates = m_renderer.getRecreateStats();
+        std::printf("Resize benchmark, %s: %u recreations (%u allocated render targets), %.2f ms average, %.2f ms worst recreation | "
+            "%zu frames, %.2f ms average, %.2f ms p99, %.2f ms worst frame\n",
+            m_resizeBenchPhase == 1 ? "fast path" : "full rebuild",
+            recreates.m_count, recreates.m_allocations, recreates.m_count > 0 ? recreates.m_totalMs / recreates.m_count : 0.0, recreates.m_worstMs,
+            frameMs.size(), frameMs.empty() ? 0.0 : totalMs / frameMs.size(),
+            frameMs.empty() ? 0.0 : frameMs[frameMs.size() * 99 / 100], frameMs.empty() ? 0.0 : frameMs.back());
+
+        if (++m_resizeBenchPhase < 2)
+        {
+            beginResizeBenchPhase();
+            return;
+        }
+
+        glfwSetWindowSize(m_window->getGLFWWindow(), WIDTH, HEIGHT);
+        m_renderer.setReuseRenderTargets(true);
+        m_resizeBenchSeconds = 0.0f;
+        stop();
+    }
+
+    void Core::beginUpscalerTest()
+    {
+        // The camera pan scene loaded at startup keeps its lights still, only its camera moves
+        m_loader.waitForAssets();
+
+        if (m_renderer.getDynamicResolution().isEnabled())
+            setDynamicResolution(false);
+        m_upscalerTestPreset = 0;
+        m_upscalerTestFrame = 0;
+        m_upscalerTestReference.clear();
+        setUpscalerPreset(m_upscalerTestPreset);
+    }
+
+    void Core::updateUpscalerTest()
+    {
+        if (!m_upscalerTest) return;
+
+        if (++m_upscalerTestFrame == UPSCALER_TEST_WARMUP_FRAMES)
+            m_renderer.requestCapture();
+
+        std::vector<uint8_t> texels;
+        VkExtent2D extent{};
+        if (m_upscalerTestFrame <= UPSCALER_TEST_WARMUP_FRAMES || !m_renderer.readCapture(texels, extent)) return;
+
+        const Upscaler::Preset& preset = Upscaler::PRESETS[m_upscalerTestPreset];
+        if (m_upscalerTestPreset == 0)
+        {
+            m_upscalerTestReference = std::move(texels);
+            m_upscalerTestExtent = extent;
+            std::printf("Upscaler test: %s reference at %ux%u\n", preset.m_name, extent.width, extent.height);
+        }
+        else if (extent.width != m_upscalerTestExtent.width || extent.height != m_upscalerTestExtent.height)
+        {
+            std::printf("Upscaler test, %s: skipped, drawn at %ux%u against a %ux%u reference\n",
+                preset.m_name, extent.width, extent.height, m_upscalerTestExtent.width, m_upscalerTestExtent.height);
+        }
+        else
+        {
+            double squaredError = 0.0;
+            for (size_t texel = 0; texel < texels.size(); texel += 4)
+            {
+                for (size_t channel = 0; channel < 3; channel++)
+                {
+                    const double difference = static_cast<double>(texels[texel + channel]) - m_upscalerTestReference[texel + channel];
+                    squaredError += difference * difference;
+                }
+            }
+
+            const double meanSquaredError = squaredError / (texels.size() / 4 * 3);
+            if (meanSquaredError > 0.0)
+            {
+                std::printf("Upscaler test, %s (render scale %.2f, sharpness %.2f): PSNR %.2f dB against native\n",
+                    preset.m_name, preset.m_renderScale, preset.m_sharpness, 10.0 * std::log10(255.0 * 255.0 / meanSquaredError));
+            }
+            else
+            {
+                std::printf("Upscaler test, %s (render scale %.2f, sharpness %.2f): identical to native\n",
+                    preset.m_name, preset.m_renderScale, preset.m_sharpness);
+            }
+        }
+
+        m_upscalerTestFrame = 0;
+        if (++m_upscalerTestPreset < std::size(Upscaler::PRESETS))
+        {
+            setUpscalerPreset(m_upscalerTestPreset);
+            return;
+        }
+
+        m_upscalerTest = false;
+        stop();
+    }
+
+    void Core::beginAllocationCheck()
+    {
+        // Streaming allocates on the loader's workers, which the global count includes
+        m_loader.waitForAssets();
+
+        m_allocationCheckFrame = 0;
+        m_allocatingFrames = 0;
+        m_allocationCheckMax = 0;
+        m_exitCode = EXIT_FAILURE; // Until every frame has been checked, closing the window early fails it
+    }
+
+    void Core::updateAllocationCheck()
+    {
+        if (m_allocationCheckFrames == 0) return;
+        if (++m_allocationCheckFrame <= ALLOCATION_CHECK_WARMUP_FRAMES) return;
+
+        const uint64_t allocations = m_telemetry.getFrameAllocations();
+        if (allocations > 0)
+        {
+            m_allocatingFrames++;
+            m_allocationCheckMax = std::max(m_allocationCheckMax, allocations);
+        }
+
+        if (m_allocationCheckFrame < ALLOCATION_CHECK_WARMUP_FRAMES + m_allocationCheckFrames) return;
+
+        std::printf("Allocation check: %u of %u frames allocated after a %u frame warm-up (max %llu per frame), %s\n",
+            m_allocatingFrames, m_allocationCheckFrames, ALLOCATION_CHECK_WARMUP_FRAMES,
+            static_cast<unsigned long long>(m_allocationCheckMax), m_allocatingFrames == 0 ? "passed" : "FAILED");
+        m_exitCode = m_allocatingFrames == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        m_allocationCheckFrames = 0;
+        stop();
+    }
+
+    float Core::lodErrorScale(const Camera& _camera) const
+    {
+        const float pixelError = LOD_PIXEL_ERRORS[m_lodPolicy];
+        if (pixelError <= 0.0f) return 0.0f;
+
+        // Pixels covered by one unit at distance 1
+        const float pixelsPerUnit = std::abs(_camera.getProjectionMatrix()[1][1]) * m_renderer.getSwapChainExtent().height * 0.5f;
+        return pixelsPerUnit / pixelError;
+    }
+
+    void Core::loadGameObjects(SceneTester::SceneType _type)
+    {
+        m_simulation.stop(); // It steps the loader's movers
+        switch (_type)
         {
         case SceneTester::SceneType::StaticGrid: // Static, GPU-heavy grid.
-            m_loader.m_sceneType = type;
+            m_loader.m_sceneType = _type;
             m_loader.loadStaticGrid(m_gameObjects,
                 100, 100, // Grid dimensions, X, Z
                 0.25f, // Spacing
@@ -239,7 +661,7 @@ namespace Engine
             break;
 
         case SceneTester::SceneType::CameraPan: // Camera orbiting, GPU-heavy grid.
-            m_loader.m_sceneType = type;
+            m_loader.m_sceneType = _type;
             m_loader.loadStaticGrid(m_gameObjects,
                 100, 100, // Grid dimensions, X, Z
                 0.25f, // Spacing
@@ -250,7 +672,7 @@ namespace Engine
             break;
 
         case SceneTester::SceneType::MovingScene: // Moving scene, GPU + CPU heavy.
-            m_loader.m_sceneType = type;
+            m_loader.m_sceneType = _type;
             m_loader.loadMovingScene(
                 m_gameObjects,
                 100, 100, // Grid dimensions, X, Z
@@ -261,7 +683,7 @@ namespace Engine
             break;
 
         case SceneTester::SceneType::TrasnsparencyTest: // Transparency overdraw test.
-            m_loader.m_sceneType = type;
+            m_loader.m_sceneType = _type;
             m_loader.loadTransparencyTest(
                 m_gameObjects,
                 500, // Number of quads
@@ -270,5 +692,7 @@ namespace Engine
             );
             break;
         }
+
+        m_simulation.reset(m_gameObjects);
     }
 }
\ No newline at end of file
@@ -5,9 +5,12 @@
 #include "Descriptors.h"
 #include "FrameGenerationHandler.h"
 #include "SceneTester.h"
+#include "Simulation.h"
+#include "Telemetry.h"
 
 #include <memory>
 #include <chrono>
+#include <vector>
 
 namespace Engine
 {
@@ -24,9 +27,37 @@ namespace Engine
 
         void run();
         void stop();
+        // Process exit code once run() returns, non-zero when a check such as the allocation check failed
+        int exitCode() const { return m_exitCode; }
+
+        // Makes run() step through every frame pacing profile or present mode with frame generation
+        // on and off, or every frame pacing profile with the latency limiter off and on, _secondsPerStep
+        // each, printing a telemetry section per step, then exit
+        enum class Sweep { FramePacing, PresentModes, LatencyLimiter };
+        void enableSweep(Sweep _sweep, float _secondsPerStep) { m_sweep = _sweep; m_sweepStepSeconds = _secondsPerStep; }
+
+        // Makes run() resize the window every other frame for _secondsPerPhase, first rebuilding every
+        // swap chain from scratch and then on the fast path that keeps its render targets, printing
+        // the worst frame time of each, then exit
+        void enableResizeBenchmark(float _secondsPerPhase) { m_resizeBenchSeconds = _secondsPerPhase; }
+
+        // Makes run() draw one fixed view of the static grid at each upscaler preset, printing each preset's
+        // PSNR against the native frame, then exit
+        void enableUpscalerTest() { m_upscalerTest = true; }
+
+        // Makes run() draw _frames frames once the assets are resident and a warm-up has passed, counting the
+        // frames that allocated from the global heap, then exit. Needs a debug build, where AllocationCounter is active
+        void enableAllocationCheck(uint32_t _frames) { m_allocationCheckFrames = _frames; }
+
+        // Starts with dynamic resolution on, scaling the render resolution to keep the GPU frame time at _targetMs
+        void enableDynamicResolution(double _targetMs);
+
+        // Starts on upscaler preset _preset, an index into Upscaler::PRESETS
+        void enableUpscalerPreset(size_t _preset);
 
     private:
         bool m_terminateApplication;
+        int m_exitCode = 0;
 
         // Member objs
         FrameGenerationHandler m_frameGenerationHandler{};
@@ -34,15 +65,106 @@ namespace Engine
         SlVkProxies m_slProxies;
         EngineDevice m_device{ m_window, m_frameGenerationHandler, m_slProxies};
         Renderer m_renderer{ m_window, m_device, m_slProxies };
+        Telemetry m_telemetry{ m_device, m_frameGenerationHandler };
         std::unique_ptr<DescriptorPool> m_globalPool{};
         std::vector<std::unique_ptr<DescriptorPool>> framePools;
 
         SceneTester::CameraPanController m_panCameraController{};
         SceneTester::SceneLoader m_loader{ m_device };
+        Simulation m_simulation{ m_loader, m_panCameraController };
 
-        void loadGameObjects();
+        // Replaces the scene. Assets still cached by the loader's registry are reused
+        void loadGameObjects(SceneTester::SceneType _type);
         GameObject::Map m_gameObjects;
-        glm::mat4 m_prevViewMatrix{1.0f};
-        glm::mat4 m_prevProjectionMatrix{1.0f};
+        glm::mat4 m_prevProjectionMatrix{1.0f}; // The previous view comes with the simulation's snapshot
+
+        // LOD bias: simplification error allowed on screen, in pixels, for each policy the
+        // CYCLE_LOD_POLICY key steps through. 0 draws every object at full detail
+        static constexpr float LOD_PIXEL_ERRORS[] = { 1.0f, 4.0f, 0.0f };
+        size_t m_lodPolicy = 0;
+        void beginLodPolicy(size_t _policy);
+        float lodErrorScale(const Camera& _camera) const;
+
+        // TOGGLE_TEXTURE_MIPS switches every diffuse map between its full mip chain and the base level
+        bool m_textureMips = true;
+        void setTextureMips(bool _enabled);
+
+        // TOGGLE_SIMULATION_THREAD switches between simulating alongside rendering and before it
+        void setSimulationThread(bool _enabled);
+
+        // TOGGLE_DYNAMIC_RESOLUTION switches render scaling from GPU time, printing its stats when it goes off
+        void setDynamicResolution(bool _enabled);
+
+        // CYCLE_UPSCALER_PRESET steps through the upscaler presets, printing the outgoing one's GPU time
+        void setUpscalerPreset(size_t _preset);
+
+        // Frames in flight for each profile the CYCLE_FRAME_PACING key steps through. Fewer frames
+        // queued ahead of the GPU cut latency, more keep it busy through CPU spikes
+        struct FramePacingProfile
+        {
+            const char* m_name;
+            uint32_t m_framesInFlight;
+        };
+        static constexpr FramePacingProfile FRAME_PACING_PROFILES[] = {
+            { "Balanced", SwapChain::DEFAULT_FRAMES_IN_FLIGHT },
+            { "Max throughput", 4 },
+            { "Low latency", 2 },
+            { "Min latency", 1 }
+        };
+        size_t m_framePacingProfile = 0;
+
+        // Modes the CYCLE_PRESENT_MODE key steps through
+        static constexpr VkPresentModeKHR PRESENT_MODES[] = {
+            VK_PRESENT_MODE_IMMEDIATE_KHR,
+            VK_PRESENT_MODE_MAILBOX_KHR,
+            VK_PRESENT_MODE_FIFO_KHR,
+            VK_PRESENT_MODE_FIFO_RELAXED_KHR
+        };
+        size_t m_presentMode = 0;
+        bool m_frameGeneration = true;
+
+        // Applies a frame pacing profile, present mode and frame generation state and starts a telemetry section for them
+        void beginPresentation(size_t _profile, size_t _presentMode, bool _frameGeneration);
+        // TOGGLE_FRAME_PACER switches display synchronised pacing, printing the pacer's stats when it goes off
+        void setFramePacer(bool _enabled);
+        // TOGGLE_LATENCY_LIMITER switches just in time frame starts, printing the limiter's stats when it goes off.
+        // The pacer and the limiter both decide when a frame starts, so turning one on turns the other off
+        void setLatencyLimiter(bool _enabled);
+
+        Sweep m_sweep = Sweep::FramePacing;
+        float m_sweepStepSeconds = 0.0f; // 0 when no sweep is running
+        float m_sweepElapsed = 0.0f;
+        size_t m_sweepStep = 0;
+        void beginSweepStep();
+        void updateSweep(float _deltaTime);
+
+        float m_resizeBenchSeconds = 0.0f; // 0 when no resize benchmark is running
+        float m_resizeBenchElapsed = 0.0f;
+        uint32_t m_resizeBenchPhase = 0;
+        uint32_t m_resizeBenchFrame = 0;
+        std::vector<float> m_resizeBenchFrameMs;
+        void beginResizeBenchPhase();
+        void updateResizeBench(float _deltaTime);
+
+        // Frames drawn at each preset before its capture, so nothing still streaming in or resizing shows
+        static constexpr uint32_t UPSCALER_TEST_WARMUP_FRAMES = 8;
+        static constexpr glm::vec3 UPSCALER_TEST_EYE = { 0.0f, -2.5f, -8.5f };
+        static constexpr glm::vec3 UPSCALER_TEST_TARGET = { 0.0f, 0.0f, 0.0f };
+        bool m_upscalerTest = false;
+        size_t m_upscalerTestPreset = 0;
+        uint32_t m_upscalerTestFrame = 0;
+        std::vector<uint8_t> m_upscalerTestReference;
+        VkExtent2D m_upscalerTestExtent{};
+        void beginUpscalerTest();
+        void updateUpscalerTest();
+
+        // Long enough for the frame arenas, pools and caches to reach their steady state sizes
+        static constexpr uint32_t ALLOCATION_CHECK_WARMUP_FRAMES = 240;
+        uint32_t m_allocationCheckFrames = 0; // 0 when no allocation check is running
+        uint32_t m_allocationCheckFrame = 0;
+        uint32_t m_allocatingFrames = 0;
+        uint64_t m_allocationCheckMax = 0;
+        void beginAllocationCheck();
+        void updateAllocationCheck();
     };
 }
\ No newline at end of file
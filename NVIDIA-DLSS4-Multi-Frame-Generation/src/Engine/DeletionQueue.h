@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Engine
+{
+    /*
+     * Vulkan objects that may still be referenced by in-flight frames are parked
+     * here with the last frame that could have used them, and released once that
+     * frame has completed on the device's frame timeline.
+     */
+    struct DeletionQueue
+    {
+        void push(uint64_t _frame, std::function<void()>&& _deleter)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries.push_back({ _frame, std::move(_deleter) });
+        }
+
+        // Runs every deleter parked on or before _completedFrame, returns how many ran
+        size_t flush(uint64_t _completedFrame)
+        {
+            std::vector<std::function<void()>> ready;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                // Frames are pushed in order, so everything completed sits at the front
+                while (!m_entries.empty() && m_entries.front().m_frame <= _completedFrame)
+                {
+                    ready.push_back(std::move(m_entries.front().m_deleter));
+                    m_entries.pop_front();
+                }
+            }
+
+            for (auto& deleter : ready)
+                deleter();
+            return ready.size();
+        }
+
+        // Only safe once the device is idle
+        size_t flushAll() { return flush(UINT64_MAX); }
+
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_entries.size();
+        }
+
+    private:
+        struct Entry
+        {
+            uint64_t m_frame;
+            std::function<void()> m_deleter;
+        };
+
+        mutable std::mutex m_mutex;
+        std::deque<Entry> m_entries;
+    };
+}
@@ -145,8 +145,8 @@ namespace Engine
 
     // *************** Descriptor Writer *********************
 
-    DescriptorWriter::DescriptorWriter(DescriptorSetLayout& _setLayout, DescriptorPool& _pool)
-        : m_setLayout(_setLayout), m_pool(_pool) 
+    DescriptorWriter::DescriptorWriter(DescriptorSetLayout& _setLayout, DescriptorPool& _pool, FrameArena* _arena)
+        : m_setLayout(_setLayout), m_pool(_pool), m_writes(ArenaAllocator<VkWriteDescriptorSet>(_arena))
     {}
 
     DescriptorWriter& DescriptorWriter::writeBuffer(uint32_t _binding, VkDescriptorBufferInfo* _bufferInfo) 
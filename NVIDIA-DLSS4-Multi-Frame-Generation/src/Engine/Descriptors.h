@@ -1,5 +1,6 @@
 #pragma once
 #include "EngineDevice.h"
+#include "FrameArena.h"
 
 #include <unordered_map>
 #include <stdint.h>
@@ -73,7 +74,7 @@ namespace Engine
 
     struct DescriptorWriter 
     {
-        DescriptorWriter(DescriptorSetLayout& _setLayout, DescriptorPool& _pool);
+        DescriptorWriter(DescriptorSetLayout& _setLayout, DescriptorPool& _pool, FrameArena* _arena = nullptr);
 
         DescriptorWriter& writeBuffer(uint32_t _binding, VkDescriptorBufferInfo* _bufferInfo);
         DescriptorWriter& writeImage(uint32_t _binding, VkDescriptorImageInfo* _imageInfo);
@@ -84,6 +85,6 @@ namespace Engine
     private:
         DescriptorSetLayout& m_setLayout;
         DescriptorPool& m_pool;
-        std::vector<VkWriteDescriptorSet> m_writes;
+        ArenaVector<VkWriteDescriptorSet> m_writes;
     };
 }
\ No newline at end of file
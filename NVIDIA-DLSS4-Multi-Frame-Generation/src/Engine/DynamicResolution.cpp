@@ -0,0 +1,68 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Engine
+{
+    namespace
+    {
+        // Share of the way to the ideal scale covered per measurement
+        constexpr float SMOOTHING = 0.2f;
+        // Scale changes smaller than this are left alone
+        constexpr float DEAD_BAND = 0.01f;
+        // Aim this far under the target, so ordinary noise doesn't push frames over it
+        constexpr double HEADROOM = 0.95;
+    }
+
+    void DynamicResolution::setEnabled(bool _enabled)
+    {
+        m_enabled = _enabled;
+        m_scale = MAX_SCALE;
+
+        m_gpuTotal = 0.0;
+        m_scaleTotal = 0.0;
+        m_minScale = MAX_SCALE;
+        m_maxScale = MAX_SCALE;
+        m_frames = 0;
+        m_overTarget = 0;
+    }
+
+    void DynamicResolution::setTargetMs(double _targetMs)
+    {
+        m_targetMs = std::max(_targetMs, 0.1);
+    }
+
+    void DynamicResolution::update(double _gpuMs, float _scale)
+    {
+        if (!m_enabled || _gpuMs <= 0.0) return;
+
+        // Pixels, and so GPU time, go with the square of the scale
+        const float ideal = std::clamp(_scale * static_cast<float>(std::sqrt(m_targetMs * HEADROOM / _gpuMs)), MIN_SCALE, MAX_SCALE);
+        const float next = m_scale + (ideal - m_scale) * SMOOTHING;
+        if (std::abs(next - m_scale) >= DEAD_BAND || ideal == MIN_SCALE || ideal == MAX_SCALE)
+            m_scale = std::clamp(next, MIN_SCALE, MAX_SCALE);
+
+        m_gpuTotal += _gpuMs;
+        m_scaleTotal += _scale;
+        m_minScale = m_frames == 0 ? _scale : std::min(m_minScale, _scale);
+        m_maxScale = m_frames == 0 ? _scale : std::max(m_maxScale, _scale);
+        m_frames++;
+        if (_gpuMs > m_targetMs) m_overTarget++;
+    }
+
+    DynamicResolution::Stats DynamicResolution::stats() const
+    {
+        Stats stats;
+        if (m_frames > 0)
+        {
+            stats.m_gpuMs = m_gpuTotal / m_frames;
+            stats.m_averageScale = static_cast<float>(m_scaleTotal / m_frames);
+        }
+        stats.m_minScale = m_minScale;
+        stats.m_maxScale = m_maxScale;
+        stats.m_frames = m_frames;
+        stats.m_overTarget = m_overTarget;
+        return stats;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+
+namespace Engine
+{
+    /*
+     * Picks the render scale, the fraction of the swap chain's width and height the scene is drawn
+     * at before it is scaled up, that keeps the measured GPU frame time at a target. GPU time is
+     * taken to grow with the pixel count, so each measurement, paired with the scale its frame was
+     * drawn at, gives the scale that would have hit the target. The scale eases towards that and
+     * ignores changes too small to matter, so a noisy timer doesn't make the image swim.
+     */
+    struct DynamicResolution
+    {
+        static constexpr float MIN_SCALE = 0.5f;
+        static constexpr float MAX_SCALE = 1.0f;
+
+        struct Stats
+        {
+            double m_gpuMs = 0.0;       // Average measured GPU frame time
+            float m_averageScale = 1.0f;
+            float m_minScale = 1.0f;
+            float m_maxScale = 1.0f;
+            uint64_t m_frames = 0;
+            uint64_t m_overTarget = 0;  // Frames measured above the target
+        };
+
+        bool isEnabled() const { return m_enabled; }
+        // Off holds the scale at MAX_SCALE
+        void setEnabled(bool _enabled);
+        double targetMs() const { return m_targetMs; }
+        void setTargetMs(double _targetMs);
+
+        // Once per measured frame. _scale is the render scale that frame was drawn at
+        void update(double _gpuMs, float _scale);
+        // Render scale for the next frame
+        float scale() const { return m_scale; }
+
+        Stats stats() const;
+
+    private:
+        bool m_enabled = false;
+        double m_targetMs = 1000.0 / 120.0;
+        float m_scale = MAX_SCALE;
+
+        double m_gpuTotal = 0.0;
+        double m_scaleTotal = 0.0;
+        float m_minScale = MAX_SCALE;
+        float m_maxScale = MAX_SCALE;
+        uint64_t m_frames = 0;
+        uint64_t m_overTarget = 0;
+    };
+}
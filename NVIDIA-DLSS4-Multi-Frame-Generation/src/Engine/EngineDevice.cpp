@@ -58,10 +58,23 @@ namespace Engine
 
         createLogicalDevice(_frameGenHandler); // Create a logical device to interface with the physical device
         createCommandPool(); // Create a command pool for managing command buffers
+        createFrameTimeline(); // Timeline semaphore the renderer signals once per frame
     }
 
     EngineDevice::~EngineDevice()
     {
+        // Release everything parked by destructors now that nothing can be in flight
+        vkDeviceWaitIdle(m_device);
+        m_deletionQueue.flushAll();
+
+        // Anything still registered here was never destroyed by its owner
+        if (m_resourceRegistry.liveCount() > 0)
+        {
+            std::cerr << "EngineDevice: " << m_resourceRegistry.liveCount() << " GPU resources leaked" << std::endl;
+            m_resourceRegistry.writeReport(std::cerr, queryMemoryBudget());
+        }
+
+        vkDestroySemaphore(m_device, m_frameTimeline, nullptr);
         vkDestroyCommandPool(m_device, m_commandPool, nullptr);
         vkDestroyDevice(m_device, nullptr);
 
@@ -145,6 +158,7 @@ namespace Engine
             throw std::runtime_error("failed to find a suitable GPU!");
 
         vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
         std::cout << "physical device: " << properties.deviceName << std::endl;
     }
 
@@ -158,8 +172,8 @@ namespace Engine
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
         std::set<uint32_t> uniqueQueueFamilies = { indices.m_graphicsFamily, indices.m_presentFamily };
 
-        float queuePriority = 1.0f;
-        std::array<float, 2> queuePriorities = { 1.0f, 1.0f };
+        // One per queue of the largest family request below
+        const std::vector<float> queuePriorities(2 + m_slExtraGraphicsQueues + m_slExtraComputeQueues, 1.0f);
         for (uint32_t queueFamily : uniqueQueueFamilies)
         {
             VkDeviceQueueCreateInfo queueCreateInfo = {};
@@ -169,7 +183,7 @@ namespace Engine
             const bool sharedGP = (indices.m_graphicsFamily == indices.m_presentFamily);
             if (queueFamily == indices.m_graphicsFamily)
             {
-                // Use 2 queues if present shares graphics family, otherwise 1.
+                // Use 2 queues if present shares graphics family, otherwise 1. The second one presents
                 m_hostGraphicsQueuesInFamily = sharedGP ? 2u : 1u;
                 queueCreateInfo.queueCount = m_hostGraphicsQueuesInFamily + m_slExtraGraphicsQueues + m_slExtraComputeQueues;
             }
@@ -204,6 +218,22 @@ namespace Engine
         };
         deviceFeatures2.features.independentBlend = VK_TRUE;
 
+        // Optional, KTX2 textures in BC formats need it
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+        deviceFeatures2.features.textureCompressionBC = supportedFeatures.textureCompressionBC;
+        m_textureCompressionBCEnabled = supportedFeatures.textureCompressionBC == VK_TRUE;
+
+        // Optional, the frame pacer needs both. The extensions are required, the features may still be missing
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWait{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
+        VkPhysicalDevicePresentIdFeaturesKHR presentId{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };
+        presentId.pNext = &presentWait;
+        VkPhysicalDeviceFeatures2 supportedFeatures2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+        supportedFeatures2.pNext = &presentId;
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedFeatures2);
+        m_presentWaitEnabled = presentId.presentId == VK_TRUE && presentWait.presentWait == VK_TRUE;
+        presentWait.pNext = nullptr;
+
         VkPhysicalDeviceVulkan12Features sl12 = sl::getVkPhysicalDeviceVulkan12Features(0, nullptr);
         VkPhysicalDeviceVulkan13Features sl13 = sl::getVkPhysicalDeviceVulkan13Features(0, nullptr);
         sl::Result slRes = sl::Result::eOk;
@@ -214,7 +244,7 @@ namespace Engine
             sl13 = sl::getVkPhysicalDeviceVulkan13Features(req.vkNumFeatures13, req.vkFeatures13);
         }
 
-        sl13.pNext = nullptr;
+        sl13.pNext = &presentId;
         sl12.pNext = &sl13;
         bufferAddress.pNext = &sl12;
         timelineFeatures.pNext = &bufferAddress;
@@ -235,6 +265,12 @@ namespace Engine
             createInfo.ppEnabledLayerNames = m_validationLayers.data();
         }
 
+        // Optional extensions
+        m_memoryBudgetSupported = isDeviceExtensionAvailable(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (m_memoryBudgetSupported)
+            m_deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        std::cout << "Memory budget extension: " << (m_memoryBudgetSupported ? "enabled" : "unavailable") << std::endl;
+
         // Merge SL device extensions
         std::unordered_set<std::string> have(m_deviceExtensions.begin(), m_deviceExtensions.end());
         for (const char* ext : m_slDeviceExtensions)
@@ -255,7 +291,9 @@ namespace Engine
         m_slProxies.resolve(m_instance, m_device);
 
         m_slProxies.GetDeviceQueue(m_device, indices.m_graphicsFamily, 0, &m_graphicsQueue);
-        m_slProxies.GetDeviceQueue(m_device, indices.m_presentFamily, 0, &m_presentQueue);
+        // Present gets a queue of its own, so a present blocked on frame pacing never holds up the next submit
+        const uint32_t presentQueueIndex = indices.m_presentFamily == indices.m_graphicsFamily ? m_hostGraphicsQueuesInFamily - 1 : 0;
+        m_slProxies.GetDeviceQueue(m_device, indices.m_presentFamily, presentQueueIndex, &m_presentQueue);
 
         /* ONLY USE FOR MANUAL HOOKING TO STREAMLINE */
         _frameGenHandler.initializeStreamline(*this);
@@ -274,6 +312,21 @@ namespace Engine
             throw std::runtime_error("failed to create command pool!");
     }
 
+    void EngineDevice::createFrameTimeline()
+    {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &typeInfo;
+
+        if (vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_frameTimeline) != VK_SUCCESS)
+            throw std::runtime_error("failed to create frame timeline semaphore!");
+    }
+
     void EngineDevice::createSurface() { m_window.lock()->createWindowSurface(m_instance, &m_surface); }
 
     bool EngineDevice::isDeviceSuitable(VkPhysicalDevice _device) 
@@ -403,6 +456,22 @@ namespace Engine
         return requiredExtensions.empty();
     }
 
+    bool EngineDevice::isDeviceExtensionAvailable(const char* _extensionName)
+    {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+        for (const auto& extension : availableExtensions)
+        {
+            if (strcmp(extension.extensionName, _extensionName) == 0)
+                return true;
+        }
+        return false;
+    }
+
     QueueFamilyIndices EngineDevice::findQueueFamilies(VkPhysicalDevice _device) 
     {
         QueueFamilyIndices indices;
@@ -503,7 +572,8 @@ namespace Engine
         VkBufferUsageFlags _usage,
         VkMemoryPropertyFlags _properties,
         VkBuffer& _buffer,
-        VkDeviceMemory& _bufferMemory) 
+        VkDeviceMemory& _bufferMemory,
+        ResourceTag _tag) 
     {
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -526,6 +596,20 @@ namespace Engine
             throw std::runtime_error("failed to allocate vertex buffer memory!");
 
         vkBindBufferMemory(m_device, _buffer, _bufferMemory, 0);
+
+        m_resourceRegistry.track(reinterpret_cast<uint64_t>(_buffer), VK_OBJECT_TYPE_BUFFER, _tag, 
+            memRequirements.size, m_memoryProperties.memoryTypes[allocInfo.memoryTypeIndex].heapIndex);
+    }
+
+    void EngineDevice::destroyBuffer(VkBuffer _buffer, VkDeviceMemory _bufferMemory)
+    {
+        // In-flight frames may still read the buffer, release once they have retired
+        deferDestroy([this, _buffer, _bufferMemory]()
+            {
+                m_resourceRegistry.untrack(reinterpret_cast<uint64_t>(_buffer));
+                vkDestroyBuffer(m_device, _buffer, nullptr);
+                vkFreeMemory(m_device, _bufferMemory, nullptr);
+            });
     }
 
     VkCommandBuffer EngineDevice::beginSingleTimeCommands() 
@@ -556,8 +640,11 @@ namespace Engine
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = &_commandBuffer;
 
-        vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(m_graphicsQueue);
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+            vkQueueWaitIdle(m_graphicsQueue);
+        }
 
         vkFreeCommandBuffers(m_device, m_commandPool, 1, &_commandBuffer);
     }
@@ -606,7 +693,8 @@ namespace Engine
         const VkImageCreateInfo& _imageInfo,
         VkMemoryPropertyFlags _properties,
         VkImage& _image,
-        VkDeviceMemory& _imageMemory) 
+        VkDeviceMemory& _imageMemory,
+        ResourceTag _tag) 
     {
         if (vkCreateImage(m_device, &_imageInfo, nullptr, &_image) != VK_SUCCESS)
             throw std::runtime_error("failed to create image!");
@@ -624,6 +712,94 @@ namespace Engine
 
         if (vkBindImageMemory(m_device, _image, _imageMemory, 0) != VK_SUCCESS)
             throw std::runtime_error("failed to bind image memory!");
+
+        m_resourceRegistry.track(reinterpret_cast<uint64_t>(_image), VK_OBJECT_TYPE_IMAGE, _tag,
+            memRequirements.size, m_memoryProperties.memoryTypes[allocInfo.memoryTypeIndex].heapIndex);
+    }
+
+    void EngineDevice::destroyImage(VkImage _image, VkDeviceMemory _imageMemory)
+    {
+        deferDestroy([this, _image, _imageMemory]()
+            {
+                m_resourceRegistry.untrack(reinterpret_cast<uint64_t>(_image));
+                vkDestroyImage(m_device, _image, nullptr);
+                vkFreeMemory(m_device, _imageMemory, nullptr);
+            });
+    }
+
+    void EngineDevice::advanceFrame()
+    {
+        m_currentFrame++;
+        m_resourceRegistry.advanceFrame();
+    }
+
+    uint64_t EngineDevice::completedFrameCount()
+    {
+        uint64_t value = 0;
+        if (vkGetSemaphoreCounterValue(m_device, m_frameTimeline, &value) != VK_SUCCESS)
+            throw std::runtime_error("failed to query frame timeline!");
+        return value;
+    }
+
+    void EngineDevice::waitForFrame(uint64_t _frame)
+    {
+        uint64_t value = frameValue(_frame);
+
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_frameTimeline;
+        waitInfo.pValues = &value;
+
+        if (vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+            throw std::runtime_error("failed to wait on frame timeline!");
+    }
+
+    void EngineDevice::releaseCompletedFrames()
+    {
+        // Entries are parked with the frame that recorded them, frame N being done at value N + 1
+        uint64_t completed = completedFrameCount();
+        if (completed > 0)
+            m_deletionQueue.flush(completed - 1);
+    }
+
+    std::vector<HeapBudget> EngineDevice::queryMemoryBudget()
+    {
+        std::vector<HeapBudget> heaps;
+        queryMemoryBudget(heaps);
+        return heaps;
+    }
+
+    void EngineDevice::queryMemoryBudget(std::vector<HeapBudget>& _heaps)
+    {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+        VkPhysicalDeviceMemoryProperties2 memProperties2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2 };
+        if (m_memoryBudgetSupported)
+            memProperties2.pNext = &budgetProperties;
+
+        // Budget values change every frame, so query fresh rather than using the cached properties
+        vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &memProperties2);
+        const VkPhysicalDeviceMemoryProperties& memProperties = memProperties2.memoryProperties;
+
+        _heaps.resize(memProperties.memoryHeapCount);
+        for (uint32_t i = 0; i < memProperties.memoryHeapCount; i++)
+        {
+            HeapBudget& heap = _heaps[i];
+            heap.m_size = memProperties.memoryHeaps[i].size;
+            heap.m_deviceLocal = (memProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+            heap.m_tracked = m_resourceRegistry.heapUsage(i);
+
+            if (m_memoryBudgetSupported)
+            {
+                heap.m_budget = budgetProperties.heapBudget[i];
+                heap.m_usage = budgetProperties.heapUsage[i];
+            }
+            else
+            {
+                heap.m_budget = heap.m_size;
+                heap.m_usage = heap.m_tracked;
+            }
+        }
     }
 
     void EngineDevice::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount)
@@ -1,9 +1,12 @@
 #pragma once
 #include "Window.h"
 #include "SlVkProxies.h"
+#include "ResourceRegistry.h"
+#include "DeletionQueue.h"
 
 #include <vector>
 #include <memory>
+#include <mutex>
 
 namespace Engine
 {
@@ -47,6 +50,11 @@ namespace Engine
         VkSurfaceKHR surface() { return m_surface; }
         VkQueue graphicsQueue() { return m_graphicsQueue; }
         VkQueue presentQueue() { return m_presentQueue; }
+        // Held around graphics queue submits and waits
+        std::mutex& queueMutex() { return m_queueMutex; }
+        // Held around presents, which may come from the present thread. Only the graphics queue's mutex when
+        // present has to share that queue
+        std::mutex& presentMutex() { return m_presentQueue == m_graphicsQueue ? m_queueMutex : m_presentMutex; }
         VkPhysicalDevice physicalDevice() { return m_physicalDevice; }
         VkInstance instance() { return m_instance; }
 
@@ -56,19 +64,46 @@ namespace Engine
         VkFormat findSupportedFormat(const std::vector<VkFormat>& _candidates, VkImageTiling _tiling, VkFormatFeatureFlags _features);
 
         // Buffer Helper Functions
-        void createBuffer(VkDeviceSize _size, VkBufferUsageFlags _usage, VkMemoryPropertyFlags _properties, VkBuffer& _buffer, VkDeviceMemory& _bufferMemory);
+        void createBuffer(VkDeviceSize _size, VkBufferUsageFlags _usage, VkMemoryPropertyFlags _properties, VkBuffer& _buffer, VkDeviceMemory& _bufferMemory, ResourceTag _tag = ResourceTag::Other);
+        void destroyBuffer(VkBuffer _buffer, VkDeviceMemory _bufferMemory);
         void copyBuffer(VkBuffer _srcBuffer, VkBuffer _dstBuffer, VkDeviceSize _size);
         void copyBufferToImage(VkBuffer _buffer, VkImage _image, uint32_t _width, uint32_t _height, uint32_t _layerCount);
         VkCommandBuffer beginSingleTimeCommands();
         void endSingleTimeCommands(VkCommandBuffer _commandBuffer);
 
-        void createImageWithInfo(const VkImageCreateInfo& _imageCreateInfo, VkMemoryPropertyFlags _properties, VkImage& _image, VkDeviceMemory& _imageMemory);
+        void createImageWithInfo(const VkImageCreateInfo& _imageCreateInfo, VkMemoryPropertyFlags _properties, VkImage& _image, VkDeviceMemory& _imageMemory, ResourceTag _tag = ResourceTag::Other);
+        void destroyImage(VkImage _image, VkDeviceMemory _imageMemory);
 
         void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1, uint32_t layerCount = 1);
 
         VkPhysicalDeviceProperties properties;
 
+        // Frame tracking and deferred destruction
+        uint64_t currentFrame() const { return m_currentFrame; }
+        void advanceFrame();
+        void deferDestroy(std::function<void()>&& _deleter) { m_deletionQueue.push(m_currentFrame, std::move(_deleter)); }
+        // Runs the deleters of every frame the GPU has finished, without blocking
+        void releaseCompletedFrames();
+
+        // Graphics queue timeline. Frame N's submit signals frameValue(N), so the counter is the
+        // number of frames the GPU has finished
+        VkSemaphore frameTimeline() { return m_frameTimeline; }
+        static uint64_t frameValue(uint64_t _frame) { return _frame + 1; }
+        uint64_t completedFrameCount();
+        bool isFrameComplete(uint64_t _frame) { return completedFrameCount() >= frameValue(_frame); }
+        void waitForFrame(uint64_t _frame);
+        size_t pendingDeletions() const { return m_deletionQueue.size(); }
+
+        // Memory instrumentation
+        ResourceRegistry& resourceRegistry() { return m_resourceRegistry; }
+        bool memoryBudgetSupported() const { return m_memoryBudgetSupported; }
+        std::vector<HeapBudget> queryMemoryBudget();
+        void queryMemoryBudget(std::vector<HeapBudget>& _heaps); // Reuses _heaps storage
+
         uint32_t hostGraphicsQueuesInFamily() const { return m_hostGraphicsQueuesInFamily; }
+        bool textureCompressionBCEnabled() const { return m_textureCompressionBCEnabled; }
+        // VK_KHR_present_id and VK_KHR_present_wait features, both needed to wait on a present
+        bool presentWaitEnabled() const { return m_presentWaitEnabled; }
 
         // Streamline manual hooking requirements
         void queryStreamlineRequirements();
@@ -86,6 +121,7 @@ namespace Engine
         void pickPhysicalDevice();
         void createLogicalDevice(FrameGenerationHandler& _frameGenHandler);
         void createCommandPool();
+        void createFrameTimeline();
 
         // Helper Functions
         bool isDeviceSuitable(VkPhysicalDevice _device);
@@ -95,6 +131,7 @@ namespace Engine
         void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& _createInfo);
         void hasGlfwRequiredInstanceExtensions();
         bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+        bool isDeviceExtensionAvailable(const char* _extensionName);
         SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice _device);
 
         VkInstance m_instance;
@@ -107,9 +144,21 @@ namespace Engine
         VkSurfaceKHR m_surface;
         VkQueue m_graphicsQueue;
         VkQueue m_presentQueue;
+        std::mutex m_queueMutex;
+        std::mutex m_presentMutex;
 
         SlVkProxies& m_slProxies;
 
+        VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+        ResourceRegistry m_resourceRegistry;
+        bool m_memoryBudgetSupported = false;
+        bool m_textureCompressionBCEnabled = false;
+        bool m_presentWaitEnabled = false;
+
+        DeletionQueue m_deletionQueue;
+        uint64_t m_currentFrame = 0;
+        VkSemaphore m_frameTimeline = VK_NULL_HANDLE;
+
         const std::vector<const char*> m_validationLayers = { "VK_LAYER_KHRONOS_validation" };
         std::vector<const char*> m_deviceExtensions = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME,
@@ -0,0 +1,72 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    static constexpr size_t BLOCK_ALIGNMENT = 64;
+
+    static std::byte* allocateBlock(size_t _size, size_t _alignment = BLOCK_ALIGNMENT)
+    {
+        return static_cast<std::byte*>(::operator new(_size, std::align_val_t(_alignment)));
+    }
+
+    // _alignment must match the one the block was allocated with
+    static void freeBlock(std::byte* _block, size_t _alignment = BLOCK_ALIGNMENT)
+    {
+        ::operator delete(_block, std::align_val_t(_alignment));
+    }
+
+    FrameArena::FrameArena(size_t _capacity)
+        : m_capacity(_capacity)
+    {
+        m_block = allocateBlock(m_capacity);
+    }
+
+    FrameArena::~FrameArena()
+    {
+        for (const OverflowBlock& block : m_overflowBlocks)
+            freeBlock(block.m_block, block.m_alignment);
+        freeBlock(m_block);
+    }
+
+    void* FrameArena::allocate(size_t _size, size_t _alignment)
+    {
+        // Aligned as an address, the block itself is only BLOCK_ALIGNMENT aligned
+        const uintptr_t base = reinterpret_cast<uintptr_t>(m_block);
+        size_t offset = ((base + m_used + _alignment - 1) & ~(_alignment - 1)) - base;
+        if (offset + _size <= m_capacity)
+        {
+            m_used = offset + _size;
+            return m_block + offset;
+        }
+
+        // Out of space this frame, chain a dedicated block and remember to grow on reset. The main block may
+        // need up to _alignment - 1 bytes of padding in front of this allocation next frame, so count them too
+        const size_t alignment = std::max(_alignment, BLOCK_ALIGNMENT);
+        std::byte* block = allocateBlock(std::max(_size, alignment), alignment);
+        m_overflowBlocks.push_back({ block, alignment });
+        m_overflowUsed += _size + _alignment - 1;
+        return block;
+    }
+
+    void FrameArena::reset()
+    {
+        m_highWaterMark = std::max(m_highWaterMark, bytesUsed());
+
+        if (!m_overflowBlocks.empty())
+        {
+            for (const OverflowBlock& block : m_overflowBlocks)
+                freeBlock(block.m_block, block.m_alignment);
+            m_overflowBlocks.clear();
+
+            // Grow with headroom so the next frame fits in a single block
+            freeBlock(m_block);
+            m_capacity = m_highWaterMark + m_highWaterMark / 2;
+            m_block = allocateBlock(m_capacity);
+        }
+
+        m_used = 0;
+        m_overflowUsed = 0;
+    }
+}
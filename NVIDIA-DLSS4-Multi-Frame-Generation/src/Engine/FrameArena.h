@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace Engine
+{
+    /*
+     * Bump allocator for data that only lives for one frame. Reset at the start
+     * of the frame, individual frees are no-ops. If a frame overflows the current
+     * block an extra block is chained on, and the next reset grows the main block
+     * to cover the high water mark so the steady state never touches the heap.
+     */
+    struct FrameArena
+    {
+        explicit FrameArena(size_t _capacity = 256 * 1024);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void* allocate(size_t _size, size_t _alignment);
+        void reset();
+
+        size_t bytesUsed() const { return m_used + m_overflowUsed; }
+        size_t capacity() const { return m_capacity; }
+        size_t highWaterMark() const { return m_highWaterMark; }
+
+    private:
+        std::byte* m_block = nullptr;
+        size_t m_capacity = 0;
+        size_t m_used = 0;
+
+        struct OverflowBlock
+        {
+            std::byte* m_block;
+            size_t m_alignment; // Needed to free it
+        };
+        std::vector<OverflowBlock> m_overflowBlocks;
+        size_t m_overflowUsed = 0;
+        size_t m_highWaterMark = 0;
+    };
+
+    // STL allocator adapter, falls back to the global heap when no arena is given
+    template<typename T>
+    struct ArenaAllocator
+    {
+        using value_type = T;
+
+        ArenaAllocator() noexcept = default;
+        ArenaAllocator(FrameArena* _arena) noexcept : m_arena(_arena) {}
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U>& _other) noexcept : m_arena(_other.m_arena) {}
+
+        T* allocate(size_t _count)
+        {
+            if (m_arena)
+                return static_cast<T*>(m_arena->allocate(_count * sizeof(T), alignof(T)));
+            return static_cast<T*>(::operator new(_count * sizeof(T)));
+        }
+
+        void deallocate(T* _ptr, size_t) noexcept
+        {
+            // Arena memory is reclaimed all at once on reset
+            if (!m_arena)
+                ::operator delete(_ptr);
+        }
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U>& _other) const noexcept { return m_arena == _other.m_arena; }
+        template<typename U>
+        bool operator!=(const ArenaAllocator<U>& _other) const noexcept { return m_arena != _other.m_arena; }
+
+        FrameArena* m_arena = nullptr;
+    };
+
+    template<typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
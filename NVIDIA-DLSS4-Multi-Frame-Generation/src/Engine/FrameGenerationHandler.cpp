@@ -6,6 +6,7 @@
 #include <Streamline/sl_reflex.h>
 #include <glm/gtc/matrix_inverse.hpp>
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 
@@ -100,21 +101,36 @@ namespace Engine
         if (r != sl::Result::eOk) 
            printf("[SL] slReflexSetOptions failed: %d\n", (int)r);
 
+        sl::ReflexState reflexState{};
+        m_reflexLowLatency = r == sl::Result::eOk && (ro.mode == sl::ReflexMode::eLowLatency || ro.mode == sl::ReflexMode::eLowLatencyWithBoost) &&
+            slReflexGetState(reflexState) == sl::Result::eOk && reflexState.lowLatencyAvailable;
+
         m_DLSSGOptions.numFramesToGenerate = 3;
         setDLSSGOptions(true);
     }
 
     void FrameGenerationHandler::getFrameStats(FrameStats& _stats) const
     {
-        _stats.m_totalPresentedFrameCount = m_lastState.numFramesActuallyPresented;
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            _stats.m_totalPresentedFrameCount = m_lastState.numFramesActuallyPresented;
+        }
         _stats.m_isFrameGenerationEnabled = m_DLSSGOptions.mode != sl::DLSSGMode::eOff;
     }
 
     void FrameGenerationHandler::updateState()
     {
-        if (!m_seenFirstPresent) return;
-        if (SL_FAILED(res, slDLSSGGetState(m_viewport, m_lastState, nullptr)))
+        if (!m_seenFirstPresent.load(std::memory_order_relaxed)) return;
+
+        sl::DLSSGState state{};
+        if (SL_FAILED(res, slDLSSGGetState(m_viewport, state, nullptr)))
+        {
             printf("[SL] slDLSSGGetState failed: %d\n", (int)res);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_lastState = state;
     }
 
     void FrameGenerationHandler::reflexPresentStart(const sl::FrameToken& _frameToken)
@@ -158,8 +174,7 @@ namespace Engine
     void FrameGenerationHandler::setCommonConstants(const glm::mat4& _viewMatrix, const glm::mat4& _projectionMatrix,
         const glm::mat4& _prevViewMatrix, const glm::mat4& _prevProjectionMatrix,
         VkExtent2D _renderSize, VkExtent2D _displaySize,
-        float _nearZ, float _farZ, bool _depthInverted,
-        glm::vec2 _motionVecScale)
+        float _nearZ, float _farZ, bool _depthInverted)
     {
         // Build required transforms for v2 Constants
         const glm::mat4 invView = glm::inverse(_viewMatrix);
@@ -174,7 +189,8 @@ namespace Engine
         c.clipToPrevClip = toSL(clipToPrevClipM);
         c.prevClipToClip = toSL(prevClipToClipM);
         c.jitterOffset = sl::float2(0, 0);
-        c.mvecScale = sl::float2(_motionVecScale.x, _motionVecScale.y);
+        // Motion vectors are written in pixels of the render extent, which may be below the display size
+        c.mvecScale = sl::float2(1.0f / std::max(_renderSize.width, 1u), 1.0f / std::max(_renderSize.height, 1u));
         c.cameraNear = _nearZ;
         c.cameraFar = _farZ;
         c.depthInverted = _depthInverted ? sl::Boolean::eTrue : sl::Boolean::eFalse;
@@ -222,26 +238,35 @@ namespace Engine
     void FrameGenerationHandler::tagResources(VkImage _depth, VkImageView _depthView, VkDeviceMemory _depthMem,
         VkImage _motionVec, VkImageView _motionVecView, VkDeviceMemory _motionVecMem,
         VkImage _hudlessColour, VkImageView _hudlessColourView, VkDeviceMemory _hudlessColourMem,
-        VkExtent2D _extent, VkCommandBuffer _cmd)
+        VkFormat _hudlessColourFormat, VkImageLayout _hudlessColourLayout,
+        VkExtent2D _renderExtent, VkExtent2D _displayExtent, VkExtent2D _renderTargetExtent, VkCommandBuffer _cmd)
     {
         sl::Resource rDepth{ sl::ResourceType::eTex2d, (void*)_depth, (void*)_depthMem, (void*)_depthView, (uint32_t)VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
         sl::Resource rMotionVec{ sl::ResourceType::eTex2d, (void*)_motionVec, (void*)_motionVecMem, (void*)_motionVecView, (uint32_t)VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-        sl::Resource rHudlessCol{ sl::ResourceType::eTex2d, (void*)_hudlessColour, (void*)_hudlessColourMem, (void*)_hudlessColourView, (uint32_t)VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+        sl::Resource rHudlessCol{ sl::ResourceType::eTex2d, (void*)_hudlessColour, (void*)_hudlessColourMem, (void*)_hudlessColourView, (uint32_t)_hudlessColourLayout };
 
         rDepth.nativeFormat = (uint32_t)VK_FORMAT_D32_SFLOAT;
         rMotionVec.nativeFormat = (uint32_t)VK_FORMAT_R16G16_SFLOAT;
-        rHudlessCol.nativeFormat = (uint32_t)VK_FORMAT_B8G8R8A8_UNORM;
+        rHudlessCol.nativeFormat = (uint32_t)_hudlessColourFormat;
+
+        // Depth and MV come from a pool that can be larger than the swap chain, only the top left
+        // _renderExtent of them is valid. The hudless colour is at display size
+        rDepth.width = rMotionVec.width = _renderTargetExtent.width;
+        rDepth.height = rMotionVec.height = _renderTargetExtent.height;
+        rHudlessCol.width = _displayExtent.width;
+        rHudlessCol.height = _displayExtent.height;
 
-        rDepth.width = rMotionVec.width = rHudlessCol.width = _extent.width;
-        rDepth.height = rMotionVec.height = rHudlessCol.height = _extent.height;
+        sl::Extent render{};
+        render.width = _renderExtent.width;
+        render.height = _renderExtent.height;
 
         sl::Extent full{};
-        full.width = _extent.width;
-        full.height = _extent.height;
+        full.width = _displayExtent.width;
+        full.height = _displayExtent.height;
 
         sl::ResourceTag tags[] = {
-            sl::ResourceTag{ &rDepth, sl::kBufferTypeDepth, sl::ResourceLifecycle::eValidUntilPresent, &full },
-            sl::ResourceTag{ &rMotionVec, sl::kBufferTypeMotionVectors, sl::ResourceLifecycle::eValidUntilPresent, &full },
+            sl::ResourceTag{ &rDepth, sl::kBufferTypeDepth, sl::ResourceLifecycle::eValidUntilPresent, &render },
+            sl::ResourceTag{ &rMotionVec, sl::kBufferTypeMotionVectors, sl::ResourceLifecycle::eValidUntilPresent, &render },
             sl::ResourceTag{ &rHudlessCol, sl::kBufferTypeHUDLessColor, sl::ResourceLifecycle::eValidUntilPresent, &full }
         };
 
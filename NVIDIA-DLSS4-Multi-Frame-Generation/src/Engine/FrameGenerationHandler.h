@@ -6,6 +6,9 @@
 #include <Streamline/sl_pcl.h>
 #include <glm/matrix.hpp>
 
+#include <atomic>
+#include <mutex>
+
 namespace Engine
 {
     struct FrameStats
@@ -29,6 +32,8 @@ namespace Engine
         const sl::FrameToken& getFrameToken() const { return *m_frameToken; }
         void getFrameStats(FrameStats& _stats) const;
         void updateState();
+        // True when Reflex's low latency mode holds frame starts back itself
+        bool isReflexLowLatencyActive() const { return m_reflexLowLatency; }
 
         void reflexPresentStart(const sl::FrameToken& _frameToken);
         void reflexPresentEnd(const sl::FrameToken& _frameToken);
@@ -41,20 +46,20 @@ namespace Engine
             const glm::mat4& _viewMatrix, const glm::mat4& _projectionMatrix,
             const glm::mat4& _prevViewMatrix, const glm::mat4& _prevProjectionMatrix,
             VkExtent2D _renderSize, VkExtent2D _displaySize, 
-            float _nearZ, float _farZ, bool _depthInverted,
-            glm::vec2 _motionVecScale
+            float _nearZ, float _farZ, bool _depthInverted
         );
         void tagResources(
             VkImage _depth, VkImageView _depthView, VkDeviceMemory _depthMem,
             VkImage _motionVec, VkImageView _motionVecView, VkDeviceMemory _motionVecMem,
             VkImage _hudlessColour, VkImageView _hudlessColourView, VkDeviceMemory _hudlessColourMem,
-            VkExtent2D _extent, VkCommandBuffer _cmd
+            VkFormat _hudlessColourFormat, VkImageLayout _hudlessColourLayout,
+            VkExtent2D _renderExtent, VkExtent2D _displayExtent, VkExtent2D _renderTargetExtent, VkCommandBuffer _cmd
         );
 
         void setDLSSGOptions(const bool _enable);
          
         void triggerReset(uint32_t _frames = 2) { m_resetFrames = _frames; }
-        void markPresented() { m_seenFirstPresent = true; };
+        void markPresented() { m_seenFirstPresent.store(true, std::memory_order_relaxed); };
 
         void evaluateFeature(VkCommandBuffer _cmd);
 
@@ -69,8 +74,11 @@ namespace Engine
         sl::Constants m_lastConstants{};
         sl::ViewportHandle m_viewport = sl::ViewportHandle(0);
 
-        bool m_seenFirstPresent = false;
+        // Written from the present thread when it is enabled
+        std::atomic<bool> m_seenFirstPresent{ false };
+        mutable std::mutex m_stateMutex; // Guards m_lastState
         uint32_t m_resetFrames = 2;
+        bool m_reflexLowLatency = false;
 
         uint64_t m_frameIndex = 0;
     };
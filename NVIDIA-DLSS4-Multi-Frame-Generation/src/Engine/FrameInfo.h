@@ -2,13 +2,19 @@
 #include "Camera.h"
 #include "GameObject.h"
 #include "descriptors.h"
+#include "FrameArena.h"
 
 #include <vulkan/vulkan.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace Engine
 {
     #define MAX_LIGHTS 10
 
+    struct MeshletCullingSystem;
+
     struct PointLight 
     {
         // Both vec4 for simple memory alignment
@@ -38,5 +44,26 @@ namespace Engine
         VkDescriptorSet m_globalDescriptorSet;
         DescriptorPool& m_frameDescriptorPool;
         GameObject::Map& m_gameObjects;
+        FrameArena& m_frameArena; // Transient allocations, valid until this frame slot is reused
+        MeshletCullingSystem* m_meshletCulling = nullptr; // Set once cull() has been recorded for this frame
+        // Pixels per unit of simplification error at distance 1, divided by the allowed pixel error. 0 keeps LOD 0
+        float m_lodErrorScale = 0.0f;
+        uint64_t m_trianglesSubmitted = 0; // Counted by the render systems, before any GPU culling
+
+        // Coarsest LOD of _obj's model whose error projects within the allowed pixels
+        uint32_t selectLod(GameObject& _obj) const
+        {
+            if (m_lodErrorScale <= 0.0f || _obj.m_model == nullptr) return 0;
+
+            const glm::vec4& sphere = _obj.m_model->getBoundingSphere();
+            const glm::vec3& scale = _obj.m_transform.m_scale;
+            const float maxScale = std::max({ std::abs(scale.x), std::abs(scale.y), std::abs(scale.z) });
+            const glm::vec3 centre{ _obj.m_transform.mat4() * glm::vec4(glm::vec3(sphere), 1.0f) };
+
+            // From the nearest point of the bounds, so large objects up close stay at full detail
+            const float distance = glm::length(centre - m_camera.getPosition()) - sphere.w * maxScale;
+            if (distance <= 0.0f) return 0;
+            return _obj.m_model->selectLod(distance, m_lodErrorScale * maxScale);
+        }
     };
 }
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Engine
+{
+    namespace
+    {
+        // Bounded so forget() and shutdown never wait long on a present that is never shown
+        constexpr uint64_t PRESENT_WAIT_TIMEOUT_NS = 100'000'000;
+        // Presents not yet waited on. Older ones are dropped rather than falling further behind
+        constexpr size_t MAX_QUEUED_PRESENTS = 8;
+        // Sleep this much short of the start time and spin the rest, sleeps overshoot
+        constexpr std::chrono::microseconds SPIN_MARGIN{ 2000 };
+    }
+
+    FramePacer::FramePacer(EngineDevice& _device, SlVkProxies& _slProxies)
+        : m_device(_device), m_slProxies(_slProxies)
+    {
+        // Starting point until FIFO display times refine it
+        if (GLFWmonitor* monitor = glfwGetPrimaryMonitor())
+        {
+            const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+            if (mode != nullptr && mode->refreshRate > 0)
+                m_refreshSeconds = 1.0 / mode->refreshRate;
+        }
+
+        if (isSupported())
+            m_thread = std::thread(&FramePacer::run, this);
+    }
+
+    FramePacer::~FramePacer()
+    {
+        stop();
+    }
+
+    void FramePacer::stop()
+    {
+        m_enabled = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_queue.clear();
+        }
+        m_condition.notify_all();
+
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void FramePacer::setEnabled(bool _enabled)
+    {
+        m_enabled = _enabled && isSupported() && m_thread.joinable();
+
+        // Start measuring from scratch, the last estimates may come from another mode or multiplier
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.clear();
+        m_leadValid = false;
+        m_lastDisplayedId = 0;
+        m_intervalMean = 0.0;
+        m_intervalVariance = 0.0;
+        m_displayed = 0;
+        m_missed = 0;
+    }
+
+    void FramePacer::setFrameMultiplier(uint32_t _multiplier)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frameMultiplier = std::max(1u, _multiplier);
+    }
+
+    void FramePacer::setRefreshLocked(bool _locked)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_refreshLocked = _locked;
+    }
+
+    void FramePacer::waitForNextFrame()
+    {
+        m_frameTarget = {};
+        if (!m_enabled)
+        {
+            m_frameStart = Clock::now();
+            return;
+        }
+
+        Clock::time_point lastDisplay;
+        uint64_t lastDisplayedId;
+        double refreshSeconds;
+        double leadSeconds;
+        uint32_t frameMultiplier;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_leadValid || m_lastDisplayedId == 0)
+            {
+                m_frameStart = Clock::now();
+                return;
+            }
+            lastDisplay = m_lastDisplay;
+            lastDisplayedId = m_lastDisplayedId;
+            refreshSeconds = m_refreshSeconds;
+            leadSeconds = m_leadSeconds;
+            frameMultiplier = m_frameMultiplier;
+        }
+
+        // Each real frame owns one slot of multiplier refreshes, counted from the last frame seen on screen
+        const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(refreshSeconds * frameMultiplier));
+        const auto lead = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(leadSeconds));
+        const uint64_t slots = m_lastPresentId >= lastDisplayedId ? m_lastPresentId + 1 - lastDisplayedId : 1;
+        Clock::time_point target = lastDisplay + interval * static_cast<int64_t>(slots);
+
+        // Running late, aim for the first slot that can still be made
+        Clock::time_point now = Clock::now();
+        if (target - lead < now)
+            target += interval * ((now - (target - lead)) / interval + 1);
+
+        const Clock::time_point start = target - lead;
+        if (start - now > interval * 4)
+        {
+            // Estimates are off, e.g. after a stall. Run free until new display times arrive
+            m_frameStart = now;
+            return;
+        }
+
+        if (start - now > SPIN_MARGIN)
+            std::this_thread::sleep_until(start - SPIN_MARGIN);
+        while (Clock::now() < start)
+            std::this_thread::yield();
+
+        m_frameStart = Clock::now();
+        m_frameTarget = target;
+    }
+
+    void FramePacer::onPresent(VkSwapchainKHR _swapChain, uint64_t _presentId, double _blockedSeconds)
+    {
+        if (!m_enabled) return;
+
+        m_lastPresentId = _presentId;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (m_queue.size() >= MAX_QUEUED_PRESENTS)
+                m_queue.pop_front();
+            m_queue.push_back({ _swapChain, _presentId, m_frameStart, m_frameTarget, _blockedSeconds });
+        }
+        m_condition.notify_all();
+    }
+
+    void FramePacer::forget(VkSwapchainKHR _swapChain)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::erase_if(m_queue, [_swapChain](const Present& _present) { return _present.m_swapChain == _swapChain; });
+        m_condition.wait(lock, [this, _swapChain]() { return m_waitingOn != _swapChain; });
+    }
+
+    FramePacer::Stats FramePacer::stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats;
+        stats.m_refreshMs = m_refreshSeconds * 1000.0;
+        stats.m_displayIntervalMs = m_intervalMean * 1000.0;
+        stats.m_displayJitterMs = std::sqrt(m_intervalVariance) * 1000.0;
+        stats.m_leadMs = m_leadSeconds * 1000.0;
+        stats.m_displayed = m_displayed;
+        stats.m_missed = m_missed;
+        return stats;
+    }
+
+    void FramePacer::run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_condition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) return;
+
+            Present present = m_queue.front();
+            m_queue.pop_front();
+            m_waitingOn = present.m_swapChain;
+            lock.unlock();
+
+            VkResult result = m_slProxies.WaitForPresentKHR(m_device.device(), present.m_swapChain, present.m_id, PRESENT_WAIT_TIMEOUT_NS);
+            const Clock::time_point displayTime = Clock::now();
+
+            lock.lock();
+            m_waitingOn = VK_NULL_HANDLE;
+            if (result == VK_SUCCESS)
+                onDisplayed(present, displayTime);
+            m_condition.notify_all();
+        }
+    }
+
+    void FramePacer::onDisplayed(const Present& _present, Clock::time_point _displayTime)
+    {
+        constexpr double SMOOTHING = 0.05;
+
+        if (m_lastDisplayedId != 0 && _present.m_id > m_lastDisplayedId)
+        {
+            const double interval = std::chrono::duration<double>(_displayTime - m_lastDisplay).count() / (_present.m_id - m_lastDisplayedId);
+            const double delta = interval - m_intervalMean;
+            m_intervalMean += SMOOTHING * delta;
+            m_intervalVariance = (1.0 - SMOOTHING) * (m_intervalVariance + SMOOTHING * delta * delta);
+
+            // FIFO display times are whole refreshes apart, so each interval is a noisy multiple of the refresh
+            const double refreshes = std::round(interval / m_refreshSeconds);
+            if (m_refreshLocked && refreshes >= 1.0 && refreshes <= 8.0)
+                m_refreshSeconds += SMOOTHING * (interval / refreshes - m_refreshSeconds);
+        }
+        m_lastDisplay = _displayTime;
+        m_lastDisplayedId = _present.m_id;
+        m_displayed++;
+
+        // Time spent blocked in acquire is queueing, the frame could have started that much later
+        const double measuredLead = std::chrono::duration<double>(_displayTime - _present.m_start).count() - _present.m_blockedSeconds;
+        if (!m_leadValid)
+        {
+            m_leadSeconds = std::max(measuredLead, 0.0);
+            m_leadValid = true;
+        }
+        else if (_present.m_target != Clock::time_point{})
+        {
+            // Missing a slot backs off by half a refresh, making one squeezes the lead a little
+            if (_displayTime > _present.m_target + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_refreshSeconds * 0.5)))
+            {
+                m_missed++;
+                m_leadSeconds = std::min(m_leadSeconds + m_refreshSeconds * 0.5, m_refreshSeconds * m_frameMultiplier * 4.0);
+            }
+            else
+            {
+                m_leadSeconds = std::max(m_leadSeconds - m_refreshSeconds * 0.01, 0.0);
+            }
+        }
+    }
+}
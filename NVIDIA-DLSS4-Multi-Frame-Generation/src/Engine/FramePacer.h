@@ -0,0 +1,104 @@
+#pragma once
+#include "EngineDevice.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Engine
+{
+    /*
+     * Display synchronised frame pacing from VK_KHR_present_wait. Every present carries a present
+     * ID, and a pacing thread waits on each one to learn when it actually reached the display.
+     * From that it tracks the refresh interval and how long a frame takes from its start to the
+     * display. waitForNextFrame() then holds the next frame back so it starts just in time for its
+     * display slot, one slot per real frame times the frame generation multiplier, instead of
+     * starting early and blocking in acquire with stale input.
+     */
+    struct FramePacer
+    {
+        struct Stats
+        {
+            double m_refreshMs = 0.0;        // Estimated display refresh interval
+            double m_displayIntervalMs = 0.0; // Average time between displayed real frames
+            double m_displayJitterMs = 0.0;   // Standard deviation of that interval
+            double m_leadMs = 0.0;            // How far ahead of its display slot a frame is started
+            uint64_t m_displayed = 0;
+            uint64_t m_missed = 0;            // Frames displayed at least half a refresh after their slot
+        };
+
+        FramePacer(EngineDevice& _device, SlVkProxies& _slProxies);
+        ~FramePacer();
+
+        FramePacer(const FramePacer&) = delete;
+        FramePacer& operator=(const FramePacer&) = delete;
+
+        bool isSupported() const { return m_device.presentWaitEnabled(); }
+        bool isEnabled() const { return m_enabled; }
+        void setEnabled(bool _enabled);
+
+        // Real frames per displayed frame run, 1 + generated frames when frame generation is on
+        void setFrameMultiplier(uint32_t _multiplier);
+        // FIFO modes only present on a refresh, so their display times can refine the refresh estimate
+        void setRefreshLocked(bool _locked);
+
+        // Main thread, before the frame samples input. Sleeps until the frame's scheduled start
+        void waitForNextFrame();
+        // Main thread, after _presentId was presented to _swapChain. _blockedSeconds is how long the
+        // frame spent waiting in acquire, time it could have started later without displaying later
+        void onPresent(VkSwapchainKHR _swapChain, uint64_t _presentId, double _blockedSeconds);
+        // Main thread, before _swapChain is destroyed. Returns once the pacing thread has let go of it
+        void forget(VkSwapchainKHR _swapChain);
+        // Main thread. Disables pacing and joins the pacing thread, which calls through the Streamline
+        // proxies, so it must run before Streamline shuts down
+        void stop();
+
+        Stats stats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Present
+        {
+            VkSwapchainKHR m_swapChain;
+            uint64_t m_id;
+            Clock::time_point m_start;
+            Clock::time_point m_target; // Display slot it was scheduled for, epoch if unscheduled
+            double m_blockedSeconds;
+        };
+
+        void run();
+        void onDisplayed(const Present& _present, Clock::time_point _displayTime);
+
+        EngineDevice& m_device;
+        SlVkProxies& m_slProxies;
+        bool m_enabled = false;
+
+        // Main thread only
+        Clock::time_point m_frameStart{};
+        Clock::time_point m_frameTarget{};
+        uint64_t m_lastPresentId = 0;
+
+        std::thread m_thread;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<Present> m_queue;
+        VkSwapchainKHR m_waitingOn = VK_NULL_HANDLE;
+        bool m_stopping = false;
+
+        // Shared with the pacing thread, guarded by m_mutex
+        uint32_t m_frameMultiplier = 1;
+        bool m_refreshLocked = false;
+        double m_refreshSeconds = 1.0 / 60.0;
+        double m_leadSeconds = 0.0;
+        bool m_leadValid = false;
+        Clock::time_point m_lastDisplay{};
+        uint64_t m_lastDisplayedId = 0;
+        double m_intervalMean = 0.0;
+        double m_intervalVariance = 0.0;
+        uint64_t m_displayed = 0;
+        uint64_t m_missed = 0;
+    };
+}
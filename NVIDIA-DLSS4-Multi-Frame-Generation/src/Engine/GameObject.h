@@ -1,6 +1,7 @@
 #pragma once
 #include "ModelHandler.h"
 #include "texture.h"
+#include "SlotMap.h"
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -27,15 +28,11 @@ namespace Engine
 
     struct GameObject 
     {
-        using id_t = unsigned int;
-        using Map = std::unordered_map<id_t, GameObject>;
+        // Ids are handed out by the Map on insert and go stale once the object is erased
+        using id_t = SlotKey;
+        using Map = SlotMap<GameObject>;
 
-        static GameObject createGameObject()
-        {
-            static id_t currentId = 0;
-            return GameObject(currentId++);
-        }
-        id_t getId() const { return m_id; }
+        static GameObject createGameObject() { return GameObject(); }
 
         static GameObject makePointLight(float _intensity = 5.0f, float _radius = 0.1f, glm::vec3 _colour = glm::vec3(1.0f));
 
@@ -52,8 +49,10 @@ namespace Engine
         std::shared_ptr<Texture> m_diffuseMap = nullptr;
         std::unique_ptr<PointLightComponent> m_pointLight = nullptr;
 
+        // Cull the model per meshlet on the GPU, see MeshletCullingSystem
+        bool m_meshletCulling = false;
+
     private:
-        GameObject(id_t _objId) : m_id(_objId) {}
-        id_t m_id;
+        GameObject() = default;
     };
 }
\ No newline at end of file
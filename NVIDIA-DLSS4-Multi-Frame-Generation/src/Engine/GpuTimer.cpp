@@ -0,0 +1,62 @@
+#include "GpuTimer.h"
+
+#include <stdexcept>
+
+namespace Engine
+{
+    GpuTimer::GpuTimer(EngineDevice& _device, uint32_t _frameCount)
+        : m_device(_device), m_pending(_frameCount, 0)
+    {
+        // Timing is diagnostics only, run without it rather than fail
+        const VkPhysicalDeviceLimits& limits = m_device.properties.limits;
+        if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.0f)
+            return;
+        m_nanosecondsPerTick = limits.timestampPeriod;
+
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = _frameCount * 2;
+
+        if (vkCreateQueryPool(m_device.device(), &poolInfo, nullptr, &m_queryPool) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create timestamp query pool!");
+    }
+
+    GpuTimer::~GpuTimer()
+    {
+        if (m_queryPool != VK_NULL_HANDLE)
+            vkDestroyQueryPool(m_device.device(), m_queryPool, nullptr);
+    }
+
+    void GpuTimer::begin(VkCommandBuffer _commandBuffer, uint32_t _frameIndex)
+    {
+        if (!isSupported()) return;
+
+        vkCmdResetQueryPool(_commandBuffer, m_queryPool, _frameIndex * 2, 2);
+        vkCmdWriteTimestamp(_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, _frameIndex * 2);
+    }
+
+    void GpuTimer::end(VkCommandBuffer _commandBuffer, uint32_t _frameIndex)
+    {
+        if (!isSupported()) return;
+
+        vkCmdWriteTimestamp(_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, _frameIndex * 2 + 1);
+        m_pending[_frameIndex] = 1;
+    }
+
+    bool GpuTimer::resolve(uint32_t _frameIndex, double& _outMilliseconds)
+    {
+        if (!isSupported() || !m_pending[_frameIndex]) return false;
+        m_pending[_frameIndex] = 0;
+
+        // Value and availability for each of the two queries
+        uint64_t results[4] = {};
+        VkResult result = vkGetQueryPoolResults(m_device.device(), m_queryPool, _frameIndex * 2, 2, sizeof(results), results,
+            sizeof(uint64_t) * 2, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS || results[1] == 0 || results[3] == 0 || results[2] < results[0])
+            return false;
+
+        _outMilliseconds = static_cast<double>(results[2] - results[0]) * m_nanosecondsPerTick / 1.0e6;
+        return true;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "EngineDevice.h"
+
+namespace Engine
+{
+    /*
+     * GPU time between begin() and end() in one command buffer per frame slot, from timestamp
+     * queries. A slot's result is read when the slot comes round again, after its frame has
+     * retired on the frame timeline, so reading never stalls the CPU.
+     */
+    struct GpuTimer
+    {
+        GpuTimer(EngineDevice& _device, uint32_t _frameCount);
+        ~GpuTimer();
+
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer& operator=(const GpuTimer&) = delete;
+
+        // Both must be recorded outside a render pass
+        void begin(VkCommandBuffer _commandBuffer, uint32_t _frameIndex);
+        void end(VkCommandBuffer _commandBuffer, uint32_t _frameIndex);
+
+        // Call once the slot's previous frame has retired. False if it has no finished measurement
+        bool resolve(uint32_t _frameIndex, double& _outMilliseconds);
+
+        bool isSupported() const { return m_queryPool != VK_NULL_HANDLE; }
+
+    private:
+        EngineDevice& m_device;
+        VkQueryPool m_queryPool = VK_NULL_HANDLE;
+        double m_nanosecondsPerTick = 1.0;
+        std::vector<uint8_t> m_pending;
+    };
+}
@@ -4,37 +4,53 @@
 
 namespace Engine
 {
-    void InputHandler::moveInPlaneXZ(GLFWwindow* _window, float _DT, GameObject& _gameObject)
+    InputHandler::Movement InputHandler::sampleMovement(GLFWwindow* _window) const
     {
-        glm::vec3 rotate(0.0f);
-
-        if (glfwGetKey(_window, m_keys.LOOK_RIGHT) == GLFW_PRESS) rotate.y += 1.0f;
-        if (glfwGetKey(_window, m_keys.LOOK_LEFT) == GLFW_PRESS) rotate.y -= 1.0f;
-        if (glfwGetKey(_window, m_keys.LOOK_UP) == GLFW_PRESS) rotate.x += 1.0f;
-        if (glfwGetKey(_window, m_keys.LOOK_DOWN) == GLFW_PRESS) rotate.x -= 1.0f;
+        Movement movement{};
+        movement.m_lookSpeed = m_lookSpeed;
+        movement.m_moveSpeed = m_moveSpeed;
+
+        if (glfwGetKey(_window, m_keys.LOOK_RIGHT) == GLFW_PRESS) movement.m_rotate.y += 1.0f;
+        if (glfwGetKey(_window, m_keys.LOOK_LEFT) == GLFW_PRESS) movement.m_rotate.y -= 1.0f;
+        if (glfwGetKey(_window, m_keys.LOOK_UP) == GLFW_PRESS) movement.m_rotate.x += 1.0f;
+        if (glfwGetKey(_window, m_keys.LOOK_DOWN) == GLFW_PRESS) movement.m_rotate.x -= 1.0f;
+
+        if (glfwGetKey(_window, m_keys.MOVE_FORWARD) == GLFW_PRESS) movement.m_move.z += 1.0f;
+        if (glfwGetKey(_window, m_keys.MOVE_BACKWARD) == GLFW_PRESS) movement.m_move.z -= 1.0f;
+        if (glfwGetKey(_window, m_keys.MOVE_RIGHT) == GLFW_PRESS) movement.m_move.x += 1.0f;
+        if (glfwGetKey(_window, m_keys.MOVE_LEFT) == GLFW_PRESS) movement.m_move.x -= 1.0f;
+        if (glfwGetKey(_window, m_keys.MOVE_UP) == GLFW_PRESS) movement.m_move.y += 1.0f;
+        if (glfwGetKey(_window, m_keys.MOVE_DOWN) == GLFW_PRESS) movement.m_move.y -= 1.0f;
+
+        return movement;
+    }
 
+    void InputHandler::moveInPlaneXZ(const Movement& _movement, float _DT, TransformComponent& _transform)
+    {
+        const glm::vec3& rotate = _movement.m_rotate;
         if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon())
-            _gameObject.m_transform.m_rotation += m_lookSpeed * _DT * glm::normalize(rotate);
+            _transform.m_rotation += _movement.m_lookSpeed * _DT * glm::normalize(rotate);
 
-        _gameObject.m_transform.m_rotation.x = glm::clamp(_gameObject.m_transform.m_rotation.x, -glm::half_pi<float>(), glm::half_pi<float>());
-        _gameObject.m_transform.m_rotation.y = glm::mod(_gameObject.m_transform.m_rotation.y, glm::two_pi<float>());
+        _transform.m_rotation.x = glm::clamp(_transform.m_rotation.x, -glm::half_pi<float>(), glm::half_pi<float>());
+        _transform.m_rotation.y = glm::mod(_transform.m_rotation.y, glm::two_pi<float>());
 
 
-        float yaw = _gameObject.m_transform.m_rotation.y;
+        float yaw = _transform.m_rotation.y;
         const glm::vec3 forwardDirection(glm::sin(yaw), 0.0f, glm::cos(yaw));
         const glm::vec3 rightDirection(forwardDirection.z, 0.0f, -forwardDirection.x);
         const glm::vec3 upDirection(0.0f, -1.0f, 0.0f); // -1.0f because y axis points down in Vulkan
 
-        glm::vec3 moveDirection(0.0f);
-
-        if (glfwGetKey(_window, m_keys.MOVE_FORWARD) == GLFW_PRESS) moveDirection += forwardDirection;
-        if (glfwGetKey(_window, m_keys.MOVE_BACKWARD) == GLFW_PRESS) moveDirection -= forwardDirection;
-        if (glfwGetKey(_window, m_keys.MOVE_RIGHT) == GLFW_PRESS) moveDirection += rightDirection;
-        if (glfwGetKey(_window, m_keys.MOVE_LEFT) == GLFW_PRESS) moveDirection -= rightDirection;
-        if (glfwGetKey(_window, m_keys.MOVE_UP) == GLFW_PRESS) moveDirection += upDirection;
-        if (glfwGetKey(_window, m_keys.MOVE_DOWN) == GLFW_PRESS) moveDirection -= upDirection;
+        const glm::vec3 moveDirection = _movement.m_move.x * rightDirection + _movement.m_move.y * upDirection + _movement.m_move.z * forwardDirection;
 
         if (glm::dot(moveDirection, moveDirection) > std::numeric_limits<float>::epsilon())
-            _gameObject.m_transform.m_translation += m_moveSpeed * _DT * glm::normalize(moveDirection);
+            _transform.m_translation += _movement.m_moveSpeed * _DT * glm::normalize(moveDirection);
+    }
+
+    bool InputHandler::wasKeyPressed(GLFWwindow* _window, int _key)
+    {
+        bool down = glfwGetKey(_window, _key) == GLFW_PRESS;
+        bool pressed = down && !m_keyDown[_key];
+        m_keyDown[_key] = down;
+        return pressed;
     }
 }
\ No newline at end of file
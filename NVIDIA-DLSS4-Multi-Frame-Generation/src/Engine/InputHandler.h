@@ -2,6 +2,8 @@
 #include "GameObject.h"
 #include "Window.h"
 
+#include <array>
+
 namespace Engine
 {
     struct InputHandler 
@@ -18,12 +20,43 @@ namespace Engine
             static constexpr int LOOK_RIGHT = GLFW_KEY_RIGHT;
             static constexpr int LOOK_UP = GLFW_KEY_UP;
             static constexpr int LOOK_DOWN = GLFW_KEY_DOWN;
+
+            // Debug
+            static constexpr int DUMP_RESOURCE_REPORT = GLFW_KEY_F1;
+            static constexpr int CYCLE_LOD_POLICY = GLFW_KEY_F2;
+            static constexpr int TOGGLE_TEXTURE_MIPS = GLFW_KEY_F3;
+            static constexpr int CYCLE_SCENE = GLFW_KEY_F4;
+            static constexpr int CYCLE_FRAME_PACING = GLFW_KEY_F5;
+            static constexpr int TOGGLE_FRAME_GENERATION = GLFW_KEY_F6;
+            static constexpr int CYCLE_PRESENT_MODE = GLFW_KEY_F7;
+            static constexpr int TOGGLE_FRAME_PACER = GLFW_KEY_F8;
+            static constexpr int TOGGLE_PRESENT_THREAD = GLFW_KEY_F9;
+            static constexpr int TOGGLE_SIMULATION_THREAD = GLFW_KEY_F10;
+            static constexpr int TOGGLE_LATENCY_LIMITER = GLFW_KEY_F11;
+            static constexpr int TOGGLE_DYNAMIC_RESOLUTION = GLFW_KEY_F12;
+            static constexpr int CYCLE_UPSCALER_PRESET = GLFW_KEY_U;
         };
 
         keyMappings m_keys;
         float m_moveSpeed = 3.0f;
         float m_lookSpeed = 1.5f;
 
-        void moveInPlaneXZ(GLFWwindow* _window, float _DT, GameObject& _gameObject);
+        // Movement keys held at the time of sampling. GLFW input is main thread only, so the simulation
+        // thread moves the camera from a sample rather than reading keys itself
+        struct Movement
+        {
+            glm::vec3 m_rotate{ 0.0f }; // x looks up, y looks right
+            glm::vec3 m_move{ 0.0f };   // x right, y up, z forward, relative to the camera's yaw
+            float m_lookSpeed = 0.0f;
+            float m_moveSpeed = 0.0f;
+        };
+        Movement sampleMovement(GLFWwindow* _window) const;
+        static void moveInPlaneXZ(const Movement& _movement, float _DT, TransformComponent& _transform);
+
+        // True only on the frame the key goes down
+        bool wasKeyPressed(GLFWwindow* _window, int _key);
+
+    private:
+        std::array<bool, GLFW_KEY_LAST + 1> m_keyDown{};
     };
 }
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include "Ktx2File.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+        struct Ktx2Header
+        {
+            uint8_t m_identifier[12];
+            uint32_t m_vkFormat;
+            uint32_t m_typeSize;
+            uint32_t m_pixelWidth;
+            uint32_t m_pixelHeight;
+            uint32_t m_pixelDepth;
+            uint32_t m_layerCount;
+            uint32_t m_faceCount;
+            uint32_t m_levelCount;
+            uint32_t m_supercompressionScheme;
+
+            uint32_t m_dfdByteOffset;
+            uint32_t m_dfdByteLength;
+            uint32_t m_kvdByteOffset;
+            uint32_t m_kvdByteLength;
+            uint64_t m_sgdByteOffset;
+            uint64_t m_sgdByteLength;
+        };
+        static_assert(sizeof(Ktx2Header) == 80, "KTX2 header must match the file layout");
+
+        struct Ktx2LevelIndex
+        {
+            uint64_t m_byteOffset;
+            uint64_t m_byteLength;
+            uint64_t m_uncompressedByteLength;
+        };
+
+        // Data format descriptor values (Khronos Data Format 1.3, khr_df.h)
+        constexpr uint32_t DF_MODEL_RGBSDA = 1;
+        constexpr uint32_t DF_MODEL_BC1A = 128;
+        constexpr uint32_t DF_MODEL_BC3 = 130;
+        constexpr uint32_t DF_MODEL_BC7 = 134;
+        constexpr uint32_t DF_PRIMARIES_BT709 = 1;
+        constexpr uint32_t DF_TRANSFER_LINEAR = 1;
+        constexpr uint32_t DF_TRANSFER_SRGB = 2;
+        constexpr uint32_t DF_CHANNEL_ALPHA = 15;
+        constexpr uint32_t DF_SAMPLE_LINEAR = 0x10;
+
+        bool isSrgb(VkFormat _format)
+        {
+            return _format == VK_FORMAT_R8G8B8A8_SRGB || _format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || _format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK ||
+                   _format == VK_FORMAT_BC3_SRGB_BLOCK || _format == VK_FORMAT_BC7_SRGB_BLOCK;
+        }
+
+        // Basic descriptor block, which the spec requires even though our loader only reads vkFormat
+        std::vector<uint32_t> buildDataFormatDescriptor(VkFormat _format)
+        {
+            struct Sample { uint32_t m_bitOffset; uint32_t m_bitLength; uint32_t m_channel; uint32_t m_upper; };
+            std::vector<Sample> samples;
+            uint32_t model = DF_MODEL_RGBSDA;
+            const uint32_t alphaChannel = DF_CHANNEL_ALPHA | (isSrgb(_format) ? DF_SAMPLE_LINEAR : 0);
+
+            switch (_format)
+            {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                model = DF_MODEL_BC1A;
+                samples = { { 0, 64, 0, UINT32_MAX } };
+                break;
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                model = DF_MODEL_BC1A;
+                samples = { { 0, 64, DF_CHANNEL_ALPHA, UINT32_MAX } };
+                break;
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+                model = DF_MODEL_BC3;
+                samples = { { 0, 64, alphaChannel, UINT32_MAX }, { 64, 64, 0, UINT32_MAX } };
+                break;
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+                model = DF_MODEL_BC7;
+                samples = { { 0, 128, 0, UINT32_MAX } };
+                break;
+            default:
+                samples = { { 0, 8, 0, 255 }, { 8, 8, 1, 255 }, { 16, 8, 2, 255 }, { 24, 8, alphaChannel, 255 } };
+                break;
+            }
+
+            Ktx2File::FormatInfo info{};
+            Ktx2File::formatInfo(_format, info);
+            const uint32_t blockDimension = info.m_blockExtent - 1;
+            const uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+
+            std::vector<uint32_t> words;
+            words.push_back(4 + blockSize); // dfdTotalSize
+            words.push_back(0); // Khronos vendor, basic descriptor type
+            words.push_back(2 | (blockSize << 16)); // Version 1.3
+            words.push_back(model | (DF_PRIMARIES_BT709 << 8) | ((isSrgb(_format) ? DF_TRANSFER_SRGB : DF_TRANSFER_LINEAR) << 16));
+            words.push_back(blockDimension | (blockDimension << 8));
+            words.push_back(info.m_blockBytes); // bytesPlane0
+            words.push_back(0);
+            for (const Sample& sample : samples)
+            {
+                words.push_back(sample.m_bitOffset | ((sample.m_bitLength - 1) << 16) | (sample.m_channel << 24));
+                words.push_back(0); // Sample position
+                words.push_back(0);
+                words.push_back(sample.m_upper);
+            }
+            return words;
+        }
+
+        uint64_t alignUp(uint64_t _value, uint64_t _alignment)
+        {
+            return (_value + _alignment - 1) / _alignment * _alignment;
+        }
+    }
+
+    bool Ktx2File::formatInfo(VkFormat _format, FormatInfo& _outInfo)
+    {
+        switch (_format)
+        {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            _outInfo = { 1, 4 };
+            return true;
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            _outInfo = { 4, 8 };
+            return true;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            _outInfo = { 4, 16 };
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool Ktx2File::isBlockCompressed(VkFormat _format)
+    {
+        FormatInfo info{};
+        return formatInfo(_format, info) && info.m_blockExtent > 1;
+    }
+
+    uint64_t Ktx2File::levelSize(VkFormat _format, uint32_t _width, uint32_t _height)
+    {
+        FormatInfo info{};
+        if (!formatInfo(_format, info)) return 0;
+        const uint64_t blocksWide = (uint64_t(_width) + info.m_blockExtent - 1) / info.m_blockExtent;
+        const uint64_t blocksHigh = (uint64_t(_height) + info.m_blockExtent - 1) / info.m_blockExtent;
+        return blocksWide * blocksHigh * info.m_blockBytes;
+    }
+
+    std::string Ktx2File::pathFor(const std::string& _sourcePath)
+    {
+        return std::filesystem::path(_sourcePath).replace_extension(".ktx2").string();
+    }
+
+    bool Ktx2File::open(const std::string& _filePath)
+    {
+        m_levels.clear();
+        if (!m_file.open(_filePath)) return false;
+
+        const size_t fileSize = m_file.size();
+        Ktx2Header header;
+        if (fileSize < sizeof(header))
+        {
+            m_file.close();
+            return false;
+        }
+        std::memcpy(&header, m_file.data(), sizeof(header));
+
+        // Level count 0 asks the loader to generate mips, which is the same as shipping one level
+        const uint32_t levelCount = std::max(header.m_levelCount, 1u);
+        const VkFormat format = static_cast<VkFormat>(header.m_vkFormat);
+        FormatInfo info{};
+
+        bool valid = std::memcmp(header.m_identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0 &&
+                     formatInfo(format, info) &&
+                     header.m_pixelWidth > 0 && header.m_pixelHeight > 0 && header.m_pixelDepth == 0 &&
+                     header.m_layerCount <= 1 && header.m_faceCount == 1 &&
+                     header.m_supercompressionScheme == 0 &&
+                     levelCount <= 32 && (std::max(header.m_pixelWidth, header.m_pixelHeight) >> (levelCount - 1)) > 0 &&
+                     sizeof(Ktx2Header) + uint64_t(levelCount) * sizeof(Ktx2LevelIndex) <= fileSize;
+
+        if (valid)
+        {
+            m_levels.reserve(levelCount);
+            for (uint32_t level = 0; level < levelCount && valid; level++)
+            {
+                Ktx2LevelIndex index;
+                std::memcpy(&index, m_file.data() + sizeof(Ktx2Header) + level * sizeof(Ktx2LevelIndex), sizeof(index));
+
+                const uint32_t width = std::max(header.m_pixelWidth >> level, 1u);
+                const uint32_t height = std::max(header.m_pixelHeight >> level, 1u);
+                valid = index.m_byteOffset % info.m_blockBytes == 0 &&
+                        index.m_byteOffset <= fileSize && index.m_byteLength <= fileSize - index.m_byteOffset &&
+                        index.m_byteLength == levelSize(format, width, height);
+                m_levels.push_back({ m_file.data() + index.m_byteOffset, index.m_byteLength });
+            }
+        }
+
+        if (!valid)
+        {
+            m_levels.clear();
+            m_file.close();
+            return false;
+        }
+
+        m_format = format;
+        m_width = header.m_pixelWidth;
+        m_height = header.m_pixelHeight;
+        return true;
+    }
+
+    bool Ktx2File::write(const std::string& _filePath, VkFormat _format, uint32_t _width, uint32_t _height,
+        const std::vector<std::vector<uint8_t>>& _levels)
+    {
+        FormatInfo info{};
+        if (!formatInfo(_format, info) || _levels.empty()) return false;
+
+        const uint32_t levelCount = static_cast<uint32_t>(_levels.size());
+        const std::vector<uint32_t> dfd = buildDataFormatDescriptor(_format);
+
+        Ktx2Header header{};
+        std::memcpy(header.m_identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+        header.m_vkFormat = static_cast<uint32_t>(_format);
+        header.m_typeSize = 1;
+        header.m_pixelWidth = _width;
+        header.m_pixelHeight = _height;
+        header.m_faceCount = 1;
+        header.m_levelCount = levelCount;
+        header.m_dfdByteOffset = static_cast<uint32_t>(sizeof(Ktx2Header) + levelCount * sizeof(Ktx2LevelIndex));
+        header.m_dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+        // The spec stores the smallest level first, each aligned to lcm(block size, 4)
+        const uint64_t alignment = info.m_blockBytes;
+        std::vector<Ktx2LevelIndex> index(levelCount);
+        uint64_t offset = header.m_dfdByteOffset + header.m_dfdByteLength;
+        for (uint32_t level = levelCount; level-- > 0;)
+        {
+            offset = alignUp(offset, alignment);
+            index[level] = { offset, _levels[level].size(), _levels[level].size() };
+            offset += _levels[level].size();
+        }
+
+        // Write next to the target and rename, so a half written file is never picked up
+        const std::string tempPath = _filePath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(Ktx2LevelIndex)));
+            file.write(reinterpret_cast<const char*>(dfd.data()), static_cast<std::streamsize>(header.m_dfdByteLength));
+            for (uint32_t level = levelCount; level-- > 0;)
+            {
+                static const char padding[16] = {};
+                const uint64_t position = static_cast<uint64_t>(file.tellp());
+                file.write(padding, static_cast<std::streamsize>(index[level].m_byteOffset - position));
+                file.write(reinterpret_cast<const char*>(_levels[level].data()), static_cast<std::streamsize>(_levels[level].size()));
+            }
+            if (!file) return false;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, _filePath, error);
+        if (error)
+        {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+}
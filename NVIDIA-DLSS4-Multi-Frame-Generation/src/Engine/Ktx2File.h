@@ -0,0 +1,63 @@
+#pragma once
+#include "MappedFile.h"
+
+#include <vulkan/vulkan.h>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    /*
+     * KTX2 container (Khronos KTX 2.0) holding a single 2D image with its mip levels, stored as
+     * raw Vulkan texel data so each level can be copied from the mapping straight into a staging
+     * buffer. Only uncompressed RGBA8 and BC1/BC3/BC7 without supercompression are accepted.
+     */
+    struct Ktx2File
+    {
+        struct FormatInfo
+        {
+            uint32_t m_blockExtent; // Texels per block side, 1 for uncompressed
+            uint32_t m_blockBytes;
+        };
+
+        struct Level
+        {
+            const uint8_t* m_data;
+            uint64_t m_size;
+        };
+
+        Ktx2File() = default;
+
+        Ktx2File(const Ktx2File&) = delete;
+        Ktx2File& operator=(const Ktx2File&) = delete;
+
+        // Maps _filePath. Returns false if it is missing, corrupt or in an unsupported layout
+        bool open(const std::string& _filePath);
+
+        VkFormat format() const { return m_format; }
+        uint32_t width() const { return m_width; }
+        uint32_t height() const { return m_height; }
+        uint32_t levelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+        // Level 0 is the full size image. Only valid while this Ktx2File is alive
+        const Level& level(uint32_t _level) const { return m_levels[_level]; }
+
+        // Levels are given largest first, each tightly packed in rows of blocks
+        static bool write(const std::string& _filePath, VkFormat _format, uint32_t _width, uint32_t _height,
+            const std::vector<std::vector<uint8_t>>& _levels);
+
+        // False for formats this loader doesn't handle
+        static bool formatInfo(VkFormat _format, FormatInfo& _outInfo);
+        static bool isBlockCompressed(VkFormat _format);
+        static uint64_t levelSize(VkFormat _format, uint32_t _width, uint32_t _height);
+
+        // "Textures/Name.png" -> "Textures/Name.ktx2", where --compress-texture writes by default
+        static std::string pathFor(const std::string& _sourcePath);
+
+    private:
+        MappedFile m_file;
+        VkFormat m_format = VK_FORMAT_UNDEFINED;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        std::vector<Level> m_levels;
+    };
+}
@@ -0,0 +1,112 @@
+#include "LatencyLimiter.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace Engine
+{
+    namespace
+    {
+        // Weight of the newest sample in the CPU and GPU time averages
+        constexpr double SMOOTHING = 0.1;
+        // Sleep this much short of the start time and spin the rest, sleeps overshoot
+        constexpr std::chrono::microseconds SPIN_MARGIN{ 1000 };
+        // A predicted wait longer than this means the estimates are stale, e.g. after a stall
+        constexpr std::chrono::milliseconds MAX_WAIT{ 100 };
+    }
+
+    void LatencyLimiter::setEnabled(bool _enabled)
+    {
+        m_enabled = _enabled;
+
+        // Start from scratch, the last estimates may come from another scene or present mode
+        m_hasLastFrame = false;
+        m_cpuSeconds = 0.0;
+        m_gpuSeconds = 0.0;
+        m_marginSeconds = 0.0;
+        m_cpuTotal = 0.0;
+        m_gpuTotal = 0.0;
+        m_frames = 0;
+        m_gpuIdle = 0;
+    }
+
+    void LatencyLimiter::waitForNextFrame()
+    {
+        if (!m_enabled || !m_hasLastFrame)
+        {
+            m_frameStart = Clock::now();
+            return;
+        }
+
+        // Without GPU timings there is nothing to predict with, so wait for the GPU to drain instead
+        if (m_gpuSeconds <= 0.0)
+        {
+            m_device.waitForFrame(m_lastFrame);
+            m_frameStart = Clock::now();
+            return;
+        }
+
+        // Finished early, the GPU is idle already
+        Clock::time_point now = Clock::now();
+        if (m_device.isFrameComplete(m_lastFrame))
+            m_gpuIdleAt = std::min(m_gpuIdleAt, now);
+
+        const auto lead = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_cpuSeconds + m_marginSeconds));
+        const Clock::time_point start = m_gpuIdleAt - lead;
+        if (start > now && start - now < MAX_WAIT)
+        {
+            if (start - now > SPIN_MARGIN)
+                std::this_thread::sleep_until(start - SPIN_MARGIN);
+            while (Clock::now() < start)
+                std::this_thread::yield();
+        }
+
+        m_frameStart = Clock::now();
+    }
+
+    void LatencyLimiter::onSubmit(uint64_t _frame, double _gpuMs)
+    {
+        if (!m_enabled) return;
+
+        const Clock::time_point now = Clock::now();
+        const double cpuSeconds = std::chrono::duration<double>(now - m_frameStart).count();
+        const double gpuSeconds = _gpuMs / 1000.0;
+        m_cpuSeconds = m_frames == 0 ? cpuSeconds : m_cpuSeconds + (cpuSeconds - m_cpuSeconds) * SMOOTHING;
+        if (gpuSeconds > 0.0)
+            m_gpuSeconds = m_gpuSeconds <= 0.0 ? gpuSeconds : m_gpuSeconds + (gpuSeconds - m_gpuSeconds) * SMOOTHING;
+
+        // The GPU ran dry before this frame arrived, a bubble. Start a quarter GPU frame earlier from now
+        // on, and creep back one percent per frame that found it still busy
+        if (m_hasLastFrame && m_device.isFrameComplete(m_lastFrame))
+        {
+            m_marginSeconds += m_gpuSeconds * 0.25;
+            m_gpuIdle++;
+        }
+        else
+            m_marginSeconds -= m_gpuSeconds * 0.01;
+        m_marginSeconds = std::clamp(m_marginSeconds, 0.0, std::max(m_gpuSeconds, m_cpuSeconds));
+
+        // Starts once the GPU is done with what is already queued
+        m_gpuIdleAt = std::max(now, m_gpuIdleAt) + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_gpuSeconds));
+        m_lastFrame = _frame;
+        m_hasLastFrame = true;
+
+        m_cpuTotal += cpuSeconds;
+        m_gpuTotal += m_gpuSeconds;
+        m_frames++;
+    }
+
+    LatencyLimiter::Stats LatencyLimiter::stats() const
+    {
+        Stats stats;
+        if (m_frames > 0)
+        {
+            stats.m_cpuMs = m_cpuTotal * 1000.0 / m_frames;
+            stats.m_gpuMs = m_gpuTotal * 1000.0 / m_frames;
+        }
+        stats.m_marginMs = m_marginSeconds * 1000.0;
+        stats.m_frames = m_frames;
+        stats.m_gpuIdle = m_gpuIdle;
+        return stats;
+    }
+}
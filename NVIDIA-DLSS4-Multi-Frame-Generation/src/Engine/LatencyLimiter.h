@@ -0,0 +1,62 @@
+#pragma once
+#include "EngineDevice.h"
+
+#include <chrono>
+
+namespace Engine
+{
+    /*
+     * Just in time frame starts for when Reflex isn't doing it. Left alone the CPU runs as many
+     * frames ahead as the swap chain allows, and every queued frame is input latency. The limiter
+     * predicts when the GPU will go idle, from the submit times and measured GPU time of recent
+     * frames, and holds the next frame back so its input is sampled one CPU frame before that.
+     * A margin, grown whenever the GPU is found idle at a submit and slowly shrunk otherwise,
+     * absorbs CPU time variation and the part of the frame the GPU timer doesn't cover.
+     */
+    struct LatencyLimiter
+    {
+        struct Stats
+        {
+            double m_cpuMs = 0.0;    // Average frame start to submit
+            double m_gpuMs = 0.0;    // Average GPU time the prediction used
+            double m_marginMs = 0.0;
+            uint64_t m_frames = 0;
+            uint64_t m_gpuIdle = 0;  // Frames submitted after the GPU had already run dry
+        };
+
+        explicit LatencyLimiter(EngineDevice& _device) : m_device(_device) {}
+
+        LatencyLimiter(const LatencyLimiter&) = delete;
+        LatencyLimiter& operator=(const LatencyLimiter&) = delete;
+
+        bool isEnabled() const { return m_enabled; }
+        void setEnabled(bool _enabled);
+
+        // Main thread, before the frame samples input. Sleeps until the frame's predicted start
+        void waitForNextFrame();
+        // Main thread, right before _frame is submitted. _gpuMs is the latest measured GPU frame time, 0 if unknown
+        void onSubmit(uint64_t _frame, double _gpuMs);
+
+        Stats stats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        EngineDevice& m_device;
+        bool m_enabled = false;
+
+        Clock::time_point m_frameStart{};
+        Clock::time_point m_gpuIdleAt{}; // Predicted end of the GPU work submitted so far
+        uint64_t m_lastFrame = 0;
+        bool m_hasLastFrame = false;
+
+        double m_cpuSeconds = 0.0;
+        double m_gpuSeconds = 0.0;
+        double m_marginSeconds = 0.0;
+
+        double m_cpuTotal = 0.0;
+        double m_gpuTotal = 0.0;
+        uint64_t m_frames = 0;
+        uint64_t m_gpuIdle = 0;
+    };
+}
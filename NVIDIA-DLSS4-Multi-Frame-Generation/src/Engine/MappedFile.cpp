@@ -0,0 +1,117 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#  define NOMINMAX
+#  endif
+#  include <Windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace Engine
+{
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+#ifdef _WIN32
+    bool MappedFile::open(const std::string& _filePath)
+    {
+        close();
+
+        HANDLE file = CreateFileA(_filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        m_fileHandle = file;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize))
+        {
+            close();
+            return false;
+        }
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+
+        // Zero length files can't be mapped, but are still valid to open
+        if (m_size > 0)
+        {
+            m_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!m_mappingHandle)
+            {
+                close();
+                return false;
+            }
+
+            m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+            if (!m_data)
+            {
+                close();
+                return false;
+            }
+        }
+
+        m_isOpen = true;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mappingHandle) CloseHandle(m_mappingHandle);
+        if (m_fileHandle) CloseHandle(m_fileHandle);
+
+        m_data = nullptr;
+        m_mappingHandle = nullptr;
+        m_fileHandle = nullptr;
+        m_size = 0;
+        m_isOpen = false;
+    }
+#else
+    bool MappedFile::open(const std::string& _filePath)
+    {
+        close();
+
+        m_fileDescriptor = ::open(_filePath.c_str(), O_RDONLY);
+        if (m_fileDescriptor < 0) return false;
+
+        struct stat fileStat{};
+        if (fstat(m_fileDescriptor, &fileStat) != 0)
+        {
+            close();
+            return false;
+        }
+        m_size = static_cast<size_t>(fileStat.st_size);
+
+        if (m_size > 0)
+        {
+            void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0);
+            if (mapping == MAP_FAILED)
+            {
+                close();
+                return false;
+            }
+            madvise(mapping, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const uint8_t*>(mapping);
+        }
+
+        m_isOpen = true;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+        if (m_fileDescriptor >= 0) ::close(m_fileDescriptor);
+
+        m_data = nullptr;
+        m_fileDescriptor = -1;
+        m_size = 0;
+        m_isOpen = false;
+    }
+#endif
+}
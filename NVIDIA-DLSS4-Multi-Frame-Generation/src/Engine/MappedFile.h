@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Engine
+{
+    // Read-only memory mapping of a whole file. Unmapped on close or destruction
+    struct MappedFile
+    {
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Returns false if the file can't be opened or mapped
+        bool open(const std::string& _filePath);
+        void close();
+
+        bool isOpen() const { return m_isOpen; }
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        bool m_isOpen = false;
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+
+#ifdef _WIN32
+        void* m_fileHandle = nullptr;
+        void* m_mappingHandle = nullptr;
+#else
+        int m_fileDescriptor = -1;
+#endif
+    };
+}
@@ -0,0 +1,349 @@
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr uint32_t MESH_CACHE_MAGIC = 0x4853454D; // "MESH"
+
+        struct MeshCacheHeader
+        {
+            uint32_t m_magic;
+            uint32_t m_version;
+            uint32_t m_vertexStride;
+            uint32_t m_colourStride;
+
+            // Source file the cache was built from
+            uint64_t m_sourceSize;
+            int64_t m_sourceTime;
+            uint64_t m_sourceHash;
+
+            uint32_t m_vertexCount;
+            uint32_t m_colourCount;
+            uint32_t m_indexCount;
+            uint32_t m_indexStride;
+            uint32_t m_meshletCount;
+            uint32_t m_meshletStride;
+            uint32_t m_lodCount;
+            uint32_t m_lodStride;
+
+            uint64_t m_vertexOffset;
+            uint64_t m_colourOffset;
+            uint64_t m_indexOffset;
+            uint64_t m_meshletOffset;
+            uint64_t m_lodOffset;
+            uint64_t m_fileSize;
+
+            float m_boundsMin[3];
+            float m_boundsExtent[3];
+        };
+
+        struct SourceStamp
+        {
+            uint64_t m_size = 0;
+            int64_t m_time = 0;
+        };
+
+        bool statSource(const std::string& _sourcePath, SourceStamp& _outStamp)
+        {
+            std::error_code error;
+            uintmax_t size = std::filesystem::file_size(_sourcePath, error);
+            if (error) return false;
+            auto time = std::filesystem::last_write_time(_sourcePath, error);
+            if (error) return false;
+
+            _outStamp.m_size = static_cast<uint64_t>(size);
+            _outStamp.m_time = static_cast<int64_t>(time.time_since_epoch().count());
+            return true;
+        }
+
+        // FNV-1a, 64 bit
+        uint64_t hashBytes(const uint8_t* _data, size_t _size)
+        {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < _size; i++)
+            {
+                hash ^= _data[i];
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        bool hashSource(const std::string& _sourcePath, uint64_t& _outHash)
+        {
+            MappedFile source;
+            if (!source.open(_sourcePath)) return false;
+            _outHash = hashBytes(source.data(), source.size());
+            return true;
+        }
+
+        uint64_t alignUp(uint64_t _value, uint64_t _alignment)
+        {
+            return (_value + _alignment - 1) & ~(_alignment - 1);
+        }
+
+        bool blobInRange(uint64_t _offset, uint64_t _bytes, uint64_t _fileSize)
+        {
+            return _offset % MeshCache::BLOB_ALIGNMENT == 0 && _offset <= _fileSize && _bytes <= _fileSize - _offset;
+        }
+
+        template<typename IndexType>
+        bool indicesInRange(const uint8_t* _indices, uint32_t _indexCount, uint32_t _vertexCount)
+        {
+            const IndexType* indices = reinterpret_cast<const IndexType*>(_indices);
+            return std::all_of(indices, indices + _indexCount, [_vertexCount](IndexType _index) { return _index < _vertexCount; });
+        }
+
+        // The blobs go to the GPU as they are, so anything that would fetch out of bounds there is rejected
+        bool payloadValid(const MeshCacheHeader& _header, const uint8_t* _base)
+        {
+            if (_header.m_colourCount != 1 && _header.m_colourCount != _header.m_vertexCount) return false;
+
+            const uint8_t* indices = _base + _header.m_indexOffset;
+            bool valid = _header.m_indexStride == sizeof(uint16_t) ?
+                indicesInRange<uint16_t>(indices, _header.m_indexCount, _header.m_vertexCount) :
+                indicesInRange<uint32_t>(indices, _header.m_indexCount, _header.m_vertexCount);
+
+            const Model::Meshlet* meshlets = reinterpret_cast<const Model::Meshlet*>(_base + _header.m_meshletOffset);
+            valid = valid && std::all_of(meshlets, meshlets + _header.m_meshletCount, [&_header](const Model::Meshlet& _meshlet)
+                {
+                    return uint64_t(_meshlet.m_firstIndex) + _meshlet.m_indexCount <= _header.m_indexCount;
+                });
+
+            // LOD 0 is always present, it is the full mesh
+            const Model::Lod* lods = reinterpret_cast<const Model::Lod*>(_base + _header.m_lodOffset);
+            valid = valid && _header.m_lodCount >= 1 && _header.m_lodCount <= Model::MAX_LODS &&
+                std::all_of(lods, lods + _header.m_lodCount, [&_header](const Model::Lod& _lod)
+                {
+                    return uint64_t(_lod.m_firstIndex) + _lod.m_indexCount <= _header.m_indexCount;
+                });
+            return valid;
+        }
+
+        // Patches the source stamp of an existing cache, which must not be mapped
+        bool writeStamp(const std::string& _cachePath, const SourceStamp& _stamp)
+        {
+            std::fstream file(_cachePath, std::ios::binary | std::ios::in | std::ios::out);
+            if (!file) return false;
+
+            file.seekp(offsetof(MeshCacheHeader, m_sourceSize));
+            file.write(reinterpret_cast<const char*>(&_stamp.m_size), sizeof(_stamp.m_size));
+            file.seekp(offsetof(MeshCacheHeader, m_sourceTime));
+            file.write(reinterpret_cast<const char*>(&_stamp.m_time), sizeof(_stamp.m_time));
+            return static_cast<bool>(file);
+        }
+    }
+
+    bool MeshCache::open(const std::string& _sourcePath)
+    {
+        m_view = {};
+        if (!m_file.open(cachePath(_sourcePath))) return false;
+
+        const size_t fileSize = m_file.size();
+        if (fileSize < sizeof(MeshCacheHeader))
+        {
+            m_file.close();
+            return false;
+        }
+
+        MeshCacheHeader header;
+        std::memcpy(&header, m_file.data(), sizeof(header));
+
+        bool valid = header.m_magic == MESH_CACHE_MAGIC &&
+                     header.m_version == VERSION &&
+                     header.m_vertexStride == sizeof(Model::PackedVertex) &&
+                     header.m_colourStride == sizeof(Model::ColourVertex) &&
+                     (header.m_indexStride == sizeof(uint16_t) || header.m_indexStride == sizeof(uint32_t)) &&
+                     header.m_meshletStride == sizeof(Model::Meshlet) &&
+                     header.m_lodStride == sizeof(Model::Lod) &&
+                     header.m_fileSize == fileSize &&
+                     blobInRange(header.m_vertexOffset, uint64_t(header.m_vertexCount) * header.m_vertexStride, fileSize) &&
+                     blobInRange(header.m_colourOffset, uint64_t(header.m_colourCount) * header.m_colourStride, fileSize) &&
+                     blobInRange(header.m_indexOffset, uint64_t(header.m_indexCount) * header.m_indexStride, fileSize) &&
+                     blobInRange(header.m_meshletOffset, uint64_t(header.m_meshletCount) * header.m_meshletStride, fileSize) &&
+                     blobInRange(header.m_lodOffset, uint64_t(header.m_lodCount) * header.m_lodStride, fileSize);
+
+        // Cheap check first, only hash the source when its size or mtime moved.
+        // A missing source is fine, the cache can ship on its own
+        SourceStamp stamp;
+        bool restamp = false;
+        if (valid && statSource(_sourcePath, stamp) && (stamp.m_size != header.m_sourceSize || stamp.m_time != header.m_sourceTime))
+        {
+            uint64_t sourceHash = 0;
+            valid = hashSource(_sourcePath, sourceHash) && sourceHash == header.m_sourceHash;
+            restamp = valid;
+        }
+
+        valid = valid && payloadValid(header, m_file.data());
+        if (!valid)
+        {
+            m_file.close();
+            return false;
+        }
+
+        // Same content under a new stamp, e.g. after a checkout. Record it so later opens skip the hash.
+        // The mapping is read only and exclusive on Windows, so it is dropped while the header is patched
+        if (restamp)
+        {
+            m_file.close();
+            if (!writeStamp(cachePath(_sourcePath), stamp))
+                std::cerr << "Failed to update the source stamp of " << cachePath(_sourcePath) << std::endl;
+            if (!m_file.open(cachePath(_sourcePath)) || m_file.size() != fileSize)
+            {
+                m_file.close();
+                return false;
+            }
+        }
+
+        const uint8_t* base = m_file.data();
+        m_view.m_vertices = reinterpret_cast<const Model::PackedVertex*>(base + header.m_vertexOffset);
+        m_view.m_vertexCount = header.m_vertexCount;
+        m_view.m_colours = reinterpret_cast<const Model::ColourVertex*>(base + header.m_colourOffset);
+        m_view.m_colourCount = header.m_colourCount;
+        m_view.m_indices = base + header.m_indexOffset;
+        m_view.m_indexCount = header.m_indexCount;
+        m_view.m_indexSize = header.m_indexStride;
+        m_view.m_meshlets = reinterpret_cast<const Model::Meshlet*>(base + header.m_meshletOffset);
+        m_view.m_meshletCount = header.m_meshletCount;
+        m_view.m_lods = reinterpret_cast<const Model::Lod*>(base + header.m_lodOffset);
+        m_view.m_lodCount = header.m_lodCount;
+        m_view.m_boundsMin = { header.m_boundsMin[0], header.m_boundsMin[1], header.m_boundsMin[2] };
+        m_view.m_boundsExtent = { header.m_boundsExtent[0], header.m_boundsExtent[1], header.m_boundsExtent[2] };
+        return true;
+    }
+
+    bool MeshCache::write(const std::string& _sourcePath, const Model::PackedView& _mesh)
+    {
+        SourceStamp stamp;
+        uint64_t sourceHash = 0;
+        if (!statSource(_sourcePath, stamp) || !hashSource(_sourcePath, sourceHash)) return false;
+
+        MeshCacheHeader header{};
+        header.m_magic = MESH_CACHE_MAGIC;
+        header.m_version = VERSION;
+        header.m_vertexStride = sizeof(Model::PackedVertex);
+        header.m_colourStride = sizeof(Model::ColourVertex);
+        header.m_indexStride = _mesh.m_indexSize;
+        header.m_meshletStride = sizeof(Model::Meshlet);
+        header.m_lodStride = sizeof(Model::Lod);
+        header.m_sourceSize = stamp.m_size;
+        header.m_sourceTime = stamp.m_time;
+        header.m_sourceHash = sourceHash;
+        header.m_vertexCount = _mesh.m_vertexCount;
+        header.m_colourCount = _mesh.m_colourCount;
+        header.m_indexCount = _mesh.m_indexCount;
+        header.m_meshletCount = _mesh.m_meshletCount;
+        header.m_lodCount = _mesh.m_lodCount;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            header.m_boundsMin[axis] = _mesh.m_boundsMin[axis];
+            header.m_boundsExtent[axis] = _mesh.m_boundsExtent[axis];
+        }
+
+        const uint64_t vertexBytes = uint64_t(_mesh.m_vertexCount) * sizeof(Model::PackedVertex);
+        const uint64_t colourBytes = uint64_t(_mesh.m_colourCount) * sizeof(Model::ColourVertex);
+        const uint64_t indexBytes = uint64_t(_mesh.m_indexCount) * _mesh.m_indexSize;
+        const uint64_t meshletBytes = uint64_t(_mesh.m_meshletCount) * sizeof(Model::Meshlet);
+        const uint64_t lodBytes = uint64_t(_mesh.m_lodCount) * sizeof(Model::Lod);
+        header.m_vertexOffset = alignUp(sizeof(MeshCacheHeader), BLOB_ALIGNMENT);
+        header.m_colourOffset = alignUp(header.m_vertexOffset + vertexBytes, BLOB_ALIGNMENT);
+        header.m_indexOffset = alignUp(header.m_colourOffset + colourBytes, BLOB_ALIGNMENT);
+        header.m_meshletOffset = alignUp(header.m_indexOffset + indexBytes, BLOB_ALIGNMENT);
+        header.m_lodOffset = alignUp(header.m_meshletOffset + meshletBytes, BLOB_ALIGNMENT);
+        header.m_fileSize = header.m_lodOffset + lodBytes;
+
+        // Write next to the target and rename, so a half written cache is never picked up
+        const std::string finalPath = cachePath(_sourcePath);
+        const std::string tempPath = finalPath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+
+            auto writeBlob = [&file](uint64_t _offset, const void* _data, uint64_t _bytes)
+            {
+                static const char padding[BLOB_ALIGNMENT] = {};
+                uint64_t position = static_cast<uint64_t>(file.tellp());
+                file.write(padding, static_cast<std::streamsize>(_offset - position));
+                file.write(static_cast<const char*>(_data), static_cast<std::streamsize>(_bytes));
+            };
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            writeBlob(header.m_vertexOffset, _mesh.m_vertices, vertexBytes);
+            writeBlob(header.m_colourOffset, _mesh.m_colours, colourBytes);
+            writeBlob(header.m_indexOffset, _mesh.m_indices, indexBytes);
+            writeBlob(header.m_meshletOffset, _mesh.m_meshlets, meshletBytes);
+            writeBlob(header.m_lodOffset, _mesh.m_lods, lodBytes);
+            if (!file) return false;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, finalPath, error);
+        if (error)
+        {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+
+    Model::PackedView MeshCache::openOrBuild(const std::string& _sourcePath, Model::PackedData& _outPacked, uint32_t _threadCount)
+    {
+        if (open(_sourcePath))
+            return m_view;
+
+        Model::Data data;
+        data.loadModel(_sourcePath, _threadCount);
+        MeshOptimizer::optimize(data);
+        MeshOptimizer::buildLods(data);
+
+        _outPacked.pack(data);
+        if (!write(_sourcePath, _outPacked.view()))
+            std::cerr << "Failed to write mesh cache for " << _sourcePath << std::endl;
+
+        return _outPacked.view();
+    }
+
+    bool MeshCache::bake(const std::string& _sourcePath)
+    {
+        try
+        {
+            Model::Data data;
+            data.loadModel(_sourcePath);
+            MeshOptimizer::Report report = MeshOptimizer::optimize(data);
+            MeshOptimizer::buildLods(data);
+
+            Model::PackedData packed;
+            packed.pack(data);
+            if (!write(_sourcePath, packed.view()))
+            {
+                std::cerr << "Failed to write " << cachePath(_sourcePath) << std::endl;
+                return false;
+            }
+
+            std::error_code error;
+            const Model::PackedView view = packed.view();
+            std::cout << _sourcePath << ": " << view.m_vertexCount << " vertices, " << view.m_indexCount << " x " << view.m_indexSize * 8 << " bit indices, "
+                      << view.m_meshletCount << " meshlets -> "
+                      << std::filesystem::file_size(cachePath(_sourcePath), error) / 1024 << " KB" << std::endl;
+            std::printf("  ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%.1f ms)\n", report.m_before.m_acmr, report.m_after.m_acmr,
+                report.m_before.m_atvr, report.m_after.m_atvr, report.m_milliseconds);
+            for (uint32_t lod = 0; lod < view.m_lodCount; lod++)
+                std::printf("  LOD %u: %u triangles, error %g\n", lod, view.m_lods[lod].m_indexCount / 3, view.m_lods[lod].m_error);
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << _sourcePath << ": " << e.what() << std::endl;
+            return false;
+        }
+    }
+}
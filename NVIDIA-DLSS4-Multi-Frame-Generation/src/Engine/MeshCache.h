@@ -0,0 +1,49 @@
+#pragma once
+#include "ModelHandler.h"
+#include "MappedFile.h"
+
+#include <string>
+
+namespace Engine
+{
+    /*
+     * Binary cache of a packed mesh, stored next to the source as "<source>.mesh".
+     * The file is a fixed header followed by the vertex, colour, index, meshlet and LOD blobs, each
+     * aligned so it can be copied from the mapping straight into a staging buffer.
+     * A cache is used when the source size and mtime match, or failing that its hash.
+     */
+    struct MeshCache
+    {
+        // Bump when the header, any packed vertex format or the mesh processing changes
+        static constexpr uint32_t VERSION = 4;
+        static constexpr uint64_t BLOB_ALIGNMENT = 256;
+
+        MeshCache() = default;
+
+        MeshCache(const MeshCache&) = delete;
+        MeshCache& operator=(const MeshCache&) = delete;
+
+        // Maps the cache for _sourcePath. Returns false if it is missing, stale or corrupt
+        bool open(const std::string& _sourcePath);
+
+        // Only valid while this MeshCache is alive
+        const Model::PackedView& view() const { return m_view; }
+
+        static bool write(const std::string& _sourcePath, const Model::PackedView& _mesh);
+
+        // Maps the cache for _sourcePath, or failing that loads and processes the source into
+        // _outPacked and writes a fresh cache. Returns the view to upload from, which lives as long
+        // as both this MeshCache and _outPacked. Throws if the source can't be loaded. _threadCount is passed on
+        // to the OBJ parser
+        Model::PackedView openOrBuild(const std::string& _sourcePath, Model::PackedData& _outPacked, uint32_t _threadCount = 0);
+
+        // Offline conversion, used by --bake-meshes
+        static bool bake(const std::string& _sourcePath);
+
+        static std::string cachePath(const std::string& _sourcePath) { return _sourcePath + ".mesh"; }
+
+    private:
+        MappedFile m_file;
+        Model::PackedView m_view{};
+    };
+}
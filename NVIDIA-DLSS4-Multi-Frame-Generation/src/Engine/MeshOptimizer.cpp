@@ -0,0 +1,648 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace Engine
+{
+    namespace
+    {
+        // FIFO cache tracked with insertion timestamps: a vertex is cached while fewer than
+        // _cacheSize vertices have been inserted after it. Returns true on a miss
+        bool touchVertex(std::vector<uint32_t>& _cacheTime, uint32_t& _timestamp, uint32_t _vertex, uint32_t _cacheSize)
+        {
+            if (_timestamp - _cacheTime[_vertex] <= _cacheSize) return false;
+            _cacheTime[_vertex] = _timestamp++;
+            return true;
+        }
+
+        // Triangles using each vertex, as offsets into one shared list
+        struct Adjacency
+        {
+            std::vector<uint32_t> m_offsets;
+            std::vector<uint32_t> m_triangles;
+
+            Adjacency(const std::vector<uint32_t>& _indices, size_t _vertexCount)
+                : m_offsets(_vertexCount + 1, 0), m_triangles(_indices.size())
+            {
+                for (uint32_t index : _indices)
+                    m_offsets[index + 1]++;
+                std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+
+                std::vector<uint32_t> cursor(m_offsets.begin(), m_offsets.end() - 1);
+                for (size_t i = 0; i < _indices.size(); i++)
+                    m_triangles[cursor[_indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        };
+
+        // Sum of weighted squared distances to a set of planes, as a symmetric 4x4 matrix
+        struct Quadric
+        {
+            double m_a00 = 0.0, m_a01 = 0.0, m_a02 = 0.0, m_a11 = 0.0, m_a12 = 0.0, m_a22 = 0.0;
+            double m_b0 = 0.0, m_b1 = 0.0, m_b2 = 0.0;
+            double m_c = 0.0;
+            double m_weight = 0.0;
+
+            void addPlane(const glm::dvec3& _normal, double _distance, double _weight)
+            {
+                m_a00 += _weight * _normal.x * _normal.x;
+                m_a01 += _weight * _normal.x * _normal.y;
+                m_a02 += _weight * _normal.x * _normal.z;
+                m_a11 += _weight * _normal.y * _normal.y;
+                m_a12 += _weight * _normal.y * _normal.z;
+                m_a22 += _weight * _normal.z * _normal.z;
+                m_b0 += _weight * _distance * _normal.x;
+                m_b1 += _weight * _distance * _normal.y;
+                m_b2 += _weight * _distance * _normal.z;
+                m_c += _weight * _distance * _distance;
+                m_weight += _weight;
+            }
+
+            void add(const Quadric& _other)
+            {
+                m_a00 += _other.m_a00; m_a01 += _other.m_a01; m_a02 += _other.m_a02;
+                m_a11 += _other.m_a11; m_a12 += _other.m_a12; m_a22 += _other.m_a22;
+                m_b0 += _other.m_b0; m_b1 += _other.m_b1; m_b2 += _other.m_b2;
+                m_c += _other.m_c;
+                m_weight += _other.m_weight;
+            }
+
+            // Mean squared distance from _point to the planes
+            double evaluate(const glm::vec3& _point) const
+            {
+                const double x = _point.x, y = _point.y, z = _point.z;
+                double error = m_a00 * x * x + m_a11 * y * y + m_a22 * z * z
+                    + 2.0 * (m_a01 * x * y + m_a02 * x * z + m_a12 * y * z)
+                    + 2.0 * (m_b0 * x + m_b1 * y + m_b2 * z) + m_c;
+                return m_weight > 0.0 ? std::max(error, 0.0) / m_weight : 0.0;
+            }
+        };
+
+        Model::Meshlet computeMeshletBounds(const Model::Data& _data, uint32_t _firstTriangle, uint32_t _endTriangle)
+        {
+            Model::Meshlet meshlet;
+            meshlet.m_firstIndex = _firstTriangle * 3;
+            meshlet.m_indexCount = (_endTriangle - _firstTriangle) * 3;
+
+            // Sphere around the box centre, looser than a minimal sphere but cheap and stable
+            glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+            glm::vec3 boundsMax{ std::numeric_limits<float>::lowest() };
+            for (uint32_t i = meshlet.m_firstIndex; i < meshlet.m_firstIndex + meshlet.m_indexCount; i++)
+            {
+                boundsMin = glm::min(boundsMin, _data.m_vertices[_data.m_indices[i]].m_position);
+                boundsMax = glm::max(boundsMax, _data.m_vertices[_data.m_indices[i]].m_position);
+            }
+            const glm::vec3 centre = (boundsMin + boundsMax) * 0.5f;
+            float radius = 0.0f;
+            for (uint32_t i = meshlet.m_firstIndex; i < meshlet.m_firstIndex + meshlet.m_indexCount; i++)
+                radius = std::max(radius, glm::length(_data.m_vertices[_data.m_indices[i]].m_position - centre));
+            meshlet.m_sphere = glm::vec4(centre, radius);
+
+            // Normal cone: the meshlet is backfacing from everywhere the cone test passes when
+            // every triangle normal is within acos(minDot) of the axis
+            glm::vec3 axis{ 0.0f };
+            for (uint32_t t = _firstTriangle; t < _endTriangle; t++)
+            {
+                const glm::vec3& p0 = _data.m_vertices[_data.m_indices[t * 3 + 0]].m_position;
+                const glm::vec3& p1 = _data.m_vertices[_data.m_indices[t * 3 + 1]].m_position;
+                const glm::vec3& p2 = _data.m_vertices[_data.m_indices[t * 3 + 2]].m_position;
+                glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                float length = glm::length(normal);
+                if (length > 0.0f) axis += normal / length;
+            }
+            float axisLength = glm::length(axis);
+            if (axisLength <= 0.0f) return meshlet;
+            axis /= axisLength;
+
+            float minDot = 1.0f;
+            for (uint32_t t = _firstTriangle; t < _endTriangle; t++)
+            {
+                const glm::vec3& p0 = _data.m_vertices[_data.m_indices[t * 3 + 0]].m_position;
+                const glm::vec3& p1 = _data.m_vertices[_data.m_indices[t * 3 + 1]].m_position;
+                const glm::vec3& p2 = _data.m_vertices[_data.m_indices[t * 3 + 2]].m_position;
+                glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                float length = glm::length(normal);
+                if (length > 0.0f) minDot = std::min(minDot, glm::dot(normal / length, axis));
+            }
+
+            // Spread close to a hemisphere or wider, the cone can never be entirely backfacing
+            const float cutoff = minDot <= 0.1f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+            meshlet.m_cone = glm::vec4(axis, cutoff);
+            return meshlet;
+        }
+    }
+
+    namespace MeshOptimizer
+    {
+        CacheStats analyzeVertexCache(const std::vector<uint32_t>& _indices, size_t _vertexCount, uint32_t _cacheSize)
+        {
+            CacheStats stats;
+            if (_indices.empty()) return stats;
+
+            std::vector<uint32_t> cacheTime(_vertexCount, 0);
+            std::vector<uint8_t> referenced(_vertexCount, 0);
+            uint32_t timestamp = _cacheSize + 1;
+            size_t misses = 0;
+            size_t uniqueVertices = 0;
+
+            for (uint32_t index : _indices)
+            {
+                misses += touchVertex(cacheTime, timestamp, index, _cacheSize) ? 1 : 0;
+                uniqueVertices += referenced[index] ? 0 : 1;
+                referenced[index] = 1;
+            }
+
+            stats.m_acmr = static_cast<float>(misses) / static_cast<float>(_indices.size() / 3);
+            stats.m_atvr = static_cast<float>(misses) / static_cast<float>(std::max<size_t>(uniqueVertices, 1));
+            return stats;
+        }
+
+        // Tipsify, Sander et al. 2007: fan around a vertex, then move to whichever neighbour
+        // will still be in the cache after its remaining triangles are emitted
+        std::vector<uint32_t> optimizeVertexCache(std::vector<uint32_t>& _indices, size_t _vertexCount, uint32_t _cacheSize)
+        {
+            std::vector<uint32_t> clusters;
+            const size_t triangleCount = _indices.size() / 3;
+            if (triangleCount == 0 || _vertexCount == 0) return clusters;
+
+            Adjacency adjacency(_indices, _vertexCount);
+
+            std::vector<uint32_t> liveTriangles(_vertexCount);
+            for (size_t v = 0; v < _vertexCount; v++)
+                liveTriangles[v] = adjacency.m_offsets[v + 1] - adjacency.m_offsets[v];
+
+            std::vector<uint32_t> cacheTime(_vertexCount, 0);
+            std::vector<uint8_t> emitted(triangleCount, 0);
+            std::vector<uint32_t> deadEnd;
+            std::vector<uint32_t> candidates;
+            std::vector<uint32_t> output;
+            output.reserve(_indices.size());
+
+            uint32_t timestamp = _cacheSize + 1;
+            uint32_t inputCursor = 0;
+
+            // Picks up where the last fan left off when its neighbourhood is exhausted
+            auto skipDeadEnd = [&]() -> int64_t
+            {
+                while (!deadEnd.empty())
+                {
+                    uint32_t vertex = deadEnd.back();
+                    deadEnd.pop_back();
+                    if (liveTriangles[vertex] > 0) return vertex;
+                }
+                while (inputCursor < _vertexCount)
+                {
+                    if (liveTriangles[inputCursor] > 0) return inputCursor;
+                    inputCursor++;
+                }
+                return -1;
+            };
+
+            int64_t fanVertex = skipDeadEnd();
+            clusters.push_back(0);
+
+            while (fanVertex >= 0)
+            {
+                candidates.clear();
+                for (uint32_t a = adjacency.m_offsets[fanVertex]; a < adjacency.m_offsets[fanVertex + 1]; a++)
+                {
+                    uint32_t triangle = adjacency.m_triangles[a];
+                    if (emitted[triangle]) continue;
+
+                    for (int k = 0; k < 3; k++)
+                    {
+                        uint32_t vertex = _indices[triangle * 3 + k];
+                        output.push_back(vertex);
+                        deadEnd.push_back(vertex);
+                        candidates.push_back(vertex);
+                        liveTriangles[vertex]--;
+                        touchVertex(cacheTime, timestamp, vertex, _cacheSize);
+                    }
+                    emitted[triangle] = 1;
+                }
+
+                // Best candidate is the oldest one that stays cached through its own fan
+                int64_t next = -1;
+                int64_t bestPriority = -1;
+                for (uint32_t vertex : candidates)
+                {
+                    if (liveTriangles[vertex] == 0) continue;
+
+                    int64_t priority = 0;
+                    if (int64_t(timestamp - cacheTime[vertex]) + 2 * int64_t(liveTriangles[vertex]) <= int64_t(_cacheSize))
+                        priority = timestamp - cacheTime[vertex];
+                    if (priority > bestPriority)
+                    {
+                        bestPriority = priority;
+                        next = vertex;
+                    }
+                }
+
+                if (next < 0)
+                {
+                    next = skipDeadEnd();
+                    // Hard boundary, the cache is effectively cold from here
+                    if (next >= 0 && output.size() / 3 < triangleCount)
+                        clusters.push_back(static_cast<uint32_t>(output.size() / 3));
+                }
+                fanVertex = next;
+            }
+
+            _indices.swap(output);
+            return clusters;
+        }
+
+        void optimizeOverdraw(std::vector<uint32_t>& _indices, const std::vector<Model::Vertex>& _vertices,
+            const std::vector<uint32_t>& _clusters, float _threshold, uint32_t _cacheSize)
+        {
+            const uint32_t triangleCount = static_cast<uint32_t>(_indices.size() / 3);
+            if (triangleCount == 0 || _clusters.empty()) return;
+
+            // Soft boundaries: cut a hard cluster wherever the prefix so far is already within
+            // _threshold of the whole cluster's ACMR, so sorting costs little cache efficiency
+            std::vector<uint32_t> cacheTime(_vertices.size(), 0);
+            uint32_t timestamp = _cacheSize + 1;
+            auto triangleMisses = [&](uint32_t _triangle)
+            {
+                uint32_t misses = 0;
+                for (int k = 0; k < 3; k++)
+                    misses += touchVertex(cacheTime, timestamp, _indices[_triangle * 3 + k], _cacheSize) ? 1 : 0;
+                return misses;
+            };
+
+            std::vector<uint32_t> clusters;
+            for (size_t c = 0; c < _clusters.size(); c++)
+            {
+                const uint32_t start = _clusters[c];
+                const uint32_t end = c + 1 < _clusters.size() ? _clusters[c + 1] : triangleCount;
+                if (start >= end) continue;
+
+                timestamp += _cacheSize + 1;
+                uint32_t clusterMisses = 0;
+                for (uint32_t t = start; t < end; t++)
+                    clusterMisses += triangleMisses(t);
+                const float clusterThreshold = _threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+                clusters.push_back(start);
+                timestamp += _cacheSize + 1;
+                uint32_t misses = 0;
+                uint32_t size = 0;
+                for (uint32_t t = start; t < end; t++)
+                {
+                    misses += triangleMisses(t);
+                    size++;
+                    if (static_cast<float>(misses) <= clusterThreshold * static_cast<float>(size) && t + 1 < end)
+                    {
+                        clusters.push_back(t + 1);
+                        timestamp += _cacheSize + 1;
+                        misses = 0;
+                        size = 0;
+                    }
+                }
+            }
+
+            // Area weighted centroid and average normal of each cluster
+            struct ClusterInfo
+            {
+                glm::vec3 m_centroid{ 0.0f };
+                glm::vec3 m_normal{ 0.0f };
+                float m_area = 0.0f;
+                float m_sortKey = 0.0f;
+            };
+            std::vector<ClusterInfo> infos(clusters.size());
+            glm::vec3 meshCentroid{ 0.0f };
+            float meshArea = 0.0f;
+
+            for (size_t c = 0; c < clusters.size(); c++)
+            {
+                const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+                ClusterInfo& info = infos[c];
+                for (uint32_t t = clusters[c]; t < end; t++)
+                {
+                    const glm::vec3& p0 = _vertices[_indices[t * 3 + 0]].m_position;
+                    const glm::vec3& p1 = _vertices[_indices[t * 3 + 1]].m_position;
+                    const glm::vec3& p2 = _vertices[_indices[t * 3 + 2]].m_position;
+                    glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                    float area = glm::length(normal);
+
+                    info.m_centroid += (p0 + p1 + p2) * (area / 3.0f);
+                    info.m_normal += normal;
+                    info.m_area += area;
+                }
+
+                meshCentroid += info.m_centroid;
+                meshArea += info.m_area;
+                if (info.m_area > 0.0f) info.m_centroid /= info.m_area;
+                float normalLength = glm::length(info.m_normal);
+                if (normalLength > 0.0f) info.m_normal /= normalLength;
+            }
+            if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+            for (ClusterInfo& info : infos)
+                info.m_sortKey = glm::dot(info.m_centroid - meshCentroid, info.m_normal);
+
+            std::vector<uint32_t> order(clusters.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::stable_sort(order.begin(), order.end(), [&infos](uint32_t _a, uint32_t _b) { return infos[_a].m_sortKey > infos[_b].m_sortKey; });
+
+            std::vector<uint32_t> output;
+            output.reserve(_indices.size());
+            for (uint32_t c : order)
+            {
+                const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+                output.insert(output.end(), _indices.begin() + size_t(clusters[c]) * 3, _indices.begin() + size_t(end) * 3);
+            }
+            _indices.swap(output);
+        }
+
+        void optimizeVertexFetch(Model::Data& _data)
+        {
+            std::vector<uint32_t> remap(_data.m_vertices.size(), UINT32_MAX);
+            std::vector<Model::Vertex> vertices;
+            vertices.reserve(_data.m_vertices.size());
+
+            for (uint32_t& index : _data.m_indices)
+            {
+                if (remap[index] == UINT32_MAX)
+                {
+                    remap[index] = static_cast<uint32_t>(vertices.size());
+                    vertices.push_back(_data.m_vertices[index]);
+                }
+                index = remap[index];
+            }
+            _data.m_vertices.swap(vertices);
+        }
+
+        Report optimize(Model::Data& _data)
+        {
+            Report report;
+            if (_data.m_indices.empty() || _data.m_indices.size() % 3 != 0) return report;
+
+            report.m_before = analyzeVertexCache(_data.m_indices, _data.m_vertices.size());
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<uint32_t> clusters = optimizeVertexCache(_data.m_indices, _data.m_vertices.size());
+            optimizeOverdraw(_data.m_indices, _data.m_vertices, clusters);
+            optimizeVertexFetch(_data);
+            report.m_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+            report.m_after = analyzeVertexCache(_data.m_indices, _data.m_vertices.size());
+            return report;
+        }
+
+        std::vector<uint32_t> simplify(const std::vector<uint32_t>& _indices, const std::vector<Model::Vertex>& _vertices,
+            size_t _targetIndexCount, float _maxError, float& _outError)
+        {
+            _outError = 0.0f;
+            std::vector<uint32_t> indices = _indices;
+            const size_t vertexCount = _vertices.size();
+            if (indices.size() <= _targetIndexCount || vertexCount == 0) return indices;
+
+            auto positionOf = [&_vertices](uint32_t _vertex) -> const glm::vec3& { return _vertices[_vertex].m_position; };
+
+            // Vertices split by a uv or normal seam share a position. Collapses and borders work on
+            // the first vertex at each position so the seam is seen as one piece of geometry
+            std::vector<uint32_t> position(vertexCount);
+            {
+                std::vector<uint32_t> order(vertexCount);
+                std::iota(order.begin(), order.end(), 0u);
+                auto less = [&](uint32_t _a, uint32_t _b)
+                {
+                    const glm::vec3& a = positionOf(_a);
+                    const glm::vec3& b = positionOf(_b);
+                    return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+                };
+                std::sort(order.begin(), order.end(), less);
+                for (size_t i = 0; i < vertexCount; i++)
+                    position[order[i]] = i > 0 && positionOf(order[i]) == positionOf(order[i - 1]) ? position[order[i - 1]] : order[i];
+            }
+
+            // Lock seams, open borders and non-manifold edges, moving any of them would open cracks
+            std::vector<uint8_t> locked(vertexCount, 0);
+            {
+                std::vector<uint32_t> sharing(vertexCount, 0);
+                for (size_t v = 0; v < vertexCount; v++)
+                    sharing[position[v]]++;
+                for (size_t v = 0; v < vertexCount; v++)
+                    locked[v] = sharing[v] > 1 ? 1 : 0;
+
+                std::unordered_map<uint64_t, uint32_t> edges;
+                edges.reserve(indices.size());
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        uint32_t a = position[indices[i + k]];
+                        uint32_t b = position[indices[i + (k + 1) % 3]];
+                        if (a == b) continue;
+                        edges[(uint64_t(std::min(a, b)) << 32) | std::max(a, b)]++;
+                    }
+                }
+                for (const auto& [edge, count] : edges)
+                {
+                    if (count == 2) continue;
+                    locked[edge >> 32] = 1;
+                    locked[edge & 0xFFFFFFFFu] = 1;
+                }
+            }
+
+            std::vector<Quadric> quadrics(vertexCount);
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const glm::dvec3 p0 = positionOf(indices[i + 0]);
+                const glm::dvec3 p1 = positionOf(indices[i + 1]);
+                const glm::dvec3 p2 = positionOf(indices[i + 2]);
+                glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+                double length = glm::length(normal);
+                if (length <= 0.0) continue;
+                normal /= length;
+
+                for (int k = 0; k < 3; k++)
+                    quadrics[position[indices[i + k]]].addPlane(normal, -glm::dot(normal, p0), length * 0.5);
+            }
+
+            const double maxErrorSquared = double(_maxError) * double(_maxError);
+            std::vector<uint32_t> bestTarget(vertexCount);
+            std::vector<double> bestCost(vertexCount);
+            std::vector<uint32_t> candidates;
+            std::vector<uint32_t> remap(vertexCount);
+            std::vector<uint8_t> touched(vertexCount);
+
+            while (indices.size() > _targetIndexCount)
+            {
+                // Cheapest neighbour for each free vertex to collapse onto
+                std::fill(bestTarget.begin(), bestTarget.end(), UINT32_MAX);
+                std::fill(bestCost.begin(), bestCost.end(), std::numeric_limits<double>::max());
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        const uint32_t from = indices[i + k];
+                        if (locked[position[from]]) continue;
+
+                        for (int j = 1; j < 3; j++)
+                        {
+                            const uint32_t to = indices[i + (k + j) % 3];
+                            if (position[to] == position[from]) continue;
+
+                            Quadric quadric = quadrics[position[from]];
+                            quadric.add(quadrics[position[to]]);
+                            const double cost = quadric.evaluate(positionOf(to));
+                            if (cost < bestCost[from])
+                            {
+                                bestCost[from] = cost;
+                                bestTarget[from] = to;
+                            }
+                        }
+                    }
+                }
+
+                candidates.clear();
+                for (uint32_t v = 0; v < vertexCount; v++)
+                    if (bestTarget[v] != UINT32_MAX && bestCost[v] <= maxErrorSquared)
+                        candidates.push_back(v);
+                if (candidates.empty()) break;
+                std::sort(candidates.begin(), candidates.end(), [&bestCost](uint32_t _a, uint32_t _b) { return bestCost[_a] < bestCost[_b]; });
+
+                // Each collapse removes about two triangles. Collapses in a pass must not share
+                // triangles, so the flip test below still sees the real neighbourhood
+                Adjacency adjacency(indices, vertexCount);
+                const size_t collapseLimit = (indices.size() - _targetIndexCount) / 6 + 1;
+                size_t collapses = 0;
+                std::iota(remap.begin(), remap.end(), 0u);
+                std::fill(touched.begin(), touched.end(), uint8_t(0));
+
+                for (uint32_t from : candidates)
+                {
+                    if (collapses >= collapseLimit) break;
+                    const uint32_t to = bestTarget[from];
+                    if (touched[position[from]] || touched[position[to]]) continue;
+
+                    // Reject collapses that flip or sharply fold a surviving triangle
+                    bool flips = false;
+                    for (uint32_t a = adjacency.m_offsets[from]; a < adjacency.m_offsets[from + 1] && !flips; a++)
+                    {
+                        const uint32_t* corners = &indices[size_t(adjacency.m_triangles[a]) * 3];
+                        if (position[corners[0]] == position[to] || position[corners[1]] == position[to] || position[corners[2]] == position[to])
+                            continue; // Removed by the collapse
+
+                        glm::vec3 before[3];
+                        glm::vec3 after[3];
+                        for (int k = 0; k < 3; k++)
+                        {
+                            before[k] = positionOf(corners[k]);
+                            after[k] = corners[k] == from ? positionOf(to) : before[k];
+                        }
+                        const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                        const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                        flips = glm::dot(normalBefore, normalAfter) <= 0.25f * glm::length(normalBefore) * glm::length(normalAfter);
+                    }
+                    if (flips) continue;
+
+                    remap[from] = to;
+                    for (uint32_t a = adjacency.m_offsets[from]; a < adjacency.m_offsets[from + 1]; a++)
+                        for (int k = 0; k < 3; k++)
+                            touched[position[indices[size_t(adjacency.m_triangles[a]) * 3 + k]]] = 1;
+                    quadrics[position[to]].add(quadrics[position[from]]);
+                    _outError = std::max(_outError, static_cast<float>(std::sqrt(bestCost[from])));
+                    collapses++;
+                }
+                if (collapses == 0) break;
+
+                // Drop the triangles that collapsed to a line
+                size_t write = 0;
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    const uint32_t a = remap[indices[i + 0]];
+                    const uint32_t b = remap[indices[i + 1]];
+                    const uint32_t c = remap[indices[i + 2]];
+                    if (position[a] == position[b] || position[b] == position[c] || position[a] == position[c]) continue;
+                    indices[write++] = a;
+                    indices[write++] = b;
+                    indices[write++] = c;
+                }
+                indices.resize(write);
+            }
+            return indices;
+        }
+
+        void buildLods(Model::Data& _data, uint32_t _maxLods)
+        {
+            const uint32_t baseCount = static_cast<uint32_t>(_data.m_indices.size());
+            _data.m_lods.assign(1, Model::Lod{ 0, baseCount, 0.0f });
+            if (baseCount == 0 || _data.m_vertices.empty()) return;
+
+            glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+            glm::vec3 boundsMax{ std::numeric_limits<float>::lowest() };
+            for (const Model::Vertex& vertex : _data.m_vertices)
+            {
+                boundsMin = glm::min(boundsMin, vertex.m_position);
+                boundsMax = glm::max(boundsMax, vertex.m_position);
+            }
+            const float maxError = glm::length(boundsMax - boundsMin) * 0.5f * MAX_LOD_ERROR;
+
+            // Every level is simplified from LOD 0, so its error is measured against the real mesh
+            const std::vector<uint32_t> base(_data.m_indices.begin(), _data.m_indices.end());
+            size_t previousCount = baseCount;
+            for (uint32_t level = 1; level < _maxLods; level++)
+            {
+                const size_t target = (previousCount / 3 / 2) * 3;
+                float error = 0.0f;
+                std::vector<uint32_t> lod = simplify(base, _data.m_vertices, target, maxError, error);
+
+                // Locked seams or the error cap stopped it early, a level this close to the last isn't worth it
+                if (lod.empty() || lod.size() * 4 > previousCount * 3) break;
+
+                optimizeVertexCache(lod, _data.m_vertices.size());
+                _data.m_lods.push_back(Model::Lod{ static_cast<uint32_t>(_data.m_indices.size()), static_cast<uint32_t>(lod.size()),
+                    std::max(error, _data.m_lods.back().m_error) });
+                _data.m_indices.insert(_data.m_indices.end(), lod.begin(), lod.end());
+                previousCount = lod.size();
+            }
+        }
+
+        std::vector<Model::Meshlet> buildMeshlets(const Model::Data& _data, uint32_t _maxVertices, uint32_t _maxTriangles)
+        {
+            std::vector<Model::Meshlet> meshlets;
+            const size_t lodIndexCount = _data.m_lods.empty() ? _data.m_indices.size() : _data.m_lods[0].m_indexCount;
+            const uint32_t triangleCount = static_cast<uint32_t>(lodIndexCount / 3);
+            if (triangleCount == 0 || _maxVertices < 3 || _maxTriangles == 0) return meshlets;
+
+            // Id of the last meshlet each vertex was counted in, so membership resets for free
+            std::vector<uint32_t> lastMeshlet(_data.m_vertices.size(), UINT32_MAX);
+            uint32_t meshletId = 0;
+            uint32_t firstTriangle = 0;
+            uint32_t vertexCount = 0;
+
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                const uint32_t a = _data.m_indices[t * 3 + 0];
+                const uint32_t b = _data.m_indices[t * 3 + 1];
+                const uint32_t c = _data.m_indices[t * 3 + 2];
+                auto newVertices = [&]()
+                {
+                    return uint32_t(lastMeshlet[a] != meshletId) +
+                           uint32_t(lastMeshlet[b] != meshletId && b != a) +
+                           uint32_t(lastMeshlet[c] != meshletId && c != a && c != b);
+                };
+
+                if (t > firstTriangle && (vertexCount + newVertices() > _maxVertices || t - firstTriangle >= _maxTriangles))
+                {
+                    meshlets.push_back(computeMeshletBounds(_data, firstTriangle, t));
+                    meshletId++;
+                    firstTriangle = t;
+                    vertexCount = 0;
+                }
+
+                vertexCount += newVertices();
+                lastMeshlet[a] = lastMeshlet[b] = lastMeshlet[c] = meshletId;
+            }
+            meshlets.push_back(computeMeshletBounds(_data, firstTriangle, triangleCount));
+            return meshlets;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "ModelHandler.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    /*
+     * Post-load index and vertex reordering, run on Model::Data before it is packed and cached.
+     * Vertex cache order (Tipsify), then overdraw (clusters sorted to draw outward facing
+     * geometry first), then vertex fetch (vertices renumbered in first use order).
+     */
+    namespace MeshOptimizer
+    {
+        // Post-transform cache size assumed by both the optimiser and the analysis
+        constexpr uint32_t CACHE_SIZE = 16;
+
+        struct CacheStats
+        {
+            float m_acmr = 0.0f; // Transformed vertices per triangle, 0.5 at best, 3 at worst
+            float m_atvr = 0.0f; // Transformed vertices per referenced vertex, 1 at best
+        };
+
+        struct Report
+        {
+            CacheStats m_before;
+            CacheStats m_after;
+            double m_milliseconds = 0.0;
+        };
+
+        // FIFO cache simulation
+        CacheStats analyzeVertexCache(const std::vector<uint32_t>& _indices, size_t _vertexCount, uint32_t _cacheSize = CACHE_SIZE);
+
+        // Reorders triangles in place. Returns the first triangle of each cluster, for optimizeOverdraw
+        std::vector<uint32_t> optimizeVertexCache(std::vector<uint32_t>& _indices, size_t _vertexCount, uint32_t _cacheSize = CACHE_SIZE);
+
+        // Splits the cache clusters where their ACMR stays within _threshold, then sorts them
+        // so the ones facing away from the mesh centre draw first
+        void optimizeOverdraw(std::vector<uint32_t>& _indices, const std::vector<Model::Vertex>& _vertices,
+            const std::vector<uint32_t>& _clusters, float _threshold = 1.05f, uint32_t _cacheSize = CACHE_SIZE);
+
+        // Renumbers vertices in the order the indices first reference them, dropping unused ones
+        void optimizeVertexFetch(Model::Data& _data);
+
+        // All three passes
+        Report optimize(Model::Data& _data);
+
+        // LODs stop once the simplification error passes this fraction of the mesh radius
+        constexpr float MAX_LOD_ERROR = 0.1f;
+
+        // Quadric error metric edge collapse (Garland and Heckbert 1997) towards _targetIndexCount.
+        // Vertices collapse onto a neighbour, so attributes are never interpolated, and vertices on
+        // attribute seams or open borders are locked. Collapses costing more than _maxError are skipped.
+        // _outError is the largest collapse error, as an area weighted RMS distance in model units
+        std::vector<uint32_t> simplify(const std::vector<uint32_t>& _indices, const std::vector<Model::Vertex>& _vertices,
+            size_t _targetIndexCount, float _maxError, float& _outError);
+
+        // Appends up to _maxLods - 1 simplified levels to _data.m_indices, each targeting half the
+        // triangles of the one before, and fills _data.m_lods. Run after optimize
+        void buildLods(Model::Data& _data, uint32_t _maxLods = Model::MAX_LODS);
+
+        // Splits LOD 0 of the index buffer, in its current order, into contiguous meshlets with bounding
+        // spheres and normal cones. Run after optimize so each meshlet is a compact patch
+        std::vector<Model::Meshlet> buildMeshlets(const Model::Data& _data,
+            uint32_t _maxVertices = Model::Meshlet::MAX_VERTICES, uint32_t _maxTriangles = Model::Meshlet::MAX_TRIANGLES);
+    }
+}
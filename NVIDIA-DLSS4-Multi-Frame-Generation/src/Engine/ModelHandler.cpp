@@ -1,156 +1,298 @@
 #include "ModelHandler.h"
-#include "Utils.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include "VertexDedupe.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tinyobjectloader/tiny_obj_loader.h>
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
-#include <unordered_map>
-
-// Turns single Vertex into a hash at size_t in order to use it in unordered_map
-namespace std
-{
-    template<>struct 
-    hash<Engine::Model::Vertex>
-    {
-        size_t operator()(Engine::Model::Vertex const& _vertex) const
-        {
-            size_t seed = 0;
-            Engine::hashCombine(seed, _vertex.m_position, _vertex.m_colour, _vertex.m_normal, _vertex.m_uv);
-            return seed;
-        }
-    };
-}
+#include <iostream>
+#include <limits>
 
 namespace Engine
 {
+    static_assert(sizeof(Model::PackedVertex) == 16, "PackedVertex should stay 16 bytes");
+    static_assert(sizeof(Model::Meshlet) == 48, "Meshlet must match the std430 layout in MeshletCull.comp");
+
     Model::Model(EngineDevice& _device, const Model::Data& _data)
         : m_device(_device)
     {
-        createVertexBuffers(_data.m_vertices);
-        createIndexBuffer(_data.m_indices);
+        PackedData packed;
+        packed.pack(_data);
+        createVertexBuffers(packed.view());
+        createIndexBuffer(packed.view());
+        createMeshletBuffer(packed.view());
+    }
+
+    Model::Model(EngineDevice& _device, const PackedView& _mesh)
+        : m_device(_device)
+    {
+        createVertexBuffers(_mesh);
+        createIndexBuffer(_mesh);
+        createMeshletBuffer(_mesh);
     }
 
     Model::~Model(){}
 
-    void Model::createVertexBuffers(const std::vector<Vertex>& _vertices)
+    namespace
     {
-        m_vertexCount = static_cast<uint32_t>(_vertices.size());
-        assert(m_vertexCount >= 3 && "Vertex count must be at least 3");
+        // Octahedral normal encoding, decoded by decodeOctahedral() in the vertex shaders
+        SNorm16x2 encodeOctahedral(glm::vec3 _normal)
+        {
+            float l1 = std::abs(_normal.x) + std::abs(_normal.y) + std::abs(_normal.z);
+            if (l1 < 1e-12f) return SNorm16x2{ { 0, 0 } }; // Missing normal, decodes to +Z
 
-        VkDeviceSize bufferSize = sizeof(_vertices[0]) * m_vertexCount;
-        uint32_t vertexSize = sizeof(_vertices[0]);
+            glm::vec2 p = glm::vec2(_normal) / l1;
+            if (_normal.z < 0.0f)
+            {
+                glm::vec2 sign{ p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f };
+                p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) * sign;
+            }
+            return SNorm16x2{ { static_cast<int16_t>(glm::packSnorm1x16(p.x)), static_cast<int16_t>(glm::packSnorm1x16(p.y)) } };
+        }
 
-        Buffer stagingBuffer{
-            m_device,
-            vertexSize,
-            m_vertexCount,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-        };
+        UNorm8x4 packColour(const glm::vec3& _colour)
+        {
+            uint32_t packed = glm::packUnorm4x8(glm::vec4(_colour, 1.0f));
+            UNorm8x4 result;
+            std::memcpy(result.m_value, &packed, sizeof(packed));
+            return result;
+        }
+    }
 
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*)_vertices.data());
+    void Model::PackedData::pack(const Data& _data)
+    {
+        const std::vector<Vertex>& vertices = _data.m_vertices;
+        size_t vertexCount = vertices.size();
 
-        m_vertexBuffer = std::make_unique<Buffer>(
-            m_device,
-            vertexSize,
-            m_vertexCount,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
+        // Quantise positions to 16 bits inside the mesh bounds
+        glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+        glm::vec3 boundsMax{ std::numeric_limits<float>::lowest() };
+        for (const Vertex& vertex : vertices)
+        {
+            boundsMin = glm::min(boundsMin, vertex.m_position);
+            boundsMax = glm::max(boundsMax, vertex.m_position);
+        }
+        glm::vec3 extent = boundsMax - boundsMin;
+        for (int axis = 0; axis < 3; axis++)
+            if (extent[axis] <= 0.0f) extent[axis] = 1.0f; // Flat along this axis
+        m_boundsMin = vertexCount > 0 ? boundsMin : glm::vec3{ 0.0f };
+        m_boundsExtent = extent;
+
+        m_vertices.resize(vertexCount);
+        m_colours.resize(vertexCount);
+        bool uniformColour = true;
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const Vertex& vertex = vertices[i];
+            glm::vec3 normalised = (vertex.m_position - boundsMin) / extent;
+            uint64_t position = glm::packUnorm4x16(glm::vec4(normalised, 0.0f));
+            std::memcpy(m_vertices[i].m_position.m_value, &position, sizeof(position));
+
+            m_vertices[i].m_normal = encodeOctahedral(vertex.m_normal);
+            m_vertices[i].m_uv = Half2{ { glm::packHalf1x16(vertex.m_uv.x), glm::packHalf1x16(vertex.m_uv.y) } };
+
+            m_colours[i].m_colour = packColour(vertex.m_colour);
+            uniformColour = uniformColour && std::memcmp(&m_colours[i], &m_colours[0], sizeof(ColourVertex)) == 0;
+        }
 
-        m_device.copyBuffer(stagingBuffer.getBuffer(), m_vertexBuffer->getBuffer(), bufferSize);
+        // Most OBJ files carry no vertex colour, so don't store one per vertex
+        if (uniformColour && vertexCount > 0)
+            m_colours.resize(1);
+
+        // Half the index bandwidth and cache footprint for meshes under 64k vertices
+        m_indices16.clear();
+        m_indices32.clear();
+        if (vertexCount <= std::numeric_limits<uint16_t>::max())
+            m_indices16.assign(_data.m_indices.begin(), _data.m_indices.end());
+        else
+            m_indices32 = _data.m_indices;
+
+        m_lods = _data.m_lods;
+        if (m_lods.empty())
+            m_lods.push_back(Lod{ 0, static_cast<uint32_t>(_data.m_indices.size()), 0.0f });
+
+        m_meshlets = MeshOptimizer::buildMeshlets(_data);
     }
 
-    void Model::createIndexBuffer(const std::vector<uint32_t>& _indices)
+    Model::PackedView Model::PackedData::view() const
     {
-        m_indexCount = static_cast<uint32_t>(_indices.size());
+        PackedView view;
+        view.m_vertices = m_vertices.data();
+        view.m_vertexCount = static_cast<uint32_t>(m_vertices.size());
+        view.m_colours = m_colours.data();
+        view.m_colourCount = static_cast<uint32_t>(m_colours.size());
+        if (!m_indices16.empty())
+        {
+            view.m_indices = m_indices16.data();
+            view.m_indexCount = static_cast<uint32_t>(m_indices16.size());
+            view.m_indexSize = sizeof(uint16_t);
+        }
+        else
+        {
+            view.m_indices = m_indices32.data();
+            view.m_indexCount = static_cast<uint32_t>(m_indices32.size());
+            view.m_indexSize = sizeof(uint32_t);
+        }
+        view.m_meshlets = m_meshlets.data();
+        view.m_meshletCount = static_cast<uint32_t>(m_meshlets.size());
+        view.m_lods = m_lods.data();
+        view.m_lodCount = static_cast<uint32_t>(m_lods.size());
+        view.m_boundsMin = m_boundsMin;
+        view.m_boundsExtent = m_boundsExtent;
+        return view;
+    }
+
+    void Model::createVertexBuffers(const PackedView& _mesh)
+    {
+        m_vertexCount = _mesh.m_vertexCount;
+        assert(m_vertexCount >= 3 && "Vertex count must be at least 3");
+        assert((_mesh.m_colourCount == 1 || _mesh.m_colourCount == m_vertexCount) && "Colour stream must be uniform or per vertex");
+
+        m_dequantize = glm::scale(glm::translate(glm::mat4{ 1.0f }, _mesh.m_boundsMin), _mesh.m_boundsExtent);
+        m_boundingSphere = glm::vec4(_mesh.m_boundsMin + _mesh.m_boundsExtent * 0.5f, glm::length(_mesh.m_boundsExtent) * 0.5f);
+
+        m_vertexBuffer = createDeviceLocalBuffer(_mesh.m_vertices, sizeof(PackedVertex), m_vertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+
+        m_colourStride = _mesh.m_colourCount == 1 ? 0 : sizeof(ColourVertex);
+        m_colourBuffer = createDeviceLocalBuffer(_mesh.m_colours, sizeof(ColourVertex), _mesh.m_colourCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    }
+
+    void Model::createIndexBuffer(const PackedView& _mesh)
+    {
+        m_indexCount = _mesh.m_indexCount;
         hasIndexBuffer = m_indexCount > 0;
         if (!hasIndexBuffer) return; // No index buffer to create
 
-        VkDeviceSize bufferSize = sizeof(_indices[0]) * m_indexCount;
-        uint32_t indexSize = sizeof(_indices[0]);
+        m_indexType = _mesh.indexType();
+        m_lods.assign(_mesh.m_lods, _mesh.m_lods + _mesh.m_lodCount);
+        if (m_lods.empty())
+            m_lods.push_back(Lod{ 0, m_indexCount, 0.0f });
 
+        const VkBufferUsageFlags usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+        // The culling shader reads 16 bit indices in pairs, so an odd count gets a padding index
+        if (m_indexType == VK_INDEX_TYPE_UINT16 && m_indexCount % 2 != 0)
+        {
+            std::vector<uint16_t> padded(m_indexCount + 1, 0);
+            std::memcpy(padded.data(), _mesh.m_indices, size_t(m_indexCount) * sizeof(uint16_t));
+            m_indexBuffer = createDeviceLocalBuffer(padded.data(), sizeof(uint16_t), m_indexCount + 1, usage);
+            return;
+        }
+        m_indexBuffer = createDeviceLocalBuffer(_mesh.m_indices, _mesh.m_indexSize, m_indexCount, usage);
+    }
+
+    void Model::createMeshletBuffer(const PackedView& _mesh)
+    {
+        m_meshletCount = hasIndexBuffer ? _mesh.m_meshletCount : 0;
+        if (m_meshletCount == 0) return;
+
+        m_meshletBuffer = createDeviceLocalBuffer(_mesh.m_meshlets, sizeof(Meshlet), m_meshletCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    }
+
+    std::unique_ptr<Buffer> Model::createDeviceLocalBuffer(const void* _data, uint32_t _elementSize, uint32_t _count, VkBufferUsageFlags _usage)
+    {
         Buffer stagingBuffer{
             m_device,
-            indexSize,
-            m_indexCount,
+            _elementSize,
+            _count,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            1,
+            ResourceTag::Staging
         };
 
         stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*)_indices.data());
+        stagingBuffer.writeToBuffer(const_cast<void*>(_data));
 
-        m_indexBuffer = std::make_unique<Buffer>(
+        auto buffer = std::make_unique<Buffer>(
             m_device,
-            indexSize,
-            m_indexCount,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+            _elementSize,
+            _count,
+            _usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            1,
+            ResourceTag::Model
         );
 
-        m_device.copyBuffer(stagingBuffer.getBuffer(), m_indexBuffer->getBuffer(), bufferSize);
+        m_device.copyBuffer(stagingBuffer.getBuffer(), buffer->getBuffer(), static_cast<VkDeviceSize>(_elementSize) * _count);
+        return buffer;
     }
 
-    void Model::draw(VkCommandBuffer _commandBuffer)
+    void Model::draw(VkCommandBuffer _commandBuffer, uint32_t _lod)
     {
         if (hasIndexBuffer)
-            vkCmdDrawIndexed(_commandBuffer, m_indexCount, 1, 0, 0, 0);
+        {
+            const Lod& lod = m_lods[std::min<size_t>(_lod, m_lods.size() - 1)];
+            vkCmdDrawIndexed(_commandBuffer, lod.m_indexCount, 1, lod.m_firstIndex, 0, 0);
+        }
         else
             vkCmdDraw(_commandBuffer, m_vertexCount, 1, 0, 0);
     }
 
-    std::unique_ptr<Model> Model::createModelFromFile(EngineDevice& _device, const std::string& _filePath)
+    uint32_t Model::getTriangleCount(uint32_t _lod) const
     {
-        Data data;
-        data.loadModel(_filePath);
-        return std::make_unique<Model>(_device, data);
+        if (!hasIndexBuffer) return m_vertexCount / 3;
+        return m_lods[std::min<size_t>(_lod, m_lods.size() - 1)].m_indexCount / 3;
     }
 
-    void Model::bind(VkCommandBuffer _commandBuffer)
+    uint32_t Model::selectLod(const Lod* _lods, uint32_t _lodCount, float _distance, float _errorScale)
     {
-        VkBuffer buffers[] = { m_vertexBuffer->getBuffer()};
-        VkDeviceSize offsets[] = { 0 };
-        vkCmdBindVertexBuffers(_commandBuffer, 0, 1, buffers, offsets);
+        // Errors grow with each level, so walk down from the coarsest
+        for (uint32_t lod = _lodCount; lod-- > 1;)
+            if (_lods[lod].m_error * _errorScale <= _distance) return lod;
+        return 0;
+    }
 
-        if (hasIndexBuffer)
-            vkCmdBindIndexBuffer(_commandBuffer, m_indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+    std::unique_ptr<Model> Model::createModelFromFile(EngineDevice& _device, const std::string& _filePath)
+    {
+        // Upload straight out of the mapped cache when it matches the source file
+        MeshCache cache;
+        PackedData packed;
+        return std::make_unique<Model>(_device, cache.openOrBuild(_filePath, packed));
     }
 
-    std::vector<VkVertexInputBindingDescription> Model::Vertex::getBindingDescriptions()
+    VkDeviceSize Model::getMemorySize() const
     {
-        std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+        VkDeviceSize size = 0;
+        for (const std::unique_ptr<Buffer>* buffer : { &m_vertexBuffer, &m_colourBuffer, &m_indexBuffer, &m_meshletBuffer })
+        {
+            if (*buffer)
+                size += (*buffer)->getBufferSize();
+        }
+        return size;
+    }
 
-        bindingDescriptions[0].binding = 0; // Binding index
-        bindingDescriptions[0].stride = sizeof(Vertex); // Size of each vertex
-        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // Each vertex has its own data
+    void Model::bind(VkCommandBuffer _commandBuffer)
+    {
+        bindVertexBuffers(_commandBuffer);
 
-        return bindingDescriptions;
+        if (hasIndexBuffer)
+            vkCmdBindIndexBuffer(_commandBuffer, m_indexBuffer->getBuffer(), 0, m_indexType);
     }
 
-    std::vector<VkVertexInputAttributeDescription> Model::Vertex::getAttributeDescriptions()
+    void Model::bindVertexBuffers(VkCommandBuffer _commandBuffer)
     {
-        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
-
-        // Position attribute
-        attributeDescriptions.push_back({0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, m_position)});
-        // Colour attribute
-        attributeDescriptions.push_back({1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, m_colour)});
-        // Normal attribute
-        attributeDescriptions.push_back({2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, m_normal)});
-        // UV attribute
-        attributeDescriptions.push_back({3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, m_uv)});
+        // Stride is dynamic pipeline state so a uniform colour can be a single element with stride 0
+        VkBuffer buffers[] = { m_vertexBuffer->getBuffer(), m_colourBuffer->getBuffer() };
+        VkDeviceSize offsets[] = { 0, 0 };
+        VkDeviceSize strides[] = { sizeof(PackedVertex), m_colourStride };
+        vkCmdBindVertexBuffers2(_commandBuffer, 0, 2, buffers, offsets, nullptr, strides);
+    }
 
-        return attributeDescriptions;
+    void Model::Data::loadModel(const std::string& _filePath, uint32_t _threadCount)
+    {
+        ObjParser::load(_filePath, *this, _threadCount);
     }
 
-    void Model::Data::loadModel(const std::string& _filePath)
+    void Model::Data::loadModelTinyObj(const std::string& _filePath)
     {
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
@@ -163,7 +305,12 @@ namespace Engine
         m_vertices.clear();
         m_indices.clear();
 
-        std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+        size_t indexCount = 0;
+        for (const auto& shape : shapes)
+            indexCount += shape.mesh.indices.size();
+        m_indices.reserve(indexCount);
+
+        VertexDedupe uniqueVertices(m_vertices, indexCount);
         for (const auto& shape : shapes)
         {
             for (const auto& index : shape.mesh.indices)
@@ -202,14 +349,8 @@ namespace Engine
                     };
                 }
 
-                // If new Vertex add it to the uniqueVertices map
-                if (uniqueVertices.count(vertex) == 0)
-                {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(m_vertices.size());
-                    m_vertices.push_back(vertex);
-                }
-
-                m_indices.push_back(uniqueVertices[vertex]);
+                // Adds the vertex if it's new
+                m_indices.push_back(uniqueVertices.insert(vertex));
             }
         }
     }
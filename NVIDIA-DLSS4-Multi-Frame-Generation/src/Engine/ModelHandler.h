@@ -1,6 +1,7 @@
 #pragma once
 #include "EngineDevice.h"
 #include "Buffer.h"
+#include "VertexLayout.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -10,6 +11,7 @@ namespace Engine
 {
     struct Model 
     {
+        // Full precision vertex, used while loading and processing meshes on the CPU
         struct Vertex
         {
             glm::vec3 m_position{};
@@ -17,9 +19,6 @@ namespace Engine
             glm::vec3 m_normal{};
             glm::vec2 m_uv{};
 
-            static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
-            static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
-
             bool operator==(const Vertex& other) const
             {
                 return m_position == other.m_position &&
@@ -28,15 +27,113 @@ namespace Engine
                        m_uv == other.m_uv;
             }
         };
+
+        // GPU vertex, 16 bytes. Position is quantised to the mesh bounds (see getDequantizeMatrix),
+        // the normal is octahedral encoded and the uv is half float
+        struct PackedVertex
+        {
+            UNorm16x4 m_position;
+            SNorm16x2 m_normal;
+            Half2 m_uv;
+
+            static constexpr auto attributes()
+            {
+                return std::array{
+                    VERTEX_ATTRIBUTE(0, PackedVertex, m_position),
+                    VERTEX_ATTRIBUTE(2, PackedVertex, m_normal),
+                    VERTEX_ATTRIBUTE(3, PackedVertex, m_uv)
+                };
+            }
+        };
+
+        // Optional colour stream. Meshes with a single colour bind one element with a stride of 0
+        struct ColourVertex
+        {
+            UNorm8x4 m_colour;
+
+            static constexpr auto attributes()
+            {
+                return std::array{ VERTEX_ATTRIBUTE(1, ColourVertex, m_colour) };
+            }
+        };
+
+        using Layout = VertexLayout<VertexStream<PackedVertex, 0>, VertexStream<ColourVertex, 1>>;
+
+        static constexpr uint32_t MAX_LODS = 4;
+
+        // One detail level, a range of the shared index buffer. LOD 0 is the full mesh
+        struct Lod
+        {
+            uint32_t m_firstIndex = 0;
+            uint32_t m_indexCount = 0;
+            float m_error = 0.0f; // Simplification error in model units
+        };
+
+        // Contiguous run of the index buffer with the bounds to cull it by, read by Shaders/MeshletCull.comp.
+        // Bounds are in model space, not the quantised space of PackedVertex
+        struct Meshlet
+        {
+            static constexpr uint32_t MAX_VERTICES = 64;
+            static constexpr uint32_t MAX_TRIANGLES = 124;
+
+            glm::vec4 m_sphere{ 0.0f }; // Centre, radius in w
+            glm::vec4 m_cone{ 0.0f, 0.0f, 1.0f, 1.0f }; // Average normal, cutoff in w. A cutoff of 1 never culls
+            uint32_t m_firstIndex = 0;
+            uint32_t m_indexCount = 0;
+            uint32_t m_padding[2] = {};
+        };
+
         struct Data
         {
             std::vector<Vertex> m_vertices{};
             std::vector<uint32_t> m_indices{};
+            // Filled by MeshOptimizer::buildLods, empty when m_indices is a single level
+            std::vector<Lod> m_lods{};
+
+            // Engine OBJ parser, see ObjParser. _threadCount of 0 uses every hardware thread, pass 1 from a thread pool
+            void loadModel(const std::string& _filePath, uint32_t _threadCount = 0);
+            // tinyobjloader, kept as the reference the engine parser is checked against
+            void loadModelTinyObj(const std::string& _filePath);
+        };
+
+        // GPU ready mesh, either packed from Data or pointing straight into a mapped mesh cache file
+        struct PackedView
+        {
+            const PackedVertex* m_vertices = nullptr;
+            uint32_t m_vertexCount = 0;
+            const ColourVertex* m_colours = nullptr;
+            uint32_t m_colourCount = 0; // 1 when the whole mesh shares a colour
+            const void* m_indices = nullptr;
+            uint32_t m_indexCount = 0;
+            uint32_t m_indexSize = sizeof(uint32_t); // 2 when every vertex is addressable with 16 bits
+            const Meshlet* m_meshlets = nullptr;
+            uint32_t m_meshletCount = 0;
+            const Lod* m_lods = nullptr;
+            uint32_t m_lodCount = 0;
+            glm::vec3 m_boundsMin{ 0.0f };
+            glm::vec3 m_boundsExtent{ 1.0f };
+
+            VkIndexType indexType() const { return m_indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32; }
+        };
+
+        struct PackedData
+        {
+            std::vector<PackedVertex> m_vertices{};
+            std::vector<ColourVertex> m_colours{};
+            // Only one is filled, 16 bit whenever the vertex count allows
+            std::vector<uint16_t> m_indices16{};
+            std::vector<uint32_t> m_indices32{};
+            std::vector<Meshlet> m_meshlets{};
+            std::vector<Lod> m_lods{};
+            glm::vec3 m_boundsMin{ 0.0f };
+            glm::vec3 m_boundsExtent{ 1.0f };
 
-            void loadModel(const std::string& _filePath);
+            void pack(const Data& _data);
+            PackedView view() const;
         };
 
         Model(EngineDevice& _device, const Model::Data& _data);
+        Model(EngineDevice& _device, const PackedView& _mesh);
         ~Model();
 
         Model(const Model&) = delete;
@@ -45,19 +142,54 @@ namespace Engine
         static std::unique_ptr<Model> createModelFromFile(EngineDevice& _device, const std::string& _filePath);
 
         void bind(VkCommandBuffer _commandBuffer);
-        void draw(VkCommandBuffer _commandBuffer);
+        void bindVertexBuffers(VkCommandBuffer _commandBuffer);
+        void draw(VkCommandBuffer _commandBuffer, uint32_t _lod = 0);
+
+        // Maps the quantised [0, 1] positions back to model space, apply before the model matrix
+        const glm::mat4& getDequantizeMatrix() const { return m_dequantize; }
+
+        // Device memory held by the vertex, index and meshlet buffers
+        VkDeviceSize getMemorySize() const;
+
+        uint32_t getLodCount() const { return static_cast<uint32_t>(m_lods.size()); }
+        uint32_t getTriangleCount(uint32_t _lod = 0) const;
+        // Model space bounds, centre and radius in w
+        const glm::vec4& getBoundingSphere() const { return m_boundingSphere; }
+        // Coarsest LOD whose error, scaled by _errorScale, is within _distance. See FrameInfo::selectLod
+        uint32_t selectLod(float _distance, float _errorScale) const { return selectLod(m_lods.data(), getLodCount(), _distance, _errorScale); }
+        static uint32_t selectLod(const Lod* _lods, uint32_t _lodCount, float _distance, float _errorScale);
+
+        // Read by MeshletCullingSystem, the index buffer doubles as a storage buffer
+        bool hasMeshlets() const { return hasIndexBuffer && m_meshletCount > 0; }
+        uint32_t getMeshletCount() const { return m_meshletCount; }
+        Buffer& getMeshletBuffer() { return *m_meshletBuffer; }
+        Buffer& getIndexBuffer() { return *m_indexBuffer; }
+        uint32_t getIndexCount() const { return m_indexCount; }
+        VkIndexType getIndexType() const { return m_indexType; }
 
     private:
-        void createVertexBuffers(const std::vector<Vertex>& _vertices);
-        void createIndexBuffer(const std::vector<uint32_t>& _indices);
+        void createVertexBuffers(const PackedView& _mesh);
+        void createIndexBuffer(const PackedView& _mesh);
+        void createMeshletBuffer(const PackedView& _mesh);
+        std::unique_ptr<Buffer> createDeviceLocalBuffer(const void* _data, uint32_t _elementSize, uint32_t _count, VkBufferUsageFlags _usage);
 
         EngineDevice& m_device;
 
         std::unique_ptr<Buffer> m_vertexBuffer;
         uint32_t m_vertexCount;
+        glm::mat4 m_dequantize{ 1.0f };
+        glm::vec4 m_boundingSphere{ 0.0f };
+
+        std::unique_ptr<Buffer> m_colourBuffer;
+        VkDeviceSize m_colourStride = 0;
 
         bool hasIndexBuffer = false;
         std::unique_ptr<Buffer> m_indexBuffer;
         uint32_t m_indexCount;
+        VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
+        std::vector<Lod> m_lods;
+
+        std::unique_ptr<Buffer> m_meshletBuffer;
+        uint32_t m_meshletCount = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,578 @@
+#include "ObjParser.h"
+#include "MappedFile.h"
+#include "VertexDedupe.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace Engine
+{
+    namespace
+    {
+        using Clock = std::chrono::high_resolution_clock;
+
+        constexpr size_t MIN_CHUNK_BYTES = 256 * 1024;
+
+        constexpr uint8_t RELATIVE_POSITION = 1 << 0;
+        constexpr uint8_t RELATIVE_TEXCOORD = 1 << 1;
+        constexpr uint8_t RELATIVE_NORMAL = 1 << 2;
+
+        // Face corner as written in the file. Negative (relative) indices are resolved against the
+        // chunk's own counts and flagged, the chunk's global offset is added once every chunk is parsed
+        struct RawCorner
+        {
+            int32_t m_position = -1;
+            int32_t m_texcoord = -1; // -1 when missing
+            int32_t m_normal = -1;   // -1 when missing
+            uint8_t m_relative = 0;
+        };
+
+        // Zero based global indices
+        struct Corner
+        {
+            int32_t m_position;
+            int32_t m_texcoord;
+            int32_t m_normal;
+        };
+
+        struct Chunk
+        {
+            const char* m_begin = nullptr;
+            const char* m_end = nullptr;
+
+            std::vector<float> m_positions; // xyz
+            std::vector<float> m_colours;   // rgb, one per position
+            std::vector<float> m_normals;   // xyz
+            std::vector<float> m_texcoords; // uv
+            std::vector<RawCorner> m_corners;
+            std::vector<uint32_t> m_faceSizes;
+
+            size_t m_lineCount = 0;
+            size_t m_errorLine = 0; // Line within the chunk of the first bad face, 0 if none
+
+            // Build pass
+            size_t m_positionBase = 0;
+            size_t m_texcoordBase = 0;
+            size_t m_normalBase = 0;
+            std::vector<Corner> m_triangles;
+            std::vector<Corner> m_scratch;
+        };
+
+        template<typename Function>
+        void parallelFor(size_t _count, Function&& _function)
+        {
+            std::vector<std::thread> threads;
+            threads.reserve(_count > 0 ? _count - 1 : 0);
+            for (size_t i = 1; i < _count; i++)
+                threads.emplace_back([&_function, i]() { _function(i); });
+            if (_count > 0) _function(0);
+            for (std::thread& thread : threads)
+                thread.join();
+        }
+
+        bool isBlank(char _c) { return _c == ' ' || _c == '\t'; }
+        bool isDigit(char _c) { return _c >= '0' && _c <= '9'; }
+
+        const char* skipBlanks(const char* _cursor, const char* _end)
+        {
+            while (_cursor < _end && isBlank(*_cursor)) _cursor++;
+            return _cursor;
+        }
+
+        // tinyobj parseReal: one blank separated token, false (output untouched) if it doesn't start with a number
+        bool tryParseReal(const char*& _cursor, const char* _end, float& _out)
+        {
+            const char* begin = skipBlanks(_cursor, _end);
+            const char* end = begin;
+            while (end < _end && !isBlank(*end)) end++;
+            _cursor = end;
+
+            // from_chars takes no leading '+', and must not accept "inf" or "nan" which tinyobj rejects
+            const char* number = (begin < end && *begin == '+') ? begin + 1 : begin;
+            const char* first = (number < end && *number == '-' && number == begin) ? number + 1 : number;
+            if (first >= end || !(isDigit(*first) || *first == '.')) return false;
+
+            // Parse as double then round, like tinyobj
+            double value = 0.0;
+            auto result = std::from_chars(number, end, value);
+            if (result.ec != std::errc()) return false;
+
+            _out = static_cast<float>(value);
+            return true;
+        }
+
+        float parseReal(const char*& _cursor, const char* _end, float _default)
+        {
+            float value = _default;
+            tryParseReal(_cursor, _end, value);
+            return value;
+        }
+
+        // atoi: optional sign then digits, 0 if there are none
+        int parseInt(const char* _cursor, const char* _end)
+        {
+            _cursor = skipBlanks(_cursor, _end);
+            bool negative = false;
+            if (_cursor < _end && (*_cursor == '+' || *_cursor == '-'))
+            {
+                negative = *_cursor == '-';
+                _cursor++;
+            }
+
+            int64_t value = 0;
+            while (_cursor < _end && isDigit(*_cursor) && value <= std::numeric_limits<int32_t>::max())
+                value = value * 10 + (*_cursor++ - '0');
+            value = std::min<int64_t>(value, std::numeric_limits<int32_t>::max());
+            return static_cast<int>(negative ? -value : value);
+        }
+
+        const char* skipIndex(const char* _cursor, const char* _end)
+        {
+            while (_cursor < _end && *_cursor != '/' && !isBlank(*_cursor)) _cursor++;
+            return _cursor;
+        }
+
+        // tinyobj fixIndex. Relative indices stay chunk local until the build pass
+        bool fixIndex(int _index, size_t _count, bool _allowZero, int32_t& _out, uint8_t& _relative, uint8_t _relativeBit)
+        {
+            if (_index > 0)
+            {
+                _out = _index - 1;
+                return true;
+            }
+            if (_index == 0)
+            {
+                _out = -1;
+                return _allowZero;
+            }
+
+            _out = static_cast<int32_t>(static_cast<int64_t>(_count) + _index);
+            _relative |= _relativeBit;
+            return true;
+        }
+
+        // i, i/j, i//k or i/j/k
+        bool parseTriple(const char*& _cursor, const char* _end, const Chunk& _chunk, RawCorner& _corner)
+        {
+            const size_t positionCount = _chunk.m_positions.size() / 3;
+            const size_t texcoordCount = _chunk.m_texcoords.size() / 2;
+            const size_t normalCount = _chunk.m_normals.size() / 3;
+
+            if (!fixIndex(parseInt(_cursor, _end), positionCount, false, _corner.m_position, _corner.m_relative, RELATIVE_POSITION))
+                return false;
+            _cursor = skipIndex(_cursor, _end);
+            if (_cursor >= _end || *_cursor != '/') return true;
+            _cursor++;
+
+            if (_cursor < _end && *_cursor == '/')
+            {
+                _cursor++;
+                if (!fixIndex(parseInt(_cursor, _end), normalCount, true, _corner.m_normal, _corner.m_relative, RELATIVE_NORMAL))
+                    return false;
+                _cursor = skipIndex(_cursor, _end);
+                return true;
+            }
+
+            if (!fixIndex(parseInt(_cursor, _end), texcoordCount, true, _corner.m_texcoord, _corner.m_relative, RELATIVE_TEXCOORD))
+                return false;
+            _cursor = skipIndex(_cursor, _end);
+            if (_cursor >= _end || *_cursor != '/') return true;
+            _cursor++;
+
+            if (!fixIndex(parseInt(_cursor, _end), normalCount, true, _corner.m_normal, _corner.m_relative, RELATIVE_NORMAL))
+                return false;
+            _cursor = skipIndex(_cursor, _end);
+            return true;
+        }
+
+        void parseChunk(Chunk& _chunk)
+        {
+            const char* cursor = _chunk.m_begin;
+            const char* const chunkEnd = _chunk.m_end;
+
+            while (cursor < chunkEnd)
+            {
+                // Lines end in \n, \r\n or a lone \r
+                const char* lineEnd = cursor;
+                while (lineEnd < chunkEnd && *lineEnd != '\n' && *lineEnd != '\r') lineEnd++;
+                const char* p = skipBlanks(cursor, lineEnd);
+
+                cursor = lineEnd;
+                if (cursor < chunkEnd && *cursor == '\r') cursor++;
+                if (cursor < chunkEnd && *cursor == '\n') cursor++;
+                _chunk.m_lineCount++;
+
+                if (p >= lineEnd || *p == '#') continue;
+                const size_t length = static_cast<size_t>(lineEnd - p);
+
+                if (p[0] == 'v' && length > 1 && isBlank(p[1]))
+                {
+                    p += 2;
+                    float x = parseReal(p, lineEnd, 0.0f);
+                    float y = parseReal(p, lineEnd, 0.0f);
+                    float z = parseReal(p, lineEnd, 0.0f);
+
+                    // x y z [r g b]. A lone 4th value is w, which tinyobj keeps as the red channel
+                    float r = 1.0f, g = 1.0f, b = 1.0f;
+                    if (tryParseReal(p, lineEnd, r))
+                    {
+                        if (tryParseReal(p, lineEnd, g))
+                        {
+                            if (!tryParseReal(p, lineEnd, b))
+                                r = g = b = 1.0f;
+                        }
+                        else
+                        {
+                            g = b = 1.0f;
+                        }
+                    }
+
+                    _chunk.m_positions.insert(_chunk.m_positions.end(), { x, y, z });
+                    _chunk.m_colours.insert(_chunk.m_colours.end(), { r, g, b });
+                }
+                else if (p[0] == 'v' && length > 2 && p[1] == 'n' && isBlank(p[2]))
+                {
+                    p += 3;
+                    float x = parseReal(p, lineEnd, 0.0f);
+                    float y = parseReal(p, lineEnd, 0.0f);
+                    float z = parseReal(p, lineEnd, 0.0f);
+                    _chunk.m_normals.insert(_chunk.m_normals.end(), { x, y, z });
+                }
+                else if (p[0] == 'v' && length > 2 && p[1] == 't' && isBlank(p[2]))
+                {
+                    p += 3;
+                    float u = parseReal(p, lineEnd, 0.0f);
+                    float v = parseReal(p, lineEnd, 0.0f);
+                    _chunk.m_texcoords.insert(_chunk.m_texcoords.end(), { u, v });
+                }
+                else if (p[0] == 'f' && length > 1 && isBlank(p[1]))
+                {
+                    p = skipBlanks(p + 2, lineEnd);
+
+                    uint32_t faceSize = 0;
+                    while (p < lineEnd && *p != '#' && *p != '\0')
+                    {
+                        RawCorner corner;
+                        if (!parseTriple(p, lineEnd, _chunk, corner))
+                        {
+                            _chunk.m_errorLine = _chunk.m_lineCount;
+                            return;
+                        }
+                        _chunk.m_corners.push_back(corner);
+                        faceSize++;
+                        p = skipBlanks(p, lineEnd);
+                    }
+                    _chunk.m_faceSizes.push_back(faceSize);
+                }
+                // Everything else (groups, materials, smoothing, lines, points) doesn't affect the mesh
+            }
+        }
+
+        // Splits the file at line starts, roughly evenly
+        std::vector<Chunk> splitChunks(const char* _data, size_t _size, uint32_t _threadCount)
+        {
+            size_t chunkCount = std::max<size_t>(1, std::min<size_t>(_threadCount, _size / MIN_CHUNK_BYTES));
+            std::vector<Chunk> chunks;
+            chunks.reserve(chunkCount);
+
+            const char* end = _data + _size;
+            const char* begin = _data;
+            for (size_t i = 1; i <= chunkCount && begin < end; i++)
+            {
+                const char* split = (i == chunkCount) ? end : _data + (_size * i) / chunkCount;
+                split = std::max(split, begin);
+                while (split < end && *split != '\n') split++;
+                if (split < end) split++; // Start the next chunk after the newline
+
+                Chunk& chunk = chunks.emplace_back();
+                chunk.m_begin = begin;
+                chunk.m_end = split;
+                begin = split;
+            }
+            return chunks;
+        }
+
+        template<typename T>
+        int pnpoly(int _count, const T* _x, const T* _y, T _testX, T _testY)
+        {
+            int inside = 0;
+            for (int i = 0, j = _count - 1; i < _count; j = i++)
+            {
+                if (((_y[i] > _testY) != (_y[j] > _testY)) &&
+                    (_testX < (_x[j] - _x[i]) * (_testY - _y[i]) / (_y[j] - _y[i]) + _x[i]))
+                    inside = !inside;
+            }
+            return inside;
+        }
+
+        // Port of tinyobj's built in ear clipping, including its choice of projection axes
+        void triangulatePolygon(const Corner* _face, size_t _count, const float* _positions, std::vector<Corner>& _remaining, std::vector<Corner>& _out)
+        {
+            auto position = [_positions](const Corner& _corner, size_t _axis) { return _positions[size_t(_corner.m_position) * 3 + _axis]; };
+
+            size_t axes[2] = { 1, 2 };
+            for (size_t k = 0; k < _count; k++)
+            {
+                const Corner& c0 = _face[(k + 0) % _count];
+                const Corner& c1 = _face[(k + 1) % _count];
+                const Corner& c2 = _face[(k + 2) % _count];
+                float e0x = position(c1, 0) - position(c0, 0);
+                float e0y = position(c1, 1) - position(c0, 1);
+                float e0z = position(c1, 2) - position(c0, 2);
+                float e1x = position(c2, 0) - position(c1, 0);
+                float e1y = position(c2, 1) - position(c1, 1);
+                float e1z = position(c2, 2) - position(c1, 2);
+                float cx = std::fabs(e0y * e1z - e0z * e1y);
+                float cy = std::fabs(e0z * e1x - e0x * e1z);
+                float cz = std::fabs(e0x * e1y - e0y * e1x);
+                const float epsilon = std::numeric_limits<float>::epsilon();
+                if (cx > epsilon || cy > epsilon || cz > epsilon)
+                {
+                    if (!(cx > cy && cx > cz))
+                    {
+                        axes[0] = 0;
+                        if (cz > cx && cz > cy)
+                            axes[1] = 1;
+                    }
+                    break;
+                }
+            }
+
+            _remaining.assign(_face, _face + _count);
+            size_t guess = 0;
+            size_t remainingIterations = _count;
+            size_t previousRemaining = _remaining.size();
+            Corner ind[3];
+            float vx[3];
+            float vy[3];
+
+            while (_remaining.size() > 3 && remainingIterations > 0)
+            {
+                size_t count = _remaining.size();
+                if (guess >= count) guess -= count;
+
+                if (previousRemaining != count)
+                {
+                    previousRemaining = count;
+                    remainingIterations = count;
+                }
+                else
+                {
+                    remainingIterations--;
+                }
+
+                for (size_t k = 0; k < 3; k++)
+                {
+                    ind[k] = _remaining[(guess + k) % count];
+                    vx[k] = position(ind[k], axes[0]);
+                    vy[k] = position(ind[k], axes[1]);
+                }
+
+                float e0x = vx[1] - vx[0];
+                float e0y = vy[1] - vy[0];
+                float e1x = vx[2] - vx[1];
+                float e1y = vy[2] - vy[1];
+                float cross = e0x * e1y - e0y * e1x;
+                float area = (vx[0] * vy[1] - vy[0] * vx[1]) * 0.5f;
+                if (cross * area < 0.0f)
+                {
+                    guess++;
+                    continue;
+                }
+
+                bool overlap = false;
+                for (size_t other = 3; other < count; other++)
+                {
+                    const Corner& corner = _remaining[(guess + other) % count];
+                    if (pnpoly(3, vx, vy, position(corner, axes[0]), position(corner, axes[1])))
+                    {
+                        overlap = true;
+                        break;
+                    }
+                }
+                if (overlap)
+                {
+                    guess++;
+                    continue;
+                }
+
+                _out.insert(_out.end(), { ind[0], ind[1], ind[2] });
+                _remaining.erase(_remaining.begin() + (guess + 1) % count);
+            }
+
+            if (_remaining.size() == 3)
+                _out.insert(_out.end(), { _remaining[0], _remaining[1], _remaining[2] });
+        }
+
+        void triangulateFace(const Corner* _face, size_t _count, const float* _positions, std::vector<Corner>& _scratch, std::vector<Corner>& _out)
+        {
+            if (_count < 3) return; // Degenerate, tinyobj skips these too
+
+            if (_count == 3)
+            {
+                _out.insert(_out.end(), { _face[0], _face[1], _face[2] });
+                return;
+            }
+
+            if (_count == 4)
+            {
+                // Split along the shorter diagonal
+                const float* v0 = _positions + size_t(_face[0].m_position) * 3;
+                const float* v1 = _positions + size_t(_face[1].m_position) * 3;
+                const float* v2 = _positions + size_t(_face[2].m_position) * 3;
+                const float* v3 = _positions + size_t(_face[3].m_position) * 3;
+                float e02x = v2[0] - v0[0], e02y = v2[1] - v0[1], e02z = v2[2] - v0[2];
+                float e13x = v3[0] - v1[0], e13y = v3[1] - v1[1], e13z = v3[2] - v1[2];
+                float sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+                float sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+                if (sqr02 < sqr13)
+                    _out.insert(_out.end(), { _face[0], _face[1], _face[2], _face[0], _face[2], _face[3] });
+                else
+                    _out.insert(_out.end(), { _face[0], _face[1], _face[3], _face[1], _face[2], _face[3] });
+                return;
+            }
+
+            triangulatePolygon(_face, _count, _positions, _scratch, _out);
+        }
+
+        // Returns false if any index is out of range
+        bool resolveCorner(const RawCorner& _raw, const Chunk& _chunk, size_t _positionCount, size_t _texcoordCount, size_t _normalCount, Corner& _out)
+        {
+            auto resolve = [](int32_t _index, bool _relative, size_t _base, size_t _count, bool _optional, int32_t& _result)
+            {
+                int64_t index = _relative ? int64_t(_base) + _index : _index;
+                if (_optional && !_relative && index == -1)
+                {
+                    _result = -1;
+                    return true;
+                }
+                _result = static_cast<int32_t>(index);
+                return index >= 0 && index < int64_t(_count);
+            };
+
+            return resolve(_raw.m_position, _raw.m_relative & RELATIVE_POSITION, _chunk.m_positionBase, _positionCount, false, _out.m_position) &&
+                   resolve(_raw.m_texcoord, _raw.m_relative & RELATIVE_TEXCOORD, _chunk.m_texcoordBase, _texcoordCount, true, _out.m_texcoord) &&
+                   resolve(_raw.m_normal, _raw.m_relative & RELATIVE_NORMAL, _chunk.m_normalBase, _normalCount, true, _out.m_normal);
+        }
+    }
+
+    ObjParser::Stats ObjParser::load(const std::string& _filePath, Model::Data& _outData, uint32_t _threadCount)
+    {
+        auto start = Clock::now();
+
+        MappedFile file;
+        if (!file.open(_filePath))
+            throw std::runtime_error("Failed to load model: can't open " + _filePath);
+
+        if (_threadCount == 0)
+            _threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        Stats stats;
+        stats.m_bytes = file.size();
+
+        // Parse every chunk on its own thread
+        std::vector<Chunk> chunks = splitChunks(reinterpret_cast<const char*>(file.data()), file.size(), _threadCount);
+        stats.m_threads = static_cast<uint32_t>(chunks.size());
+        parallelFor(chunks.size(), [&chunks](size_t _index) { parseChunk(chunks[_index]); });
+
+        auto parsed = Clock::now();
+        stats.m_parseMs = std::chrono::duration<double, std::milli>(parsed - start).count();
+
+        // Global offsets of each chunk
+        size_t positionCount = 0, texcoordCount = 0, normalCount = 0, lineBase = 0;
+        for (Chunk& chunk : chunks)
+        {
+            if (chunk.m_errorLine != 0)
+                throw std::runtime_error("Failed to load model: invalid face index in " + _filePath + " line " + std::to_string(lineBase + chunk.m_errorLine));
+
+            chunk.m_positionBase = positionCount;
+            chunk.m_texcoordBase = texcoordCount;
+            chunk.m_normalBase = normalCount;
+            positionCount += chunk.m_positions.size() / 3;
+            texcoordCount += chunk.m_texcoords.size() / 2;
+            normalCount += chunk.m_normals.size() / 3;
+            lineBase += chunk.m_lineCount;
+        }
+
+        // Gather attributes, then resolve and triangulate faces, still per chunk
+        std::vector<float> positions(positionCount * 3), colours(positionCount * 3), texcoords(texcoordCount * 2), normals(normalCount * 3);
+        std::vector<uint8_t> invalid(chunks.size(), 0);
+        parallelFor(chunks.size(), [&](size_t _index)
+        {
+            const Chunk& chunk = chunks[_index];
+            std::copy(chunk.m_positions.begin(), chunk.m_positions.end(), positions.begin() + chunk.m_positionBase * 3);
+            std::copy(chunk.m_colours.begin(), chunk.m_colours.end(), colours.begin() + chunk.m_positionBase * 3);
+            std::copy(chunk.m_texcoords.begin(), chunk.m_texcoords.end(), texcoords.begin() + chunk.m_texcoordBase * 2);
+            std::copy(chunk.m_normals.begin(), chunk.m_normals.end(), normals.begin() + chunk.m_normalBase * 3);
+        });
+        parallelFor(chunks.size(), [&](size_t _index)
+        {
+            Chunk& chunk = chunks[_index];
+            std::vector<Corner> face;
+            chunk.m_triangles.reserve(chunk.m_corners.size());
+
+            size_t cornerIndex = 0;
+            for (uint32_t faceSize : chunk.m_faceSizes)
+            {
+                face.resize(faceSize);
+                for (uint32_t i = 0; i < faceSize; i++)
+                {
+                    if (!resolveCorner(chunk.m_corners[cornerIndex + i], chunk, positionCount, texcoordCount, normalCount, face[i]))
+                    {
+                        invalid[_index] = 1;
+                        return;
+                    }
+                }
+                cornerIndex += faceSize;
+                triangulateFace(face.data(), faceSize, positions.data(), chunk.m_scratch, chunk.m_triangles);
+            }
+        });
+        if (std::find(invalid.begin(), invalid.end(), uint8_t(1)) != invalid.end())
+            throw std::runtime_error("Failed to load model: face index out of range in " + _filePath);
+
+        // Deduplicate in file order so vertex order and indices match the tinyobj path
+        _outData.m_vertices.clear();
+        _outData.m_indices.clear();
+
+        size_t cornerCount = 0;
+        for (const Chunk& chunk : chunks)
+            cornerCount += chunk.m_triangles.size();
+        _outData.m_indices.reserve(cornerCount);
+
+        VertexDedupe uniqueVertices(_outData.m_vertices, cornerCount);
+        for (const Chunk& chunk : chunks)
+        {
+            for (const Corner& corner : chunk.m_triangles)
+            {
+                Model::Vertex vertex{};
+                const size_t p = size_t(corner.m_position) * 3;
+                vertex.m_position = { positions[p + 0], positions[p + 1], positions[p + 2] };
+                vertex.m_colour = { colours[p + 0], colours[p + 1], colours[p + 2] };
+                if (corner.m_normal >= 0)
+                {
+                    const size_t n = size_t(corner.m_normal) * 3;
+                    vertex.m_normal = { normals[n + 0], normals[n + 1], normals[n + 2] };
+                }
+                if (corner.m_texcoord >= 0)
+                {
+                    const size_t t = size_t(corner.m_texcoord) * 2;
+                    vertex.m_uv = { texcoords[t + 0], texcoords[t + 1] };
+                }
+
+                _outData.m_indices.push_back(uniqueVertices.insert(vertex));
+            }
+        }
+
+        auto end = Clock::now();
+        stats.m_buildMs = std::chrono::duration<double, std::milli>(end - parsed).count();
+        stats.m_totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+        return stats;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "ModelHandler.h"
+
+#include <string>
+
+namespace Engine
+{
+    /*
+     * Multithreaded Wavefront OBJ loader. The file is memory mapped, split into
+     * line aligned chunks and each chunk is parsed on its own thread with std::from_chars.
+     * Output matches Model::Data::loadModelTinyObj: same triangulation (shorter quad
+     * diagonal, ear clipping above 4 vertices), vertex order and indices.
+     * Only geometry is read, materials, groups, lines and points are ignored.
+     */
+    struct ObjParser
+    {
+        struct Stats
+        {
+            size_t m_bytes = 0;
+            uint32_t m_threads = 0;
+            double m_parseMs = 0.0;  // Parallel chunk parse
+            double m_buildMs = 0.0;  // Index resolve, triangulation and vertex dedupe
+            double m_totalMs = 0.0;
+
+            double megabytesPerSecond() const { return m_totalMs > 0.0 ? (m_bytes / (1024.0 * 1024.0)) / (m_totalMs / 1000.0) : 0.0; }
+        };
+
+        // Throws std::runtime_error on unreadable files and invalid indices.
+        // _threadCount of 0 uses every hardware thread
+        static Stats load(const std::string& _filePath, Model::Data& _outData, uint32_t _threadCount = 0);
+    };
+}
@@ -1,6 +1,7 @@
 #include "Pipeline.h"
 #include "ModelHandler.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <cassert>
@@ -13,11 +14,22 @@ namespace Engine
         createGraphicsPipeline(_vertFilePath, _fragFilePath, _configInfo);
     }
 
+    Pipeline::Pipeline(EngineDevice& _device, const std::string& _compFilePath, VkPipelineLayout _pipelineLayout)
+        : m_device(_device), m_bindPoint(VK_PIPELINE_BIND_POINT_COMPUTE)
+    {
+        createComputePipeline(_compFilePath, _pipelineLayout);
+    }
+
     Pipeline::~Pipeline()
     {
-        vkDestroyShaderModule(m_device.device(), m_vertShaderModule, nullptr);
-        vkDestroyShaderModule(m_device.device(), m_fragShaderModule, nullptr);
-        vkDestroyPipeline(m_device.device(), m_graphicsPipeline, nullptr);
+        // Command buffers still in flight may have the pipeline bound
+        m_device.deferDestroy([device = m_device.device(), vert = m_vertShaderModule, frag = m_fragShaderModule, comp = m_compShaderModule, pipeline = m_pipeline]()
+            {
+                vkDestroyShaderModule(device, vert, nullptr);
+                vkDestroyShaderModule(device, frag, nullptr);
+                vkDestroyShaderModule(device, comp, nullptr);
+                vkDestroyPipeline(device, pipeline, nullptr);
+            });
     }
 
     void Pipeline::createGraphicsPipeline(const std::string& _vertFilePath, const std::string& _fragFilePath, const PipelineConfigInfo& _configInfo)
@@ -77,10 +89,31 @@ namespace Engine
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(m_device.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS)
+        if (vkCreateGraphicsPipelines(m_device.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline) != VK_SUCCESS)
             throw std::runtime_error("Failed to create graphics pipeline!");
     }
 
+    void Pipeline::createComputePipeline(const std::string& _compFilePath, VkPipelineLayout _pipelineLayout)
+    {
+        assert(_pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline: No pipelineLayout provided");
+
+        auto compCode = readFile(_compFilePath);
+        createShaderModule(compCode, &m_compShaderModule);
+
+        VkComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = m_compShaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = _pipelineLayout;
+        pipelineInfo.basePipelineIndex = -1;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+        if (vkCreateComputePipelines(m_device.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create compute pipeline!");
+    }
+
     void Pipeline::createShaderModule(const std::vector<char>& _code, VkShaderModule* _shaderModule)
     {
         VkShaderModuleCreateInfo createInfo = {};
@@ -166,15 +199,28 @@ namespace Engine
        _configInfo.m_depthStencilInfo.back = {};
 
        // Dynamic State (States that can change at runtime)
-       _configInfo.m_dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+       // Vertex binding stride is dynamic so models can bind a single element colour stream (stride 0)
+       _configInfo.m_dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE };
        _configInfo.m_dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
        _configInfo.m_dynamicStateInfo.pDynamicStates = _configInfo.m_dynamicStateEnables.data();
        _configInfo.m_dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(_configInfo.m_dynamicStateEnables.size());
        _configInfo.m_dynamicStateInfo.flags = 0;
 
 
-       _configInfo.m_bindingDescriptions = Model::Vertex::getBindingDescriptions();
-       _configInfo.m_attributeDescriptions = Model::Vertex::getAttributeDescriptions();
+       _configInfo.m_bindingDescriptions = Model::Layout::getBindingDescriptions();
+       _configInfo.m_attributeDescriptions = Model::Layout::getAttributeDescriptions();
+    }
+
+    void Pipeline::clearVertexInput(PipelineConfigInfo& _configInfo)
+    {
+        _configInfo.m_bindingDescriptions.clear();
+        _configInfo.m_attributeDescriptions.clear();
+
+        // Dynamic stride would require binding vertex buffers before every draw
+        auto& states = _configInfo.m_dynamicStateEnables;
+        states.erase(std::remove(states.begin(), states.end(), VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE), states.end());
+        _configInfo.m_dynamicStateInfo.pDynamicStates = states.data();
+        _configInfo.m_dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(states.size());
     }
 
     void Pipeline::enableAlphaBlending(PipelineConfigInfo& _configInfo)
@@ -191,7 +237,7 @@ namespace Engine
 
     void Pipeline::bind(VkCommandBuffer _commandBuffer)
     {
-        vkCmdBindPipeline(_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+        vkCmdBindPipeline(_commandBuffer, m_bindPoint, m_pipeline);
     }
 
     std::vector<char> Pipeline::readFile(const std::string& _filePath)
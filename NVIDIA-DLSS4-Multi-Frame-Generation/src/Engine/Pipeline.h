@@ -32,6 +32,8 @@ namespace Engine
     struct Pipeline
     {
         Pipeline(EngineDevice& _device, const std::string& _vertFilePath, const std::string& _fragFilePath, const PipelineConfigInfo& _configInfo);
+        // Compute pipeline from a single shader
+        Pipeline(EngineDevice& _device, const std::string& _compFilePath, VkPipelineLayout _pipelineLayout);
         Pipeline() = default;
         ~Pipeline();
 
@@ -40,19 +42,25 @@ namespace Engine
 
         static void defaultPipelineConfigInfo(PipelineConfigInfo& _configInfo);
         static void enableAlphaBlending(PipelineConfigInfo& _configInfo);
+        static void clearVertexInput(PipelineConfigInfo& _configInfo);
 
         void bind(VkCommandBuffer _commandBuffer);
 
-    private:
         static std::vector<char> readFile(const std::string& _filePath);
 
+    private:
+
         void createGraphicsPipeline(const std::string& _vertFilePath, const std::string& _fragFilePath, const PipelineConfigInfo& _configInfo);
 
+        void createComputePipeline(const std::string& _compFilePath, VkPipelineLayout _pipelineLayout);
+
         void createShaderModule(const std::vector<char>& _code, VkShaderModule* _shaderModule);
 
         EngineDevice& m_device;
-        VkPipeline m_graphicsPipeline;
-        VkShaderModule m_vertShaderModule;
-        VkShaderModule m_fragShaderModule;
+        VkPipeline m_pipeline = VK_NULL_HANDLE;
+        VkPipelineBindPoint m_bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        VkShaderModule m_vertShaderModule = VK_NULL_HANDLE;
+        VkShaderModule m_fragShaderModule = VK_NULL_HANDLE;
+        VkShaderModule m_compShaderModule = VK_NULL_HANDLE;
     };
 }
\ No newline at end of file
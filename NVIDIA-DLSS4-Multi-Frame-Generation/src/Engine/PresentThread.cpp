@@ -0,0 +1,125 @@
+#include "PresentThread.h"
+
+#include "FrameGenerationHandler.h"
+
+namespace Engine
+{
+    PresentThread::PresentThread(EngineDevice& _device, SlVkProxies& _slProxies)
+        : m_device(_device), m_slProxies(_slProxies)
+    {
+    }
+
+    PresentThread::~PresentThread()
+    {
+        setEnabled(false);
+    }
+
+    void PresentThread::setEnabled(bool _enabled)
+    {
+        if (_enabled == isEnabled()) return;
+
+        if (_enabled)
+        {
+            m_thread = std::thread(&PresentThread::run, this);
+            return;
+        }
+
+        push(Request{}); // Behind everything already queued
+        m_thread.join();
+    }
+
+    VkResult PresentThread::present(const Request& _request)
+    {
+        if (!isEnabled())
+            return presentNow(_request);
+
+        push(_request);
+        return m_result.exchange(VK_SUCCESS, std::memory_order_relaxed);
+    }
+
+    void PresentThread::drain()
+    {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        for (uint64_t tail = m_tail.load(std::memory_order_acquire); tail != head; tail = m_tail.load(std::memory_order_acquire))
+            m_tail.wait(tail, std::memory_order_acquire);
+    }
+
+    void PresentThread::push(const Request& _request)
+    {
+        // Only full if presents stall for longer than it takes to acquire every swap chain image
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        for (uint64_t tail = m_tail.load(std::memory_order_acquire); head - tail >= CAPACITY; tail = m_tail.load(std::memory_order_acquire))
+            m_tail.wait(tail, std::memory_order_acquire);
+
+        m_ring[head % CAPACITY] = _request;
+        m_head.store(head + 1, std::memory_order_release);
+        m_head.notify_one();
+    }
+
+    void PresentThread::run()
+    {
+        for (uint64_t tail = m_tail.load(std::memory_order_relaxed);; )
+        {
+            m_head.wait(tail, std::memory_order_acquire);
+            const Request request = m_ring[tail % CAPACITY];
+
+            const bool stopping = request.m_swapChain == VK_NULL_HANDLE;
+            if (!stopping)
+            {
+                // Out of date beats suboptimal, either makes the renderer recreate the swap chain
+                const VkResult result = presentNow(request);
+                if (result < VK_SUCCESS)
+                    m_result.store(result, std::memory_order_relaxed);
+                else if (result == VK_SUBOPTIMAL_KHR)
+                {
+                    VkResult expected = VK_SUCCESS;
+                    m_result.compare_exchange_strong(expected, result, std::memory_order_relaxed);
+                }
+            }
+
+            m_tail.store(++tail, std::memory_order_release);
+            m_tail.notify_all();
+            if (stopping) return;
+        }
+    }
+
+    VkResult PresentThread::presentNow(const Request& _request)
+    {
+        VkPresentInfoKHR presentInfo = {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &_request.m_waitSemaphore;
+
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &_request.m_swapChain;
+        presentInfo.pImageIndices = &_request.m_imageIndex;
+
+        // Tagged with the frame's timeline value, so the frame pacer can wait for it to be displayed
+        VkPresentIdKHR presentIdInfo = {};
+        presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        presentIdInfo.swapchainCount = 1;
+        presentIdInfo.pPresentIds = &_request.m_presentId;
+        if (m_device.presentWaitEnabled())
+            presentInfo.pNext = &presentIdInfo;
+
+        FrameGenerationHandler* frameGen = _request.m_frameGen;
+        if (frameGen)
+            frameGen->reflexPresentStart(*_request.m_frameToken);
+
+        VkResult result;
+        {
+            std::lock_guard<std::mutex> lock(m_device.presentMutex());
+            result = m_slProxies.QueuePresentKHR(m_device.presentQueue(), &presentInfo);
+        }
+
+        if (frameGen)
+        {
+            frameGen->reflexPresentEnd(*_request.m_frameToken);
+            if (result == VK_SUCCESS) frameGen->markPresented();
+            frameGen->updateState();
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "EngineDevice.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace sl { struct FrameToken; }
+
+namespace Engine
+{
+    struct FrameGenerationHandler;
+
+    /*
+     * Moves vkQueuePresentKHR, its PCL markers and the frame generation state query off the main
+     * thread. With frame generation the present call can block for a long time while the generated
+     * frames are paced out, so the main thread only queues the present and moves on to simulating
+     * the next frame. Requests travel through a lock free single producer, single consumer ring.
+     * The swap chain must not be acquired from or recreated while a present is outstanding, so the
+     * renderer calls drain() first. When disabled, present() runs inline on the calling thread.
+     */
+    struct PresentThread
+    {
+        struct Request
+        {
+            VkSwapchainKHR m_swapChain = VK_NULL_HANDLE; // Null asks the thread to exit
+            uint32_t m_imageIndex = 0;
+            VkSemaphore m_waitSemaphore = VK_NULL_HANDLE;
+            uint64_t m_presentId = 0; // Attached when present wait is enabled
+            FrameGenerationHandler* m_frameGen = nullptr;
+            const sl::FrameToken* m_frameToken = nullptr;
+        };
+
+        PresentThread(EngineDevice& _device, SlVkProxies& _slProxies);
+        ~PresentThread();
+
+        PresentThread(const PresentThread&) = delete;
+        PresentThread& operator=(const PresentThread&) = delete;
+
+        bool isEnabled() const { return m_thread.joinable(); }
+        // Main thread. Starts or stops the thread, presents queued so far still go out
+        void setEnabled(bool _enabled);
+
+        // Main thread. Queues the present, or runs it when disabled. Returns the result of this present
+        // when inline, otherwise the worst result of the presents completed since the last call
+        VkResult present(const Request& _request);
+        // Main thread. Returns once every queued present has been issued
+        void drain();
+        // Main thread. Drops results of presents to a swap chain that has just been replaced
+        void clearResult() { m_result.store(VK_SUCCESS, std::memory_order_relaxed); }
+
+    private:
+        // Larger than any number of swap chain images, which bound how many presents can be outstanding
+        static constexpr uint64_t CAPACITY = 8;
+
+        void run();
+        VkResult presentNow(const Request& _request);
+        void push(const Request& _request);
+
+        EngineDevice& m_device;
+        SlVkProxies& m_slProxies;
+        std::thread m_thread;
+
+        std::array<Request, CAPACITY> m_ring{};
+        std::atomic<uint64_t> m_head{ 0 }; // Written by the main thread only
+        std::atomic<uint64_t> m_tail{ 0 }; // Written by the present thread only, once a present has been issued
+        std::atomic<VkResult> m_result{ VK_SUCCESS };
+    };
+}
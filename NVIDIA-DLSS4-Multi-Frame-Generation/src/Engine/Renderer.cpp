@@ -3,13 +3,24 @@
 #include "FrameGenerationHandler.h"
 
 #include <stdexcept>
+#include <algorithm>
 #include <array>
 #include <iostream>
+#include <chrono>
 
 namespace Engine
 {
+    namespace
+    {
+        // FIFO modes present on a refresh, so display times are whole refresh intervals apart
+        bool isRefreshLocked(VkPresentModeKHR _presentMode)
+        {
+            return _presentMode == VK_PRESENT_MODE_FIFO_KHR || _presentMode == VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+        }
+    }
+
     Renderer::Renderer(std::weak_ptr<EngineWindow> _window, EngineDevice& _device, SlVkProxies& _slProxies)
-        : m_window(_window), m_device(_device), m_slProxies(_slProxies)
+        : m_window(_window), m_device(_device), m_slProxies(_slProxies), m_gpuTimer(_device, SwapChain::MAX_FRAMES_IN_FLIGHT)
     {
         std::cout << "Max Push Constant Size: " << m_device.properties.limits.maxPushConstantsSize << std::endl;
         recreateSwapChain();
@@ -25,7 +36,16 @@ namespace Engine
     {
         assert(!m_isFrameStarted && "Cannot call beginFrame while a frame is already in progress!");
 
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        // The swap chain can't be acquired from while the previous frame's present is still outstanding
+        m_presentThread.drain();
         auto result = m_swapChain->acquireNextImage(&m_currentImageIndex);
+        m_acquireSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - frameStart).count();
+        measureRetiredFrames();
+
+        // Releases by what the GPU has actually finished, which can be ahead of the frame acquire waited for
+        m_device.releaseCompletedFrames();
+
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
             recreateSwapChain();
@@ -36,6 +56,27 @@ namespace Engine
             throw std::runtime_error("Failed to acquire swap chain image!");
 
         m_isFrameStarted = true;
+        m_frameStartTimes[m_currentFrameIndex] = m_inputSampled ? m_inputSampledAt : frameStart;
+        m_inputSampled = false;
+        m_frameArenas[m_currentFrameIndex].reset();
+        // The slot's last frame is measured at the scale it was drawn at, which the next scale is worked out from
+        double gpuMs = 0.0;
+        if (m_gpuTimer.resolve(m_currentFrameIndex, gpuMs))
+        {
+            m_gpuSceneMs = gpuMs;
+            m_dynamicResolution.update(gpuMs, m_renderScales[m_currentFrameIndex]);
+        }
+        m_upscaler.resolveTiming(m_currentFrameIndex);
+
+        const float scale = m_dynamicResolution.isEnabled() ? m_dynamicResolution.scale() : m_upscaler.getPresetInfo().m_renderScale;
+        const VkExtent2D extent = m_swapChain->getSwapChainExtent();
+        m_renderScales[m_currentFrameIndex] = scale;
+        m_renderExtent.width = std::max(1u, static_cast<uint32_t>(extent.width * scale + 0.5f));
+        m_renderExtent.height = std::max(1u, static_cast<uint32_t>(extent.height * scale + 0.5f));
+        m_upscaled = m_renderExtent.width != extent.width || m_renderExtent.height != extent.height;
+        // Its output is tagged as the hudless colour before the passes are recorded
+        if (m_upscaled)
+            m_upscaler.prepare(m_currentFrameIndex, extent, m_swapChain->getSwapChainImageFormat());
 
         VkCommandBuffer commandBuffer = getCurrentCommandBuffer();
         VkCommandBufferBeginInfo beginInfo = {};
@@ -57,6 +98,7 @@ namespace Engine
 
         if (m_frameGen)
         {
+            // Below native the upscaler's output is the hudless colour, otherwise the swap chain image is
             m_frameGen->tagResources(
                 m_swapChain->getDepthImage(m_currentImageIndex),
                 m_swapChain->getDepthImageView(m_currentImageIndex),
@@ -66,28 +108,80 @@ namespace Engine
                 m_swapChain->getMotionVectorImageView(m_currentImageIndex),
                 m_swapChain->getMotionVectorImageMemory(m_currentImageIndex),
 
-                m_swapChain->getSwapChainImage(m_currentImageIndex),
-                m_swapChain->getSwapChainImageView(m_currentImageIndex),
-                VK_NULL_HANDLE,
+                m_upscaled ? m_upscaler.getOutputImage(m_currentFrameIndex) : m_swapChain->getSwapChainImage(m_currentImageIndex),
+                m_upscaled ? m_upscaler.getOutputImageView(m_currentFrameIndex) : m_swapChain->getSwapChainImageView(m_currentImageIndex),
+                m_upscaled ? m_upscaler.getOutputImageMemory(m_currentFrameIndex) : VK_NULL_HANDLE,
+                m_upscaled ? m_upscaler.getOutputFormat(m_currentFrameIndex) : m_swapChain->getSwapChainImageFormat(),
+                m_upscaled ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
 
+                m_renderExtent,
                 m_swapChain->getSwapChainExtent(),
+                m_swapChain->getRenderTargetExtent(),
                 commandBuffer
             );
         }
 
-        auto result = m_swapChain->submitCommandBuffers(&commandBuffer, &m_currentImageIndex, m_frameGen);
+        m_latencyLimiter.onSubmit(m_device.currentFrame(), m_gpuSceneMs);
 
-        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_window.lock()->hasWindowResized())
+        // With the present thread on, the result is from an earlier present, this one is still queued
+        auto result = m_swapChain->submitCommandBuffers(&commandBuffer, &m_currentImageIndex, m_frameGen, m_presentThread);
+        if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
+            m_framePacer.onPresent(m_swapChain->handle(), EngineDevice::frameValue(m_device.currentFrame()), m_acquireSeconds);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_window.lock()->hasWindowResized() || m_swapChainSettingsChanged)
         {
             m_window.lock()->resetWindowResizedFlag();
+            VkExtent2D previousExtent = m_swapChain->getSwapChainExtent();
             recreateSwapChain();
-            if (m_frameGen) m_frameGen->triggerReset(2);
+
+            // Frame generation history only goes stale when the image size changed, not on a present mode switch
+            VkExtent2D extent = m_swapChain->getSwapChainExtent();
+            if (m_frameGen && (extent.width != previousExtent.width || extent.height != previousExtent.height))
+                m_frameGen->triggerReset(2);
         }
         else if (result != VK_SUCCESS)
             throw std::runtime_error("Failed to submit command buffers!");
 
         m_isFrameStarted = false;
         m_currentFrameIndex = (m_currentFrameIndex + 1) % SwapChain::MAX_FRAMES_IN_FLIGHT;
+        m_device.advanceFrame();
+    }
+
+    void Renderer::setFramesInFlight(uint32_t _framesInFlight)
+    {
+        _framesInFlight = std::clamp<uint32_t>(_framesInFlight, 1, SwapChain::MAX_FRAMES_IN_FLIGHT);
+        m_swapChainSettingsChanged |= _framesInFlight != m_swapChainSettings.m_framesInFlight;
+        m_swapChainSettings.m_framesInFlight = _framesInFlight;
+    }
+
+    void Renderer::setPresentMode(VkPresentModeKHR _presentMode)
+    {
+        m_swapChainSettingsChanged |= _presentMode != m_swapChainSettings.m_presentMode;
+        m_swapChainSettings.m_presentMode = _presentMode;
+    }
+
+    void Renderer::measureRetiredFrames()
+    {
+        // Slots are only overwritten after this runs, and acquire has already waited far enough
+        // that no frame older than MAX_FRAMES_IN_FLIGHT can still be unmeasured
+        auto now = std::chrono::high_resolution_clock::now();
+        uint64_t completed = m_device.completedFrameCount();
+        if (completed <= m_retiredFrames) return;
+
+        double totalMs = 0.0;
+        for (uint64_t frame = m_retiredFrames; frame < completed; frame++)
+            totalMs += std::chrono::duration<double, std::milli>(now - m_frameStartTimes[frame % SwapChain::MAX_FRAMES_IN_FLIGHT]).count();
+
+        m_frameLatencyMs = totalMs / static_cast<double>(completed - m_retiredFrames);
+        m_retiredFrames = completed;
+    }
+
+    size_t Renderer::getFrameArenaHighWater() const
+    {
+        size_t highWater = 0;
+        for (const FrameArena& arena : m_frameArenas)
+            highWater = std::max(highWater, arena.highWaterMark());
+        return highWater;
     }
 
     void Renderer::beginSwapChainRenderPass(VkCommandBuffer _commandBuffer)
@@ -101,7 +195,7 @@ namespace Engine
         renderPassInfo.framebuffer = m_swapChain->getFrameBuffer(m_currentImageIndex);
 
         renderPassInfo.renderArea.offset = { 0, 0 };
-        renderPassInfo.renderArea.extent = m_swapChain->getSwapChainExtent();
+        renderPassInfo.renderArea.extent = m_renderExtent;
 
         std::array<VkClearValue, 3> clearValues = {};
         clearValues[0].color = { 0.42f, 0.5f, 0.68f, 1.0f }; // Clear colour / Main colour
@@ -111,17 +205,18 @@ namespace Engine
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPassInfo.pClearValues = clearValues.data();
 
+        m_gpuTimer.begin(_commandBuffer, m_currentFrameIndex);
         vkCmdBeginRenderPass(_commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         // Set viewport and scissor dynamically
         VkViewport viewport = {};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
-        viewport.width = static_cast<float>(m_swapChain->getSwapChainExtent().width);
-        viewport.height = static_cast<float>(m_swapChain->getSwapChainExtent().height);
+        viewport.width = static_cast<float>(m_renderExtent.width);
+        viewport.height = static_cast<float>(m_renderExtent.height);
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
-        VkRect2D scissor = { {0, 0}, m_swapChain->getSwapChainExtent() };
+        VkRect2D scissor = { {0, 0}, m_renderExtent };
         vkCmdSetViewport(_commandBuffer, 0, 1, &viewport);
         vkCmdSetScissor(_commandBuffer, 0, 1, &scissor);
     }
@@ -132,20 +227,99 @@ namespace Engine
         assert(_commandBuffer == getCurrentCommandBuffer() && "Cannot end render pass on command buffer from a different frame!");
 
         vkCmdEndRenderPass(_commandBuffer);
+        if (m_upscaled)
+        {
+            const VkExtent2D displayExtent = m_swapChain->getSwapChainExtent();
+            m_upscaler.record(_commandBuffer, m_currentFrameIndex,
+                m_swapChain->getSceneColourImage(m_currentImageIndex), m_swapChain->getSceneColourImageView(m_currentImageIndex),
+                m_renderExtent, displayExtent);
+            m_swapChain->recordScaleToSwapChain(_commandBuffer, m_currentImageIndex, m_upscaler.getOutputImage(m_currentFrameIndex), displayExtent);
+        }
+        else
+        {
+            m_swapChain->recordScaleToSwapChain(_commandBuffer, m_currentImageIndex,
+                m_swapChain->getSceneColourImage(m_currentImageIndex), m_renderExtent);
+        }
+        m_gpuTimer.end(_commandBuffer, m_currentFrameIndex);
+
+        if (m_captureRequested)
+        {
+            recordCapture(_commandBuffer,
+                m_upscaled ? m_upscaler.getOutputImage(m_currentFrameIndex) : m_swapChain->getSceneColourImage(m_currentImageIndex),
+                m_swapChain->getSwapChainExtent());
+        }
+    }
+
+    void Renderer::recordCapture(VkCommandBuffer _commandBuffer, VkImage _source, VkExtent2D _extent)
+    {
+        // Only one capture is outstanding at a time and the last was waited for, so the buffer is idle
+        const VkDeviceSize size = static_cast<VkDeviceSize>(_extent.width) * _extent.height * 4;
+        if (!m_captureBuffer || m_captureBuffer->getInstanceSize() != size)
+        {
+            m_captureBuffer = std::make_unique<Buffer>(m_device, size, 1, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, 1, ResourceTag::Staging);
+            m_captureBuffer->map();
+        }
+
+        // Both sources are left in TRANSFER_SRC_OPTIMAL after the copy to the swap chain image
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = { _extent.width, _extent.height, 1 };
+        vkCmdCopyImageToBuffer(_commandBuffer, _source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_captureBuffer->getBuffer(), 1, &region);
+
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = m_captureBuffer->getBuffer();
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+            0, nullptr, 1, &barrier, 0, nullptr);
+
+        // The upscaler's output is RGBA, encoded like the scene colour
+        const VkFormat swapChainFormat = m_swapChain->getSwapChainImageFormat();
+        m_captureBgra = !m_upscaled && (swapChainFormat == VK_FORMAT_B8G8R8A8_UNORM || swapChainFormat == VK_FORMAT_B8G8R8A8_SRGB);
+        m_captureExtent = _extent;
+        m_captureFrame = m_device.currentFrame();
+        m_captureRequested = false;
+        m_captureRecorded = true;
+    }
+
+    bool Renderer::readCapture(std::vector<uint8_t>& _outRgba, VkExtent2D& _outExtent)
+    {
+        if (!m_captureRecorded) return false;
+        m_captureRecorded = false;
+
+        m_device.waitForFrame(m_captureFrame);
+        m_captureBuffer->invalidate();
+
+        const uint8_t* texels = static_cast<const uint8_t*>(m_captureBuffer->getMappedMemory());
+        _outRgba.assign(texels, texels + static_cast<size_t>(m_captureExtent.width) * m_captureExtent.height * 4);
+        _outExtent = m_captureExtent;
+
+        if (m_captureBgra)
+        {
+            for (size_t texel = 0; texel < _outRgba.size(); texel += 4)
+                std::swap(_outRgba[texel], _outRgba[texel + 2]);
+        }
+        return true;
     }
 
     void Renderer::pushSLCommonConstants(const glm::mat4& _viewMatrix, const glm::mat4& _projectionMatrix, 
         const glm::mat4& _prevViewMatrix, const glm::mat4& _prevProjectionMatrix, 
-        float _nearZ, float _farZ, bool _depthInverted, 
-        glm::vec2 _motionVecScale)
+        float _nearZ, float _farZ, bool _depthInverted)
     {
         if (!m_frameGen) return;
         m_frameGen->setCommonConstants(
             _viewMatrix, _projectionMatrix, 
             _prevViewMatrix, _prevProjectionMatrix, 
-            m_swapChain->getSwapChainExtent(), m_window.lock()->getExtent(), 
-            _nearZ, _farZ, _depthInverted, 
-            _motionVecScale
+            m_renderExtent, m_swapChain->getSwapChainExtent(), 
+            _nearZ, _farZ, _depthInverted
         );
     }
 
@@ -180,19 +354,39 @@ namespace Engine
             glfwWaitEvents();
         }
 
-        vkDeviceWaitIdle(m_device.device()); // Wait for the device to finish all operations before recreating the swap chain
+        // No device wait here, the old swap chain's resources are parked in the deletion queue
+        // and frame completion is tracked on the device timeline, which outlives both
+        auto start = std::chrono::high_resolution_clock::now();
+        m_swapChainSettingsChanged = false;
+
+        // Queued presents go to the old swap chain before it is retired, and their results no longer matter
+        m_presentThread.drain();
+        m_presentThread.clearResult();
 
         if (m_swapChain == nullptr)
         {
-            m_swapChain = std::make_unique<SwapChain>(m_device, extend, m_slProxies);
+            m_swapChain = std::make_unique<SwapChain>(m_device, extend, m_swapChainSettings, m_slProxies);
+            m_framePacer.setRefreshLocked(isRefreshLocked(m_swapChain->presentMode()));
         }
         else
         {
             std::shared_ptr<SwapChain> oldSwapChain = std::move(m_swapChain);
-            m_swapChain = std::make_unique<SwapChain>(m_device, extend, oldSwapChain, m_slProxies);
+            m_swapChain = std::make_unique<SwapChain>(m_device, extend, m_swapChainSettings, oldSwapChain, m_slProxies);
 
             if (!oldSwapChain->compareSwapFormats(*m_swapChain.get()))
                 throw std::runtime_error("Swap chain image or depth format has changed!");
+
+            // Its destruction is deferred, but the pacing thread may still be waiting on one of its presents
+            m_framePacer.forget(oldSwapChain->handle());
+
+            m_framePacer.setRefreshLocked(isRefreshLocked(m_swapChain->presentMode()));
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            m_recreateStats.m_count++;
+            m_recreateStats.m_allocations += m_swapChain->allocatedRenderTargets() ? 1 : 0;
+            m_recreateStats.m_totalMs += elapsed;
+            m_recreateStats.m_worstMs = std::max(m_recreateStats.m_worstMs, elapsed);
+            std::cout << "Swap chain recreated (" << extend.width << "x" << extend.height << ", " << m_swapChain->framesInFlight()
+                << " frames in flight, " << SwapChain::presentModeName(m_swapChain->presentMode()) << ") in " << elapsed << " ms" << std::endl;
         }
     }
 }
\ No newline at end of file
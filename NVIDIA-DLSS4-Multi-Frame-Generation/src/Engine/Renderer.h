@@ -1,10 +1,20 @@
 #pragma once
 #include "SwapChain.h"
+#include "FrameArena.h"
+#include "GpuTimer.h"
+#include "FramePacer.h"
+#include "LatencyLimiter.h"
+#include "DynamicResolution.h"
+#include "Upscaler.h"
+#include "Buffer.h"
 
 #include <glm/mat4x4.hpp>
 
 #include <memory>
 #include <cassert>
+#include <array>
+#include <chrono>
+#include <vector>
 
 namespace Engine
 {
@@ -20,6 +30,13 @@ namespace Engine
         VkRenderPass getSwapChainRenderPass() const { return m_swapChain->getRenderPass(); }
         float getAspectRatio() const { return m_swapChain->extentAspectRatio(); }
         VkExtent2D getSwapChainExtent() const { return m_swapChain->getSwapChainExtent(); }
+        // Size the current frame's scene is drawn at, the swap chain extent times the render scale. Depth, motion
+        // vectors and the viewport use it, endSwapChainRenderPass() upscales the result to the swap chain image
+        VkExtent2D getRenderExtent() const
+        {
+            assert(m_isFrameStarted && "Cannot get render extent when frame is not in progress!");
+            return m_renderExtent;
+        }
         bool isFrameInProgress() const { return m_isFrameStarted; }
         VkCommandBuffer getCurrentCommandBuffer() const 
         { 
@@ -31,6 +48,64 @@ namespace Engine
             assert(m_isFrameStarted && "Cannot get current frame index when frame is not in progress!");
             return m_currentFrameIndex; 
         }
+        FrameArena& getFrameArena()
+        {
+            assert(m_isFrameStarted && "Cannot get frame arena when frame is not in progress!");
+            return m_frameArenas[m_currentFrameIndex];
+        }
+        size_t getFrameArenaHighWater() const;
+        // GPU time of the scene render pass, its upscale and the copy to the swap chain image, from the most recent frame
+        // that has retired. 0 if unsupported
+        double getGpuSceneMs() const { return m_gpuSceneMs; }
+        // Time from the frame's input being sampled (markInputSampled(), else beginFrame()) to the CPU seeing
+        // the frame retire, averaged over the frames that retired during the last beginFrame(). Present and
+        // scan out are not included
+        double getFrameLatencyMs() const { return m_frameLatencyMs; }
+        // Time the last frame's submit waited for the graphics queue, see EngineDevice::presentMutex()
+        double getSubmitWaitMs() const { return m_swapChain->getSubmitWaitMs(); }
+        void markInputSampled() { m_inputSampledAt = std::chrono::high_resolution_clock::now(); m_inputSampled = true; }
+
+        // How far the CPU may run ahead of the GPU (1 to SwapChain::MAX_FRAMES_IN_FLIGHT) and the present mode.
+        // Both apply when the next endFrame() recreates the swap chain, which keeps its render targets
+        void setFramesInFlight(uint32_t _framesInFlight);
+        uint32_t getFramesInFlight() const { return m_swapChain->framesInFlight(); }
+        void setPresentMode(VkPresentModeKHR _presentMode);
+        VkPresentModeKHR getPresentMode() const { return m_swapChain->presentMode(); }
+
+        // Recreations keep the render pass and pooled depth/MV images while they fit, see SwapChain::Settings.
+        // Takes effect from the next recreation
+        void setReuseRenderTargets(bool _reuse) { m_swapChainSettings.m_reuseRenderTargets = _reuse; }
+
+        struct RecreateStats
+        {
+            uint32_t m_count = 0;
+            uint32_t m_allocations = 0; // Recreations that had to allocate new depth/MV images
+            double m_totalMs = 0.0;
+            double m_worstMs = 0.0;
+        };
+        const RecreateStats& getRecreateStats() const { return m_recreateStats; }
+        void resetRecreateStats() { m_recreateStats = {}; }
+
+        // Off by default. Core calls waitForNextFrame() at the top of each frame
+        FramePacer& getFramePacer() { return m_framePacer; }
+        // Core enables it at startup unless Reflex's low latency mode is active. Core calls waitForNextFrame()
+        // before sampling input, endFrame() reports each submit
+        LatencyLimiter& getLatencyLimiter() { return m_latencyLimiter; }
+        // Off by default. Fed each retired frame's GPU time in beginFrame(), sets the render scale of the next frame
+        DynamicResolution& getDynamicResolution() { return m_dynamicResolution; }
+        // Its preset sets the render scale while dynamic resolution is off. Used whenever the scene is drawn below
+        // the swap chain extent
+        Upscaler& getUpscaler() { return m_upscaler; }
+
+        // Copies the next rendered frame's scene, after its upscale, to host memory. readCapture() waits for that
+        // frame and returns it as tightly packed RGBA8 at the swap chain extent, or false before it was rendered
+        void requestCapture() { m_captureRequested = true; }
+        bool readCapture(std::vector<uint8_t>& _outRgba, VkExtent2D& _outExtent);
+
+        // Off by default. When on, endFrame() returns once the frame is submitted and its present is
+        // queued, and the next beginFrame() waits for that present to have been issued
+        void setPresentThread(bool _enabled) { m_presentThread.setEnabled(_enabled); }
+        bool getPresentThread() const { return m_presentThread.isEnabled(); }
 
         VkCommandBuffer beginFrame();
         void endFrame();
@@ -42,8 +117,7 @@ namespace Engine
         void pushSLCommonConstants(
             const glm::mat4& _viewMatrix, const glm::mat4 & _projectionMatrix,
             const glm::mat4& _prevViewMatrix, const glm::mat4& _prevProjectionMatrix,
-            float _nearZ, float _farZ, bool _depthInverted,
-            glm::vec2 _motionVecScale
+            float _nearZ, float _farZ, bool _depthInverted
         );
 
     private:
@@ -64,5 +138,45 @@ namespace Engine
         void createCommandBuffers();
         void freeCommandBuffers();
         std::vector<VkCommandBuffer> m_commandBuffers;
+
+        // Transient CPU memory for each frame slot, reset when the slot is reused
+        std::array<FrameArena, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frameArenas;
+
+        GpuTimer m_gpuTimer;
+        double m_gpuSceneMs = 0.0;
+
+        DynamicResolution m_dynamicResolution;
+        std::array<float, SwapChain::MAX_FRAMES_IN_FLIGHT> m_renderScales{}; // Scale each slot's frame was drawn at
+        VkExtent2D m_renderExtent{};
+        bool m_upscaled = false; // The current frame's render extent is below the swap chain extent
+
+        Upscaler m_upscaler{ m_device };
+
+        void recordCapture(VkCommandBuffer _commandBuffer, VkImage _source, VkExtent2D _extent);
+        std::unique_ptr<Buffer> m_captureBuffer;
+        bool m_captureRequested = false;
+        bool m_captureRecorded = false;
+        uint64_t m_captureFrame = 0;
+        VkExtent2D m_captureExtent{};
+        bool m_captureBgra = false;
+
+        SwapChain::Settings m_swapChainSettings{};
+        bool m_swapChainSettingsChanged = false;
+        RecreateStats m_recreateStats;
+
+        // beginFrame() time of each slot's frame, read back once the frame retires
+        void measureRetiredFrames();
+        std::array<std::chrono::high_resolution_clock::time_point, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frameStartTimes{};
+        uint64_t m_retiredFrames = 0;
+        double m_frameLatencyMs = 0.0;
+        std::chrono::high_resolution_clock::time_point m_inputSampledAt{};
+        bool m_inputSampled = false;
+
+        FramePacer m_framePacer{ m_device, m_slProxies };
+        double m_acquireSeconds = 0.0; // Time the current frame spent blocked on the previous present and in acquire
+        LatencyLimiter m_latencyLimiter{ m_device };
+
+        // Declared after the swap chain, so it stops before the swap chain is destroyed
+        PresentThread m_presentThread{ m_device, m_slProxies };
     };
 }
\ No newline at end of file
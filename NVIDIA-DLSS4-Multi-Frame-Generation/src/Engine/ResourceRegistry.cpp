@@ -0,0 +1,110 @@
+#include "ResourceRegistry.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace Engine
+{
+    static double toMB(VkDeviceSize _bytes) { return static_cast<double>(_bytes) / (1024.0 * 1024.0); }
+
+    const char* resourceTagName(ResourceTag _tag)
+    {
+        switch (_tag)
+        {
+        case ResourceTag::Model: return "Model";
+        case ResourceTag::Texture: return "Texture";
+        case ResourceTag::RenderTarget: return "RenderTarget";
+        case ResourceTag::Staging: return "Staging";
+        case ResourceTag::Uniform: return "Uniform";
+        default: return "Other";
+        }
+    }
+
+    void ResourceRegistry::track(uint64_t _handle, VkObjectType _type, ResourceTag _tag, VkDeviceSize _size, uint32_t _heapIndex)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_entries[_handle] = Entry{ _type, _tag, _size, _heapIndex, m_frame.load() };
+        m_heapTotals[_heapIndex] += _size;
+        m_tagTotals[static_cast<size_t>(_tag)] += _size;
+        m_tagCounts[static_cast<size_t>(_tag)]++;
+    }
+
+    void ResourceRegistry::untrack(uint64_t _handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_entries.find(_handle);
+        if (it == m_entries.end()) return; // Not created through EngineDevice
+
+        const Entry& entry = it->second;
+        m_heapTotals[entry.m_heapIndex] -= entry.m_size;
+        m_tagTotals[static_cast<size_t>(entry.m_tag)] -= entry.m_size;
+        m_tagCounts[static_cast<size_t>(entry.m_tag)]--;
+        m_entries.erase(it);
+    }
+
+    size_t ResourceRegistry::liveCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    VkDeviceSize ResourceRegistry::heapUsage(uint32_t _heapIndex) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_heapTotals[_heapIndex];
+    }
+
+    VkDeviceSize ResourceRegistry::tagUsage(ResourceTag _tag) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_tagTotals[static_cast<size_t>(_tag)];
+    }
+
+    void ResourceRegistry::writeReport(std::ostream& _out, const std::vector<HeapBudget>& _heaps) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        _out << std::fixed << std::setprecision(2);
+        _out << "==== GPU resource report (frame " << m_frame.load() << ", " << m_entries.size() << " live) ====" << std::endl;
+
+        _out << "Heaps:" << std::endl;
+        for (size_t i = 0; i < _heaps.size(); i++)
+        {
+            const HeapBudget& heap = _heaps[i];
+            _out << "\t[" << i << "] " << (heap.m_deviceLocal ? "device local" : "host")
+                 << " | usage " << toMB(heap.m_usage) << " / budget " << toMB(heap.m_budget) << " MB"
+                 << " | tracked " << toMB(heap.m_tracked) << " MB"
+                 << " | size " << toMB(heap.m_size) << " MB" << std::endl;
+        }
+
+        _out << "Tags:" << std::endl;
+        for (size_t i = 0; i < static_cast<size_t>(ResourceTag::Count); i++)
+        {
+            if (m_tagCounts[i] == 0) continue;
+            _out << "\t" << std::left << std::setw(14) << resourceTagName(static_cast<ResourceTag>(i)) << std::right
+                 << m_tagCounts[i] << " objects, " << toMB(m_tagTotals[i]) << " MB" << std::endl;
+        }
+
+        // Largest allocations first, these are the ones worth looking at
+        std::vector<std::pair<uint64_t, Entry>> sorted(m_entries.begin(), m_entries.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& _a, const auto& _b) { return _a.second.m_size > _b.second.m_size; });
+
+        const size_t maxListed = 32;
+        _out << "Largest allocations:" << std::endl;
+        for (size_t i = 0; i < sorted.size() && i < maxListed; i++)
+        {
+            const auto& [handle, entry] = sorted[i];
+            _out << "\t0x" << std::hex << handle << std::dec
+                 << (entry.m_type == VK_OBJECT_TYPE_IMAGE ? " image  " : " buffer ")
+                 << std::left << std::setw(14) << resourceTagName(entry.m_tag) << std::right
+                 << toMB(entry.m_size) << " MB | heap " << entry.m_heapIndex
+                 << " | created frame " << entry.m_creationFrame << std::endl;
+        }
+        if (sorted.size() > maxListed)
+            _out << "\t... " << sorted.size() - maxListed << " more" << std::endl;
+
+        _out << std::defaultfloat;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+    // What a GPU allocation is used for, so the report can group costs
+    enum class ResourceTag : uint8_t
+    {
+        Model,
+        Texture,
+        RenderTarget,
+        Staging,
+        Uniform,
+        Other,
+        Count
+    };
+
+    const char* resourceTagName(ResourceTag _tag);
+
+    // Per memory heap view of usage against the driver budget
+    struct HeapBudget
+    {
+        VkDeviceSize m_size = 0;    // Heap size
+        VkDeviceSize m_budget = 0;  // VK_EXT_memory_budget budget, heap size when unavailable
+        VkDeviceSize m_usage = 0;   // Process usage from the driver, registry total when unavailable
+        VkDeviceSize m_tracked = 0; // Bytes the registry knows about on this heap
+        bool m_deviceLocal = false;
+    };
+
+    /*
+     * Tracks every live VkBuffer / VkImage allocated through EngineDevice
+     * along with its tag, size, heap and the frame it was created on.
+     */
+    struct ResourceRegistry
+    {
+        struct Entry
+        {
+            VkObjectType m_type; // VK_OBJECT_TYPE_BUFFER or VK_OBJECT_TYPE_IMAGE
+            ResourceTag m_tag;
+            VkDeviceSize m_size;
+            uint32_t m_heapIndex;
+            uint64_t m_creationFrame;
+        };
+
+        void track(uint64_t _handle, VkObjectType _type, ResourceTag _tag, VkDeviceSize _size, uint32_t _heapIndex);
+        void untrack(uint64_t _handle);
+
+        void advanceFrame() { m_frame++; }
+        uint64_t currentFrame() const { return m_frame; }
+
+        size_t liveCount() const;
+        VkDeviceSize heapUsage(uint32_t _heapIndex) const;
+        VkDeviceSize tagUsage(ResourceTag _tag) const;
+
+        void writeReport(std::ostream& _out, const std::vector<HeapBudget>& _heaps) const;
+
+    private:
+        mutable std::mutex m_mutex;
+        std::unordered_map<uint64_t, Entry> m_entries;
+        std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> m_heapTotals{};
+        std::array<VkDeviceSize, static_cast<size_t>(ResourceTag::Count)> m_tagTotals{};
+        std::array<uint32_t, static_cast<size_t>(ResourceTag::Count)> m_tagCounts{};
+        std::atomic<uint64_t> m_frame{ 0 };
+    };
+}
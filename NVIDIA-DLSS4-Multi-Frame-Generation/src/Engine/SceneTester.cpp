@@ -28,18 +28,38 @@ namespace Engine
             light.m_colour = lightColors[i % lightColors.size()];
             float t = (i / float(_count)) * glm::two_pi<float>();
             light.m_transform.m_translation = { orbitR * std::cos(t), -1.2f, orbitR * std::sin(t) };
-            _outObjects.emplace(light.getId(), std::move(light));
+            _outObjects.insert(std::move(light));
         }
     }
 
+    void SceneTester::SceneLoader::assignWhenReady(GameObject::Map& _objects, std::vector<GameObject::id_t> _ids,
+        const AssetHandle<Model>& _model, const AssetHandle<Texture>& _texture)
+    {
+        auto assign = [&_objects, ids = std::make_shared<std::vector<GameObject::id_t>>(std::move(_ids)), _model, _texture]()
+            {
+                if (!_model.isReady() || !_texture.isReady()) return;
+                for (GameObject::id_t id : *ids)
+                {
+                    if (GameObject* obj = _objects.get(id))
+                    {
+                        obj->m_model = _model.get();
+                        obj->m_diffuseMap = _texture.get();
+                    }
+                }
+            };
+        m_assets.onReady(_model, [assign](const std::shared_ptr<Model>&) { assign(); });
+        m_assets.onReady(_texture, [assign](const std::shared_ptr<Texture>&) { assign(); });
+    }
+
     void SceneTester::SceneLoader::loadStaticGrid(GameObject::Map& _outObjects, int _gridX, int _gridZ, float _spacing, float _uniformScale, float _y, bool _lights)
     {
         _outObjects.clear();
 
         // One shared model for all instances (VRAM/CPU friendly)
         const std::string modelPath = "Samples/Models/flat_vase.obj";
-        std::shared_ptr<Model> model = Model::createModelFromFile(m_device, modelPath);
-        std::shared_ptr<Texture> texture = Texture::createTextureFromFile(m_device, "Samples/Textures/Curuthers.png");
+        AssetHandle<Model> model = m_assets.loadModel(modelPath);
+        AssetHandle<Texture> texture = m_assets.loadTexture("Samples/Textures/Curuthers.png");
+        std::vector<GameObject::id_t> ids;
 
         const float halfX = (_gridX - 1) * 0.5f;
         const float halfZ = (_gridZ - 1) * 0.5f;
@@ -49,8 +69,6 @@ namespace Engine
             for (int x = 0; x < _gridX; x++)
             {
                 GameObject obj = GameObject::createGameObject();
-                obj.m_model = model;
-                obj.m_diffuseMap = texture;
 
                 const float px = (x - halfX) * _spacing;
                 const float pz = (z - halfZ) * _spacing;
@@ -59,10 +77,12 @@ namespace Engine
                 obj.m_transform.m_scale = { _uniformScale, _uniformScale, _uniformScale };
                 obj.m_transform.m_rotation = { 0.0f, 0.0f, 0.0f };
                 obj.m_transform.m_prevModelMatrix = obj.m_transform.mat4();
+                obj.m_meshletCulling = true;
 
-                _outObjects.emplace(obj.getId(), std::move(obj));
+                ids.push_back(_outObjects.insert(std::move(obj)));
             }
         }
+        assignWhenReady(_outObjects, std::move(ids), model, texture);
 
         if (_lights)
         {
@@ -87,8 +107,9 @@ namespace Engine
         m_time = 0.0f;
 
         const std::string modelPath = "Samples/Models/flat_vase.obj";
-        std::shared_ptr<Model> model = Model::createModelFromFile(m_device, modelPath);
-        std::shared_ptr<Texture> texture = Texture::createTextureFromFile(m_device, "Samples/Textures/Curuthers.png");
+        AssetHandle<Model> model = m_assets.loadModel(modelPath);
+        AssetHandle<Texture> texture = m_assets.loadTexture("Samples/Textures/Curuthers.png");
+        std::vector<GameObject::id_t> ids;
 
         const float halfX = (_gridX - 1) * 0.5f;
         const float halfZ = (_gridZ - 1) * 0.5f;
@@ -99,8 +120,6 @@ namespace Engine
             for (int x = 0; x < _gridX; x++) 
             {
                 GameObject obj = GameObject::createGameObject();
-                obj.m_model = model;
-                obj.m_diffuseMap = texture;
 
                 const float px = (x - halfX) * _spacing;
                 const float pz = (z - halfZ) * _spacing;
@@ -109,8 +128,10 @@ namespace Engine
                 obj.m_transform.m_scale = { _uniformScale, _uniformScale, _uniformScale };
                 obj.m_transform.m_rotation = { 0.0f, 0.0f, 0.0f };
                 obj.m_transform.m_prevModelMatrix = obj.m_transform.mat4();
+                obj.m_meshletCulling = true;
 
-                _outObjects.emplace(obj.getId(), std::move(obj));
+                GameObject::id_t id = _outObjects.insert(std::move(obj));
+                ids.push_back(id);
 
                 // Per-object motion params (deterministic)
                 uint32_t seed = (uint32_t)(x * 73856093) ^ (uint32_t)(z * 19349663);
@@ -126,6 +147,7 @@ namespace Engine
                 float rs = 0.4f + hash01(seed ^ 0x00000010) * 1.2f;
 
                 Mover m;
+                m.id = id;
                 m.base = { px, _y, pz };
                 // amplitudes
                 m.ax = 0.35f + 0.35f * hx;
@@ -138,9 +160,10 @@ namespace Engine
                 m.phx = phx; m.phz = phz; m.phy = phy;
                 m.rotSpeed = rs;
 
-                m_movers.emplace(obj.getId(), m);
+                m_movers.push_back(m);
             }
         }
+        assignWhenReady(_outObjects, std::move(ids), model, texture);
 
         if (_lights)
         {
@@ -152,26 +175,33 @@ namespace Engine
         }
     }
 
-    void SceneTester::SceneLoader::updateMovingScene(float _dt, GameObject::Map& _outObjects)
+    void SceneTester::SceneLoader::bindMovers(const GameObject::Map& _objects, std::vector<uint32_t>& _outIndices)
+    {
+        for (Mover& m : m_movers)
+        {
+            const GameObject* obj = _objects.get(m.id);
+            m.index = obj ? static_cast<uint32_t>(obj - _objects.data()) : UINT32_MAX;
+            if (obj) _outIndices.push_back(m.index);
+        }
+    }
+
+    void SceneTester::SceneLoader::updateMovingScene(float _dt, std::vector<TransformComponent>& _transforms)
     {
         if (m_movers.empty()) return;
         m_time += _dt;
 
-        for (auto& [id, obj] : _outObjects) 
+        for (const Mover& m : m_movers)
         {
-            if (!obj.m_model) continue;
-
-            auto it = m_movers.find(id);
-            if (it == m_movers.end()) continue;
-            const Mover& m = it->second;
+            if (m.index == UINT32_MAX) continue;
+            TransformComponent& transform = _transforms[m.index];
 
             glm::vec3 p = m.base;
             p.x += m.ax * std::sin(m.fx * m_time + m.phx);
             p.z += m.az * std::cos(m.fz * m_time + m.phz);
             p.y += m.ay * std::sin(m.fy * m_time + m.phy);
-            obj.m_transform.m_translation = p;
+            transform.m_translation = p;
 
-            obj.m_transform.m_rotation.y += m.rotSpeed * _dt;
+            transform.m_rotation.y += m.rotSpeed * _dt;
         }
     }
 
@@ -181,8 +211,9 @@ namespace Engine
         _outObjects.clear();
 
         // One shared qua
-        std::shared_ptr<Model> quad = Model::createModelFromFile(m_device, "Samples/Models/quad.obj");
-        std::shared_ptr<Texture> texture = Texture::createTextureFromFile(m_device, "Samples/Textures/Curuthers.png");
+        AssetHandle<Model> quad = m_assets.loadModel("Samples/Models/quad.obj");
+        AssetHandle<Texture> texture = m_assets.loadTexture("Samples/Textures/Curuthers.png");
+        std::vector<GameObject::id_t> ids;
 
         const float turns = 4.0f; // Total rotations across all quads
         const float rStep = 0.005f; // Growth per quad
@@ -191,8 +222,6 @@ namespace Engine
         for (int i = 0; i < _quads; ++i)
         {
             GameObject q = GameObject::createGameObject();
-            q.m_model = quad;
-            q.m_diffuseMap = texture;
 
             const float t = (_quads > 1) ? (float)i / (float)(_quads - 1) : 0.0f;
             const float a = t * turns * glm::two_pi<float>();
@@ -205,7 +234,8 @@ namespace Engine
 
             q.m_transform.m_prevModelMatrix = q.m_transform.mat4();
 
-            _outObjects.emplace(q.getId(), std::move(q));
+            ids.push_back(_outObjects.insert(std::move(q)));
         }
+        assignWhenReady(_outObjects, std::move(ids), quad, texture);
     }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "GameObject.h"
+#include "AssetLoader.h"
 
 namespace Engine
 {
@@ -12,12 +13,19 @@ namespace Engine
             MovingScene = 2,
             TrasnsparencyTest = 3
         };
+        static constexpr int SCENE_COUNT = 4;
 
         struct SceneLoader
         {
-            SceneLoader(EngineDevice& device) : m_device(device) {}
+            SceneLoader(EngineDevice& device) : m_device(device), m_assets(device) {}
 
-            // Static, GPU-heavy grid of a shared model.
+            // Per frame, uploads finished asset loads and fills in their placeholder objects
+            void updateAssets() { m_assets.update(UPLOADS_PER_FRAME); }
+            // Blocks until every requested asset is resident or failed, and its placeholders are filled in
+            void waitForAssets() { m_assets.waitAll(); }
+            const AssetRegistry::Stats& assetStats() const { return m_assets.registry().stats(); }
+
+            // Static, GPU-heavy grid of a shared model, culled per meshlet on the GPU.
             void loadStaticGrid(GameObject::Map& _outObjects,
                 int _gridX,
                 int _gridZ,
@@ -35,7 +43,12 @@ namespace Engine
                 bool _lights = true
             );
 
-            void updateMovingScene(float _dt, GameObject::Map& _outObjects);
+            // Resolves the movers' objects to their dense index in _objects, appending each to _outIndices.
+            // Valid until _objects is changed
+            void bindMovers(const GameObject::Map& _objects, std::vector<uint32_t>& _outIndices);
+            // Moves the bound movers in _transforms, indexed like _objects' dense storage. Doesn't touch the
+            // scene itself, so it can run on the simulation thread
+            void updateMovingScene(float _dt, std::vector<TransformComponent>& _transforms);
 
             void loadTransparencyTest(GameObject::Map& _outObjects,
                 int _quads, float _y, float _s
@@ -44,8 +57,13 @@ namespace Engine
             SceneType m_sceneType;
 
         private:
+            // Each upload waits for the graphics queue, so spread them over frames
+            static constexpr uint32_t UPLOADS_PER_FRAME = 4;
+
             struct Mover 
             {
+                GameObject::id_t id; // object being moved
+                uint32_t index;      // dense index of id, set by bindMovers
                 glm::vec3 base;      // base position
                 float ax, az, ay;    // amplitudes
                 float fx, fz, fy;    // angular frequencies
@@ -53,10 +71,16 @@ namespace Engine
                 float rotSpeed;      // radians/sec around Y
             };
 
-            std::unordered_map<GameObject::id_t, Mover> m_movers;
+            std::vector<Mover> m_movers;
             float m_time = 0.0f;
 
             EngineDevice& m_device;
+            AssetLoader m_assets;
+
+            // Objects are inserted as placeholders without a model or texture, which are both set
+            // once both are resident so nothing draws half loaded
+            void assignWhenReady(GameObject::Map& _objects, std::vector<GameObject::id_t> _ids,
+                const AssetHandle<Model>& _model, const AssetHandle<Texture>& _texture);
 
             void addDefaultLights(GameObject::Map& _outObjects,
                 int _count,
@@ -73,17 +97,17 @@ namespace Engine
             glm::vec3 m_target = { 0.f, -0.0f, 0.f };
             float m_time = 0.f;
 
-            void update(float _dt, GameObject& _viewer)
+            void update(float _dt, TransformComponent& _viewer)
             {
                 m_time += _dt * m_angularSpeed;
                 const float x = m_radius * std::sin(m_time);
                 const float z = -m_radius * std::cos(m_time);
-                _viewer.m_transform.m_translation = { x, m_height, z };
+                _viewer.m_translation = { x, m_height, z };
 
-                const glm::vec3 toTarget = glm::normalize(m_target - _viewer.m_transform.m_translation);
+                const glm::vec3 toTarget = glm::normalize(m_target - _viewer.m_translation);
                 const float yaw = std::atan2(toTarget.x, toTarget.z);
                 const float pitch = std::asin(-toTarget.y);
-                _viewer.m_transform.m_rotation = { pitch, yaw, 0.0f };
+                _viewer.m_rotation = { pitch, yaw, 0.0f };
             }
         };
     };
@@ -0,0 +1,147 @@
+#include "Simulation.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    Simulation::Simulation(SceneTester::SceneLoader& _loader, SceneTester::CameraPanController& _panController)
+        : m_loader(_loader), m_panController(_panController)
+    {
+        m_viewer.m_translation = glm::vec3(0.0f, 0.0f, -2.5f);
+    }
+
+    Simulation::~Simulation()
+    {
+        stop();
+    }
+
+    void Simulation::reset(GameObject::Map& _objects)
+    {
+        stop();
+        m_snapshots.reset(); // A step of the previous scene is no use
+        m_sceneType = m_loader.m_sceneType;
+
+        m_transforms.clear();
+        m_lights.clear();
+        m_dynamic.clear();
+        uint32_t index = 0;
+        for (GameObject& obj : _objects)
+        {
+            obj.m_transform.m_prevModelMatrix = obj.m_transform.mat4();
+            m_transforms.push_back(obj.m_transform);
+            if (obj.m_pointLight != nullptr) m_lights.push_back(index);
+            index++;
+        }
+
+        if (m_sceneType == SceneTester::SceneType::MovingScene)
+            m_loader.bindMovers(_objects, m_dynamic);
+        if (m_sceneType != SceneTester::SceneType::CameraPan)
+            m_dynamic.insert(m_dynamic.end(), m_lights.begin(), m_lights.end());
+        std::sort(m_dynamic.begin(), m_dynamic.end());
+        m_dynamic.erase(std::unique(m_dynamic.begin(), m_dynamic.end()), m_dynamic.end());
+
+        m_dynamicModels.clear();
+        for (uint32_t dynamic : m_dynamic)
+            m_dynamicModels.push_back(m_transforms[dynamic].m_prevModelMatrix);
+
+        // Loading took a while, none of it should be simulated
+        m_firstStep = true;
+    }
+
+    void Simulation::stop()
+    {
+        if (!m_thread.joinable()) return;
+
+        m_snapshots.close();
+        m_thread.join();
+        m_snapshots.reopen();
+    }
+
+    void Simulation::setThreaded(bool _threaded)
+    {
+        if (!_threaded) stop();
+        m_threaded = _threaded;
+    }
+
+    void Simulation::setInput(const InputHandler::Movement& _movement)
+    {
+        m_input.back() = _movement;
+        m_input.publish();
+    }
+
+    const SceneSnapshot& Simulation::nextSnapshot()
+    {
+        if (m_threaded)
+        {
+            if (!m_thread.joinable())
+                m_thread = std::thread(&Simulation::run, this);
+            m_snapshots.waitForPublish();
+            m_snapshots.take();
+        }
+        else if (!m_snapshots.take()) // One may be left over from the thread
+        {
+            step();
+            m_snapshots.take();
+        }
+        return m_snapshots.front();
+    }
+
+    void Simulation::apply(const SceneSnapshot& _snapshot, GameObject::Map& _objects) const
+    {
+        GameObject* objects = _objects.data();
+        for (size_t i = 0; i < _snapshot.m_transforms.size(); i++)
+            objects[m_dynamic[i]].m_transform = _snapshot.m_transforms[i];
+    }
+
+    void Simulation::run()
+    {
+        // Waiting for each step to be taken keeps the thread one step ahead of the render thread
+        while (m_snapshots.waitUntilTaken())
+            step();
+    }
+
+    void Simulation::step()
+    {
+        const Clock::time_point now = Clock::now();
+        const float deltaTime = m_firstStep ? 0.0f : std::chrono::duration<float, std::chrono::seconds::period>(now - m_lastStep).count();
+        m_lastStep = now;
+
+        // Camera
+        m_input.take();
+        if (m_sceneType == SceneTester::SceneType::CameraPan)
+            m_panController.update(deltaTime, m_viewer);
+        else
+            InputHandler::moveInPlaneXZ(m_input.front(), deltaTime, m_viewer);
+
+        SceneSnapshot& snapshot = m_snapshots.back();
+        snapshot.m_deltaTime = deltaTime;
+        const glm::mat4 prevView = m_camera.getViewMatrix();
+        m_camera.setViewYXZ(m_viewer.m_translation, m_viewer.m_rotation);
+        snapshot.m_prevView = m_firstStep ? m_camera.getViewMatrix() : prevView;
+        snapshot.m_camera = m_camera;
+
+        // Scene
+        if (m_sceneType == SceneTester::SceneType::MovingScene)
+            m_loader.updateMovingScene(deltaTime, m_transforms);
+
+        if (m_sceneType != SceneTester::SceneType::CameraPan)
+        {
+            const glm::mat4 rotateLight = glm::rotate(glm::mat4(1.0f), deltaTime, glm::vec3(0.0f, -1.0f, 0.0f));
+            for (uint32_t light : m_lights)
+                m_transforms[light].m_translation = glm::vec3(rotateLight * glm::vec4(m_transforms[light].m_translation, 1.0f));
+        }
+
+        // Each moved object's previous matrix is the one computed last step, not recomputed
+        snapshot.m_transforms.resize(m_dynamic.size());
+        for (size_t i = 0; i < m_dynamic.size(); i++)
+        {
+            TransformComponent& transform = m_transforms[m_dynamic[i]];
+            transform.m_prevModelMatrix = m_dynamicModels[i];
+            m_dynamicModels[i] = transform.mat4();
+            snapshot.m_transforms[i] = transform;
+        }
+
+        m_firstStep = false;
+        m_snapshots.publish();
+    }
+}
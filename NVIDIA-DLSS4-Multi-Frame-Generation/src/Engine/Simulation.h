@@ -0,0 +1,87 @@
+#pragma once
+#include "Camera.h"
+#include "InputHandler.h"
+#include "SceneTester.h"
+#include "TripleBuffer.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+    // What the render thread needs from one simulation step
+    struct SceneSnapshot
+    {
+        float m_deltaTime = 0.0f;     // Simulated time since the previous step
+        Camera m_camera;              // View only, the render thread sets the projection for its swap chain
+        glm::mat4 m_prevView{ 1.0f }; // View of the previous step
+        // Objects the simulation moves, in the order of Simulation::dynamicObjects(). Their
+        // m_prevModelMatrix is the model matrix of the previous step
+        std::vector<TransformComponent> m_transforms;
+    };
+
+    /*
+     * Camera movement, moving scene objects and orbiting lights, stepped on a thread of their own
+     * so the next frame is simulated while the render thread records the current one. Each step
+     * works on the simulation's own copy of the scene's transforms and publishes a SceneSnapshot
+     * through a TripleBuffer. The thread runs at most one step ahead of the render thread, so
+     * every step is rendered and consecutive snapshots give the previous and current matrices.
+     * The scene's GameObjects are only ever touched by the main thread, in apply().
+     */
+    struct Simulation
+    {
+        Simulation(SceneTester::SceneLoader& _loader, SceneTester::CameraPanController& _panController);
+        ~Simulation();
+
+        Simulation(const Simulation&) = delete;
+        Simulation& operator=(const Simulation&) = delete;
+
+        // Main thread. Takes over _objects' transforms after a scene load. Stop the simulation before
+        // loading, the loader's movers are stepped by it. Objects it doesn't move keep their previous
+        // model matrix at their current one
+        void reset(GameObject::Map& _objects);
+        // Main thread. Joins the simulation thread, nextSnapshot() starts it again
+        void stop();
+
+        bool isThreaded() const { return m_threaded; }
+        // Off steps the simulation on the main thread inside nextSnapshot()
+        void setThreaded(bool _threaded);
+
+        // Main thread. Input for the next step
+        void setInput(const InputHandler::Movement& _movement);
+        // Main thread. The next step. Threaded, this waits for the step simulated while the previous
+        // frame was recorded, which lets the thread start on the one after
+        const SceneSnapshot& nextSnapshot();
+        // Main thread. Writes a snapshot's transforms into the scene's objects
+        void apply(const SceneSnapshot& _snapshot, GameObject::Map& _objects) const;
+
+        // Dense indices of the objects in SceneSnapshot::m_transforms
+        const std::vector<uint32_t>& dynamicObjects() const { return m_dynamic; }
+
+    private:
+        using Clock = std::chrono::high_resolution_clock;
+
+        void run();
+        void step();
+
+        SceneTester::SceneLoader& m_loader;
+        SceneTester::CameraPanController& m_panController;
+        bool m_threaded = true;
+        std::thread m_thread;
+
+        TripleBuffer<SceneSnapshot> m_snapshots;
+        TripleBuffer<InputHandler::Movement> m_input;
+
+        // Owned by the simulation thread while it runs. Only reset() changes the object lists
+        SceneTester::SceneType m_sceneType = SceneTester::SceneType::CameraPan;
+        std::vector<TransformComponent> m_transforms; // Every object, indexed like the scene's dense storage
+        std::vector<uint32_t> m_dynamic;              // Objects the simulation moves, ascending
+        std::vector<glm::mat4> m_dynamicModels;       // Their model matrices as of the last step
+        std::vector<uint32_t> m_lights;               // Point lights, which orbit outside the camera pan scene
+        TransformComponent m_viewer;
+        Camera m_camera;
+        bool m_firstStep = true;
+        Clock::time_point m_lastStep;
+    };
+}
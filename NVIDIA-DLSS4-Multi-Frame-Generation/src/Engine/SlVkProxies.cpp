@@ -34,6 +34,8 @@ namespace Engine
 
     void SlVkProxies::resolve(VkInstance _instance, VkDevice _device)
     {
+        m_vkWaitForPresentKHR = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(_device, "vkWaitForPresentKHR"));
+
         if (!m_enabled) return;
 
         m_vkCreateSwapchainKHRProxy = reinterpret_cast<PFN_vkCreateSwapchainKHR>(m_vkGetDeviceProcAddrProxy(_device, "vkCreateSwapchainKHR"));
@@ -42,6 +44,7 @@ namespace Engine
         m_vkAcquireNextImageKHRProxy = reinterpret_cast<PFN_vkAcquireNextImageKHR>(m_vkGetDeviceProcAddrProxy(_device, "vkAcquireNextImageKHR"));
         m_vkQueuePresentKHRProxy = reinterpret_cast<PFN_vkQueuePresentKHR>(m_vkGetDeviceProcAddrProxy(_device, "vkQueuePresentKHR"));
         m_vkGetDeviceQueueProxy = reinterpret_cast<PFN_vkGetDeviceQueue>(m_vkGetDeviceProcAddrProxy(_device, "vkGetDeviceQueue"));
+        m_vkWaitForPresentKHRProxy = reinterpret_cast<PFN_vkWaitForPresentKHR>(m_vkGetDeviceProcAddrProxy(_device, "vkWaitForPresentKHR"));
 
         m_vkCreateDeviceProxy = reinterpret_cast<PFN_vkCreateDevice>(m_vkGetInstanceProcAddrProxy(_instance, "vkCreateDevice"));
         m_vkCreateInstanceProxy = reinterpret_cast<PFN_vkCreateInstance>(m_vkGetInstanceProcAddrProxy(_instance, "vkCreateInstance"));
@@ -96,4 +99,14 @@ namespace Engine
         if (m_enabled && m_vkGetDeviceQueueProxy) { m_vkGetDeviceQueueProxy(_device, _queueFamilyIndex, _queueIndex, _pQueue); return; }
         vkGetDeviceQueue(_device, _queueFamilyIndex, _queueIndex, _pQueue);
     }
+
+    VkResult SlVkProxies::WaitForPresentKHR(VkDevice _device,
+        VkSwapchainKHR _swapchain,
+        uint64_t _presentId,
+        uint64_t _timeout)
+    {
+        if (m_enabled && m_vkWaitForPresentKHRProxy) return m_vkWaitForPresentKHRProxy(_device, _swapchain, _presentId, _timeout);
+        if (m_vkWaitForPresentKHR) return m_vkWaitForPresentKHR(_device, _swapchain, _presentId, _timeout);
+        return VK_ERROR_EXTENSION_NOT_PRESENT;
+    }
 }
\ No newline at end of file
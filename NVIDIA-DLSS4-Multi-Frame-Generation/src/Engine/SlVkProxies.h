@@ -15,6 +15,8 @@ namespace Engine
         PFN_vkAcquireNextImageKHR m_vkAcquireNextImageKHRProxy = nullptr;
         PFN_vkQueuePresentKHR m_vkQueuePresentKHRProxy = nullptr;
         PFN_vkGetDeviceQueue m_vkGetDeviceQueueProxy = nullptr;
+        PFN_vkWaitForPresentKHR m_vkWaitForPresentKHRProxy = nullptr;
+        PFN_vkWaitForPresentKHR m_vkWaitForPresentKHR = nullptr; // Extension entry point, not exported by the loader
 
         PFN_vkCreateDevice m_vkCreateDeviceProxy = nullptr;
         PFN_vkCreateInstance m_vkCreateInstanceProxy = nullptr;
@@ -54,6 +56,11 @@ namespace Engine
             VkQueue* _pQueue);
 
         VkResult QueuePresentKHR(VkQueue _queue, const VkPresentInfoKHR* _presentInfo);
+
+        VkResult WaitForPresentKHR(VkDevice _device,
+            VkSwapchainKHR _swapchain,
+            uint64_t _presentId,
+            uint64_t _timeout);
     };
     extern SlVkProxies g_slvk;
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Engine
+{
+    // Stable handle into a SlotMap. The generation makes handles to erased objects invalid
+    struct SlotKey
+    {
+        uint32_t m_index = UINT32_MAX;
+        uint32_t m_generation = 0;
+
+        bool isValid() const { return m_index != UINT32_MAX; }
+        bool operator==(const SlotKey& _other) const { return m_index == _other.m_index && m_generation == _other.m_generation; }
+        bool operator!=(const SlotKey& _other) const { return !(*this == _other); }
+    };
+
+    /*
+     * Generational slot map. Values live densely packed in one vector so iterating
+     * walks contiguous memory, while keys stay valid across inserts and erases.
+     * Erasing swaps the last value into the hole, so iteration order is not stable.
+     */
+    template<typename T>
+    struct SlotMap
+    {
+        using iterator = typename std::vector<T>::iterator;
+        using const_iterator = typename std::vector<T>::const_iterator;
+
+        SlotKey insert(T&& _value)
+        {
+            uint32_t slotIndex;
+            if (m_freeHead != UINT32_MAX)
+            {
+                slotIndex = m_freeHead;
+                m_freeHead = m_slots[slotIndex].m_denseIndex; // Free slots chain through m_denseIndex
+            }
+            else
+            {
+                slotIndex = static_cast<uint32_t>(m_slots.size());
+                m_slots.push_back({});
+            }
+
+            Slot& slot = m_slots[slotIndex];
+            slot.m_denseIndex = static_cast<uint32_t>(m_values.size());
+
+            m_values.push_back(std::move(_value));
+            m_denseToSlot.push_back(slotIndex);
+
+            return SlotKey{ slotIndex, slot.m_generation };
+        }
+
+        template<typename... Args>
+        SlotKey emplace(Args&&... _args) { return insert(T(std::forward<Args>(_args)...)); }
+
+        bool erase(SlotKey _key)
+        {
+            if (!contains(_key)) return false;
+
+            Slot& slot = m_slots[_key.m_index];
+            uint32_t denseIndex = slot.m_denseIndex;
+            uint32_t lastIndex = static_cast<uint32_t>(m_values.size() - 1);
+
+            // Fill the hole with the last value to keep storage dense
+            if (denseIndex != lastIndex)
+            {
+                m_values[denseIndex] = std::move(m_values[lastIndex]);
+                m_denseToSlot[denseIndex] = m_denseToSlot[lastIndex];
+                m_slots[m_denseToSlot[denseIndex]].m_denseIndex = denseIndex;
+            }
+            m_values.pop_back();
+            m_denseToSlot.pop_back();
+
+            slot.m_generation++;
+            slot.m_denseIndex = m_freeHead;
+            m_freeHead = _key.m_index;
+            return true;
+        }
+
+        bool contains(SlotKey _key) const
+        {
+            return _key.m_index < m_slots.size() && m_slots[_key.m_index].m_generation == _key.m_generation &&
+                   m_slots[_key.m_index].m_denseIndex < m_values.size() && m_denseToSlot[m_slots[_key.m_index].m_denseIndex] == _key.m_index;
+        }
+
+        T* get(SlotKey _key) { return contains(_key) ? &m_values[m_slots[_key.m_index].m_denseIndex] : nullptr; }
+        const T* get(SlotKey _key) const { return contains(_key) ? &m_values[m_slots[_key.m_index].m_denseIndex] : nullptr; }
+
+        T& at(SlotKey _key)
+        {
+            if (!contains(_key)) throw std::out_of_range("SlotMap key is stale or invalid!");
+            return m_values[m_slots[_key.m_index].m_denseIndex];
+        }
+        const T& at(SlotKey _key) const
+        {
+            if (!contains(_key)) throw std::out_of_range("SlotMap key is stale or invalid!");
+            return m_values[m_slots[_key.m_index].m_denseIndex];
+        }
+
+        // Key of the value at a dense position, for walking values and keys together
+        SlotKey keyAt(size_t _denseIndex) const
+        {
+            uint32_t slotIndex = m_denseToSlot[_denseIndex];
+            return SlotKey{ slotIndex, m_slots[slotIndex].m_generation };
+        }
+
+        void reserve(size_t _count)
+        {
+            m_values.reserve(_count);
+            m_denseToSlot.reserve(_count);
+            m_slots.reserve(_count);
+        }
+
+        // Invalidates every key handed out so far
+        void clear()
+        {
+            for (uint32_t denseIndex = 0; denseIndex < m_denseToSlot.size(); denseIndex++)
+            {
+                uint32_t slotIndex = m_denseToSlot[denseIndex];
+                m_slots[slotIndex].m_generation++;
+                m_slots[slotIndex].m_denseIndex = m_freeHead;
+                m_freeHead = slotIndex;
+            }
+            m_values.clear();
+            m_denseToSlot.clear();
+        }
+
+        size_t size() const { return m_values.size(); }
+        bool empty() const { return m_values.empty(); }
+
+        T* data() { return m_values.data(); }
+        const T* data() const { return m_values.data(); }
+        iterator begin() { return m_values.begin(); }
+        iterator end() { return m_values.end(); }
+        const_iterator begin() const { return m_values.begin(); }
+        const_iterator end() const { return m_values.end(); }
+
+    private:
+        struct Slot
+        {
+            uint32_t m_denseIndex = UINT32_MAX; // Next free slot while the slot is unused
+            uint32_t m_generation = 0;
+        };
+
+        std::vector<T> m_values;
+        std::vector<uint32_t> m_denseToSlot;
+        std::vector<Slot> m_slots;
+        uint32_t m_freeHead = UINT32_MAX;
+    };
+}
@@ -2,7 +2,9 @@
 
 #include "FrameGenerationHandler.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -13,14 +15,18 @@
 
 namespace Engine
 {
-    SwapChain::SwapChain(EngineDevice& _deviceRef, VkExtent2D _extent, SlVkProxies& _slProxies)
-        : m_device(_deviceRef), m_windowExtent(_extent), m_slProxies(_slProxies)
+    SwapChain::SwapChain(EngineDevice& _deviceRef, VkExtent2D _extent, const Settings& _settings, SlVkProxies& _slProxies)
+        : m_device(_deviceRef), m_windowExtent(_extent), m_slProxies(_slProxies),
+          m_framesInFlight(std::clamp<uint32_t>(_settings.m_framesInFlight, 1, MAX_FRAMES_IN_FLIGHT)),
+          m_requestedPresentMode(_settings.m_presentMode), m_reuseRenderTargets(_settings.m_reuseRenderTargets)
     {
         init();
     }
 
-    SwapChain::SwapChain(EngineDevice& _deviceRef, VkExtent2D _windowExtent, std::shared_ptr<SwapChain> _previous, SlVkProxies& _slProxies)
-        : m_device(_deviceRef), m_windowExtent(_windowExtent), m_oldSwapChain(_previous), m_slProxies(_slProxies)
+    SwapChain::SwapChain(EngineDevice& _deviceRef, VkExtent2D _windowExtent, const Settings& _settings, std::shared_ptr<SwapChain> _previous, SlVkProxies& _slProxies)
+        : m_device(_deviceRef), m_windowExtent(_windowExtent), m_oldSwapChain(_previous), m_slProxies(_slProxies),
+          m_framesInFlight(std::clamp<uint32_t>(_settings.m_framesInFlight, 1, MAX_FRAMES_IN_FLIGHT)),
+          m_requestedPresentMode(_settings.m_presentMode), m_reuseRenderTargets(_settings.m_reuseRenderTargets)
     {
         init();
 
@@ -31,81 +37,146 @@ namespace Engine
     {
         createSwapChain();
         createImageViews();
-        createRenderPass();
-        createDepthResources();
-        createMotionVectorResources();
+        if (!adoptRenderPass())
+            createRenderPass();
+        if (!adoptRenderTargets())
+        {
+            m_renderTargetExtent = renderTargetExtentFor(m_swapChainExtent);
+            createSceneColourResources();
+            createDepthResources();
+            createMotionVectorResources();
+        }
         createFramebuffers();
         createSyncObjects();
     }
 
-    SwapChain::~SwapChain() 
+    bool SwapChain::adoptRenderPass()
     {
-        // Destroy swap chain resources
-        for (auto imageView : m_swapChainImageViews)
-        {
-            vkDestroyImageView(m_device.device(), imageView, nullptr);
-        }
-        m_swapChainImageViews.clear();
+        if (m_oldSwapChain == nullptr || !m_reuseRenderTargets) return false;
 
-        if (m_swapChain != nullptr) 
-        {
-            //vkDestroySwapchainKHR(m_device.device(), m_swapChain, nullptr);
-            m_slProxies.DestroySwapchainKHR(m_device.device(), m_swapChain, nullptr);
-            m_swapChain = nullptr;
-        }
+        // Attachment formats are all the render pass depends on, not the extent
+        SwapChain& old = *m_oldSwapChain;
+        if (old.m_swapChainImageFormat != m_swapChainImageFormat || old.m_renderPass == VK_NULL_HANDLE) return false;
 
-        // Destroy depth resources
-        for (int i = 0; i < m_depthImages.size(); i++) 
-        {
-            vkDestroyImageView(m_device.device(), m_depthImageViews[i], nullptr);
-            vkDestroyImage(m_device.device(), m_depthImages[i], nullptr);
-            vkFreeMemory(m_device.device(), m_depthImageMemories[i], nullptr);
-        }
+        m_renderPass = old.m_renderPass;
+        old.m_renderPass = VK_NULL_HANDLE; // The old swap chain's destructor must not release it
+        return true;
+    }
 
-        // Destroy MV resources
-        for (size_t i = 0; i < m_motionVectorImageViews.size(); ++i)
-        {
-            vkDestroyImageView(m_device.device(), m_motionVectorImageViews[i], nullptr);
-        }
-        for (size_t i = 0; i < m_motionVectorImages.size(); ++i)
-        {
-            vkDestroyImage(m_device.device(), m_motionVectorImages[i], nullptr);
-            vkFreeMemory(m_device.device(), m_motionVectorImageMemories[i], nullptr);
-        }
+    bool SwapChain::adoptRenderTargets()
+    {
+        if (m_oldSwapChain == nullptr || !m_reuseRenderTargets) return false;
+
+        // Images stay when the new extent fits, unless it shrank enough that most of their memory would go unused
+        SwapChain& old = *m_oldSwapChain;
+        const VkExtent2D capacity = old.m_renderTargetExtent;
+        const bool fits = m_swapChainExtent.width <= capacity.width && m_swapChainExtent.height <= capacity.height;
+        const bool oversized = m_swapChainExtent.width * 2 < capacity.width || m_swapChainExtent.height * 2 < capacity.height;
+        if (!fits || oversized || old.m_depthImages.size() != m_swapChainImages.size() || old.m_swapChainImageFormat != m_swapChainImageFormat)
+            return false;
+
+        // Render targets stay tied to their image index, so the frames that last used each one come along
+        m_renderTargetExtent = capacity;
+        m_allocatedRenderTargets = false;
+        m_swapChainDepthFormat = old.m_swapChainDepthFormat;
+        m_sceneColourImages = std::move(old.m_sceneColourImages);
+        m_sceneColourImageMemories = std::move(old.m_sceneColourImageMemories);
+        m_sceneColourImageViews = std::move(old.m_sceneColourImageViews);
+        m_depthImages = std::move(old.m_depthImages);
+        m_depthImageMemories = std::move(old.m_depthImageMemories);
+        m_depthImageViews = std::move(old.m_depthImageViews);
+        m_motionVectorImages = std::move(old.m_motionVectorImages);
+        m_motionVectorImageMemories = std::move(old.m_motionVectorImageMemories);
+        m_motionVectorImageViews = std::move(old.m_motionVectorImageViews);
+        m_imagesInFlight = std::move(old.m_imagesInFlight);
+
+        old.m_sceneColourImages.clear();
+        old.m_sceneColourImageMemories.clear();
+        old.m_sceneColourImageViews.clear();
+        old.m_depthImages.clear();
+        old.m_depthImageMemories.clear();
+        old.m_depthImageViews.clear();
+        old.m_motionVectorImages.clear();
+        old.m_motionVectorImageMemories.clear();
+        old.m_motionVectorImageViews.clear();
+        return true;
+    }
 
-        // Destroy frame buffers
-        for (auto framebuffer : m_swapChainFramebuffers)
-        {
-            vkDestroyFramebuffer(m_device.device(), framebuffer, nullptr);
-        }
-        
-        // Destroy renderPass
-        vkDestroyRenderPass(m_device.device(), m_renderPass, nullptr);
+    VkExtent2D SwapChain::renderTargetExtentFor(VkExtent2D _extent) const
+    {
+        // The first swap chain gets exact sizes. Once the window is being resized, round up so
+        // the next few size changes fit into what is already allocated
+        if (m_oldSwapChain == nullptr || !m_reuseRenderTargets) return _extent;
 
-        // cleanup synchronization objects
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) 
-        {
-            vkDestroySemaphore(m_device.device(), m_renderFinishedSemaphores[i], nullptr);
-            vkDestroySemaphore(m_device.device(), m_imageAvailableSemaphores[i], nullptr);
-            vkDestroyFence(m_device.device(), m_inFlightFences[i], nullptr);
-        }
+        auto roundUp = [](uint32_t _size) { return (_size + RENDER_TARGET_GRANULARITY - 1) / RENDER_TARGET_GRANULARITY * RENDER_TARGET_GRANULARITY; };
+        return { roundUp(_extent.width), roundUp(_extent.height) };
+    }
+
+    SwapChain::~SwapChain() 
+    {
+        // Frames still in flight reference these, so everything is parked until they retire
+        // instead of draining the GPU on every resize
+        VkDevice device = m_device.device();
+
+        m_device.deferDestroy([device, 
+            swapChain = m_swapChain,
+            imageViews = std::move(m_swapChainImageViews),
+            sceneColourViews = std::move(m_sceneColourImageViews),
+            depthViews = std::move(m_depthImageViews),
+            motionVectorViews = std::move(m_motionVectorImageViews),
+            framebuffers = std::move(m_swapChainFramebuffers),
+            renderPass = m_renderPass,
+            renderFinished = std::move(m_renderFinishedSemaphores),
+            imageAvailable = std::move(m_imageAvailableSemaphores),
+            &slProxies = m_slProxies]()
+            {
+                for (auto framebuffer : framebuffers)
+                    vkDestroyFramebuffer(device, framebuffer, nullptr);
+                for (auto imageView : imageViews)
+                    vkDestroyImageView(device, imageView, nullptr);
+                for (auto imageView : sceneColourViews)
+                    vkDestroyImageView(device, imageView, nullptr);
+                for (auto imageView : depthViews)
+                    vkDestroyImageView(device, imageView, nullptr);
+                for (auto imageView : motionVectorViews)
+                    vkDestroyImageView(device, imageView, nullptr);
+
+                if (swapChain != nullptr)
+                    slProxies.DestroySwapchainKHR(device, swapChain, nullptr);
+
+                if (renderPass != VK_NULL_HANDLE)
+                    vkDestroyRenderPass(device, renderPass, nullptr);
+
+                // Sync objects handed to a newer swap chain are no longer in these lists
+                for (auto semaphore : renderFinished)
+                    vkDestroySemaphore(device, semaphore, nullptr);
+                for (auto semaphore : imageAvailable)
+                    vkDestroySemaphore(device, semaphore, nullptr);
+            });
+        m_swapChain = nullptr;
+
+        // Render target memory goes through the device so the registry sees it released
+        for (size_t i = 0; i < m_sceneColourImages.size(); i++)
+            m_device.destroyImage(m_sceneColourImages[i], m_sceneColourImageMemories[i]);
+        for (size_t i = 0; i < m_depthImages.size(); i++)
+            m_device.destroyImage(m_depthImages[i], m_depthImageMemories[i]);
+        for (size_t i = 0; i < m_motionVectorImages.size(); i++)
+            m_device.destroyImage(m_motionVectorImages[i], m_motionVectorImageMemories[i]);
     }
 
     VkResult SwapChain::acquireNextImage(uint32_t* _imageIndex) 
     {
-        vkWaitForFences(
-            m_device.device(),
-            1,
-            &m_inFlightFences[m_currentFrame],
-            VK_TRUE,
-            std::numeric_limits<uint64_t>::max()
-        );
+        // Throttles the CPU to m_framesInFlight frames ahead. Slots cycle through all MAX_FRAMES_IN_FLIGHT,
+        // so the frame that last used this slot is at least as old and has retired too
+        uint64_t frame = m_device.currentFrame();
+        if (frame >= m_framesInFlight)
+            m_device.waitForFrame(frame - m_framesInFlight);
 
         VkResult result = m_slProxies.AcquireNextImageKHR(
             m_device.device(),
             m_swapChain,
             std::numeric_limits<uint64_t>::max(),
-            m_imageAvailableSemaphores[m_currentFrame],  // must be a not signaled semaphore
+            m_imageAvailableSemaphores[frameSlot()],  // must be a not signaled semaphore
             VK_NULL_HANDLE,
             _imageIndex
         );
@@ -113,68 +184,110 @@ namespace Engine
         return result;
     }
 
-    VkResult SwapChain::submitCommandBuffers(const VkCommandBuffer* _buffers, uint32_t* _imageIndex, FrameGenerationHandler* _frameGen)
+    VkResult SwapChain::submitCommandBuffers(const VkCommandBuffer* _buffers, uint32_t* _imageIndex, FrameGenerationHandler* _frameGen, PresentThread& _presentThread)
     {
-        if (m_imagesInFlight[*_imageIndex] != VK_NULL_HANDLE)
-        {
-            vkWaitForFences(m_device.device(), 1, &m_imagesInFlight[*_imageIndex], VK_TRUE, UINT64_MAX);
-        }
-        m_imagesInFlight[*_imageIndex] = m_inFlightFences[m_currentFrame];
+        // Depth and motion vectors are per image, so an older frame still drawing to this image must finish first
+        uint64_t frame = m_device.currentFrame();
+        if (m_imagesInFlight[*_imageIndex] != UINT64_MAX)
+            m_device.waitForFrame(m_imagesInFlight[*_imageIndex]);
+        m_imagesInFlight[*_imageIndex] = frame;
 
         VkSubmitInfo submitInfo = {};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-        VkSemaphore waitSemaphores[] = { m_imageAvailableSemaphores[m_currentFrame] };
-        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+        VkSemaphore waitSemaphores[] = { m_imageAvailableSemaphores[frameSlot()] };
+        // The swap chain image is first touched by the scale after the scene, which can be drawn before it is acquired
+        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_TRANSFER_BIT };
 
         submitInfo.waitSemaphoreCount = 1;
         submitInfo.pWaitSemaphores = waitSemaphores;
         submitInfo.pWaitDstStageMask = waitStages;
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = _buffers;
-        VkSemaphore signalSemaphores[] = { m_renderFinishedSemaphores[*_imageIndex] };
-        submitInfo.signalSemaphoreCount = 1;
+
+        // Present waits on the binary semaphore, the CPU and deferred deletion on the timeline
+        VkSemaphore signalSemaphores[] = { m_renderFinishedSemaphores[*_imageIndex], m_device.frameTimeline() };
+        uint64_t signalValues[] = { 0, EngineDevice::frameValue(frame) }; // Binary semaphores ignore their value
+        submitInfo.signalSemaphoreCount = 2;
         submitInfo.pSignalSemaphores = signalSemaphores;
 
-        vkResetFences(m_device.device(), 1, &m_inFlightFences[m_currentFrame]);
+        VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 2;
+        timelineInfo.pSignalSemaphoreValues = signalValues;
+        submitInfo.pNext = &timelineInfo;
 
         if (_frameGen) 
             _frameGen->reflexRenderSubmitStart(_frameGen->getFrameToken());
 
-        if (vkQueueSubmit(m_device.graphicsQueue(), 1, &submitInfo, m_inFlightFences[m_currentFrame]) != VK_SUCCESS) 
-            throw std::runtime_error("failed to submit draw command buffer!");
-
-        if (_frameGen)
-            _frameGen->reflexRenderSubmitEnd(_frameGen->getFrameToken());
-
-        VkPresentInfoKHR presentInfo = {};
-        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-
-        presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = signalSemaphores;
-
-        VkSwapchainKHR swapChains[] = { m_swapChain };
-        presentInfo.swapchainCount = 1;
-        presentInfo.pSwapchains = swapChains;
-        presentInfo.pImageIndices = _imageIndex;
-
-        if (_frameGen)
         {
-            _frameGen->reflexPresentStart(_frameGen->getFrameToken());
+            // Only long when a present, or another submit, holds the graphics queue
+            const auto lockStart = std::chrono::high_resolution_clock::now();
+            std::lock_guard<std::mutex> lock(m_device.queueMutex());
+            m_submitWaitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - lockStart).count();
+            if (vkQueueSubmit(m_device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) 
+                throw std::runtime_error("failed to submit draw command buffer!");
         }
 
-        auto result = m_slProxies.QueuePresentKHR(m_device.presentQueue(), &presentInfo);
-
         if (_frameGen)
-        {
-            _frameGen->reflexPresentEnd(_frameGen->getFrameToken());
-            if (result == VK_SUCCESS) _frameGen->markPresented();
-            _frameGen->updateState();
-        }
+            _frameGen->reflexRenderSubmitEnd(_frameGen->getFrameToken());
 
-        m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        // Present wait IDs are the frame's timeline value
+        PresentThread::Request request{};
+        request.m_swapChain = m_swapChain;
+        request.m_imageIndex = *_imageIndex;
+        request.m_waitSemaphore = m_renderFinishedSemaphores[*_imageIndex];
+        request.m_presentId = EngineDevice::frameValue(frame);
+        request.m_frameGen = _frameGen;
+        request.m_frameToken = _frameGen ? &_frameGen->getFrameToken() : nullptr;
+        return _presentThread.present(request);
+    }
 
-        return result;
+    void SwapChain::recordScaleToSwapChain(VkCommandBuffer _commandBuffer, uint32_t _imageIndex, VkImage _source, VkExtent2D _sourceExtent)
+    {
+        // The swap chain image's previous contents are of no use. Its acquire is waited on at the transfer stage
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = m_swapChainImages[_imageIndex];
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+            0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = { 0, 0, 0 };
+        blit.srcOffsets[1] = { static_cast<int32_t>(_sourceExtent.width), static_cast<int32_t>(_sourceExtent.height), 1 };
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = 0;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[0] = { 0, 0, 0 };
+        blit.dstOffsets[1] = { static_cast<int32_t>(m_swapChainExtent.width), static_cast<int32_t>(m_swapChainExtent.height), 1 };
+        blit.dstSubresource = blit.srcSubresource;
+
+        // At full scale this is a plain copy, converting the format if the source's differs
+        const bool native = _sourceExtent.width == m_swapChainExtent.width && _sourceExtent.height == m_swapChainExtent.height;
+        vkCmdBlitImage(_commandBuffer,
+            _source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            m_swapChainImages[_imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &blit, native ? VK_FILTER_NEAREST : VK_FILTER_LINEAR);
+
+        // Present waits on the submit's semaphore, which covers every stage
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+            0, nullptr, 0, nullptr, 1, &barrier);
     }
 
     void SwapChain::createSwapChain()
@@ -222,6 +335,7 @@ namespace Engine
         createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 
         createInfo.presentMode = presentMode;
+        m_presentMode = presentMode;
         createInfo.clipped = VK_TRUE;
 
         createInfo.oldSwapchain = m_oldSwapChain == nullptr ? VK_NULL_HANDLE : m_oldSwapChain->m_swapChain;
@@ -299,7 +413,7 @@ namespace Engine
         colourAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colourAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colourAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colourAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        colourAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; // Scaled onto the swap chain image next
 
         VkAttachmentReference colourAttachmentRef = {};
         colourAttachmentRef.attachment = 0;
@@ -320,6 +434,16 @@ namespace Engine
         dependency.srcAccessMask = 0;
         dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 
+        // The scene colour is read by the scale to the swap chain image, or by the upscaler
+        VkSubpassDependency scaleDependency = {};
+        scaleDependency.srcSubpass = 0;
+        scaleDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        scaleDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        scaleDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+        scaleDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        scaleDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        std::array<VkSubpassDependency, 2> dependencies = { dependency, scaleDependency };
         std::array<VkAttachmentDescription, 3> attachments = { colourAttachment, mvAttachment, depthAttachment };
         VkRenderPassCreateInfo renderPassInfo = {};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -327,8 +451,8 @@ namespace Engine
         renderPassInfo.pAttachments = attachments.data();
         renderPassInfo.subpassCount = 1;
         renderPassInfo.pSubpasses = &subpass;
-        renderPassInfo.dependencyCount = 1;
-        renderPassInfo.pDependencies = &dependency;
+        renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.data();
 
         if (vkCreateRenderPass(m_device.device(), &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS) 
             throw std::runtime_error("Failed to create render pass!");
@@ -339,16 +463,17 @@ namespace Engine
         m_swapChainFramebuffers.resize(imageCount());
         for (size_t i = 0; i < imageCount(); i++) 
         {
-            std::array<VkImageView, 3> attachments = { m_swapChainImageViews[i], m_motionVectorImageViews[i], m_depthImageViews[i] };
+            std::array<VkImageView, 3> attachments = { m_sceneColourImageViews[i], m_motionVectorImageViews[i], m_depthImageViews[i] };
 
-            VkExtent2D swapChainExtent = getSwapChainExtent();
+            // Sized to the render targets, each frame's render area picks how much of them it draws to
+            VkExtent2D renderTargetExtent = m_renderTargetExtent;
             VkFramebufferCreateInfo framebufferInfo = {};
             framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
             framebufferInfo.renderPass = m_renderPass;
             framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
             framebufferInfo.pAttachments = attachments.data();
-            framebufferInfo.width = swapChainExtent.width;
-            framebufferInfo.height = swapChainExtent.height;
+            framebufferInfo.width = renderTargetExtent.width;
+            framebufferInfo.height = renderTargetExtent.height;
             framebufferInfo.layers = 1;
 
             if (vkCreateFramebuffer(m_device.device(), &framebufferInfo, nullptr, &m_swapChainFramebuffers[i]) != VK_SUCCESS)
@@ -356,11 +481,57 @@ namespace Engine
         }
     }
 
+    void SwapChain::createSceneColourResources()
+    {
+        m_sceneColourImages.resize(imageCount());
+        m_sceneColourImageMemories.resize(imageCount());
+        m_sceneColourImageViews.resize(imageCount());
+
+        VkExtent2D extent = m_renderTargetExtent;
+
+        for (size_t i = 0; i < imageCount(); i++)
+        {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent = { extent.width, extent.height, 1 };
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.format = m_swapChainImageFormat;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            m_device.createImageWithInfo(
+                imageInfo,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                m_sceneColourImages[i],
+                m_sceneColourImageMemories[i],
+                ResourceTag::RenderTarget);
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = m_sceneColourImages[i];
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = m_swapChainImageFormat;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            if (vkCreateImageView(m_device.device(), &viewInfo, nullptr, &m_sceneColourImageViews[i]) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create scene colour image view!");
+        }
+    }
+
     void SwapChain::createDepthResources() 
     {
         VkFormat depthFormat = findDepthFormat();
         m_swapChainDepthFormat = depthFormat;
-        VkExtent2D swapChainExtent = getSwapChainExtent();
+        VkExtent2D swapChainExtent = m_renderTargetExtent;
 
         m_depthImages.resize(imageCount());
         m_depthImageMemories.resize(imageCount());
@@ -388,7 +559,8 @@ namespace Engine
                 imageInfo,
                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                 m_depthImages[i],
-                m_depthImageMemories[i]
+                m_depthImageMemories[i],
+                ResourceTag::RenderTarget
             );
 
             VkImageViewCreateInfo viewInfo{};
@@ -413,7 +585,7 @@ namespace Engine
         m_motionVectorImageMemories.resize(imageCount());
         m_motionVectorImageViews.resize(imageCount());
 
-        VkExtent2D extent = getSwapChainExtent();
+        VkExtent2D extent = m_renderTargetExtent;
 
         for (size_t i = 0; i < imageCount(); i++)
         {
@@ -434,7 +606,8 @@ namespace Engine
                 imageInfo,
                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                 m_motionVectorImages[i],
-                m_motionVectorImageMemories[i]);
+                m_motionVectorImageMemories[i],
+                ResourceTag::RenderTarget);
 
             VkImageViewCreateInfo viewInfo{};
             viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -456,21 +629,28 @@ namespace Engine
     {
         uint32_t imageCount = static_cast<uint32_t>(m_swapChainImages.size());
         
-        m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
         m_renderFinishedSemaphores.resize(imageCount);
-        m_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-        m_imagesInFlight.resize(imageCount, VK_NULL_HANDLE);
+        m_imagesInFlight.resize(imageCount, UINT64_MAX);
 
         VkSemaphoreCreateInfo semaphoreInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
-        VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        if (m_oldSwapChain != nullptr)
+        {
+            // Take over the per-slot acquire semaphores, a frame still in flight against the old swap chain
+            // may be waiting on one. Frame completion lives on the device timeline so nothing else carries over
+            m_imageAvailableSemaphores = std::move(m_oldSwapChain->m_imageAvailableSemaphores);
+            m_oldSwapChain->m_imageAvailableSemaphores.clear();
+        }
+        else
         {
-            if (vkCreateSemaphore(m_device.device(), &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[i]) != VK_SUCCESS ||
-                vkCreateFence(m_device.device(), &fenceInfo, nullptr, &m_inFlightFences[i]) != VK_SUCCESS)
+            m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+
+            for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
             {
-                throw std::runtime_error("failed to create sync objects for a frame!");
+                if (vkCreateSemaphore(m_device.device(), &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[i]) != VK_SUCCESS)
+                {
+                    throw std::runtime_error("failed to create sync objects for a frame!");
+                }
             }
         }
 
@@ -506,31 +686,49 @@ namespace Engine
 
     VkPresentModeKHR SwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& _availablePresentModes) 
     {
-        // Comment out both modes for FIFO:
-        /* +VSYNC BOUND, +GOOD FOR WEAKER DEVICES(MOLBILE), +ALWAYS SUPPORTED, -BAD LATENCY */
-
-        /* +LOW LATENCY, -NOT ALWAYS SUPPORTED, -HIGH POWER USAGE */
-        //for (const auto& availablePresentMode : _availablePresentModes) 
-        //{
-        //    if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) 
-        //    {
-        //        std::cout << "Present mode: Mailbox" << std::endl;
-        //        return availablePresentMode;
-        //    }
-        //}
-
-        /* +BEST FOR PERFORMANCE TESTING, +LOW LATENCY, -TEARING, -HIGH POWER USAGE */
-         for (const auto &availablePresentMode : _availablePresentModes) 
-         {
-           if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) 
-           {
-             std::cout << "Present mode: Immediate" << std::endl;
-             return availablePresentMode;
-           }
-         }
-
-        std::cout << "Present mode: V-Sync" << std::endl;
-        return VK_PRESENT_MODE_FIFO_KHR;
+        /* IMMEDIATE:    +BEST FOR PERFORMANCE TESTING, +LOW LATENCY, -TEARING, -HIGH POWER USAGE
+           MAILBOX:      +LOW LATENCY, +NO TEARING, -NOT ALWAYS SUPPORTED, -HIGH POWER USAGE
+           FIFO:         +VSYNC BOUND, +GOOD FOR WEAKER DEVICES(MOBILE), +ALWAYS SUPPORTED, -BAD LATENCY
+           FIFO_RELAXED: +VSYNC BOUND, +TEARS INSTEAD OF STUTTERING WHEN LATE, -NOT ALWAYS SUPPORTED */
+        auto supported = [&](VkPresentModeKHR _mode)
+        {
+            return std::find(_availablePresentModes.begin(), _availablePresentModes.end(), _mode) != _availablePresentModes.end();
+        };
+
+        // Unsupported modes fall back to the closest one: uncapped modes to each other, then to FIFO
+        std::vector<VkPresentModeKHR> candidates = { m_requestedPresentMode };
+        if (m_requestedPresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
+            candidates.push_back(VK_PRESENT_MODE_MAILBOX_KHR);
+        else if (m_requestedPresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+            candidates.push_back(VK_PRESENT_MODE_IMMEDIATE_KHR);
+
+        VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+        for (VkPresentModeKHR candidate : candidates)
+        {
+            if (supported(candidate))
+            {
+                presentMode = candidate;
+                break;
+            }
+        }
+
+        std::cout << "Present mode: " << presentModeName(presentMode);
+        if (presentMode != m_requestedPresentMode)
+            std::cout << " (" << presentModeName(m_requestedPresentMode) << " unsupported)";
+        std::cout << std::endl;
+        return presentMode;
+    }
+
+    const char* SwapChain::presentModeName(VkPresentModeKHR _presentMode)
+    {
+        switch (_presentMode)
+        {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "Immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "Mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR: return "V-Sync";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "V-Sync relaxed";
+        default: return "Unknown";
+        }
     }
 
     VkExtent2D SwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& _capabilities) 
@@ -1,5 +1,6 @@
 #pragma once
 #include "EngineDevice.h"
+#include "PresentThread.h"
 
 #include <vulkan/vulkan.h>
 #include <memory>
@@ -8,10 +9,26 @@ namespace Engine
 {
     struct SwapChain 
     {
-        static constexpr int MAX_FRAMES_IN_FLIGHT = 3;
+        // Per frame resources are sized for this many slots. How many frames the CPU may actually
+        // run ahead of the GPU is the swap chain's framesInFlight(), 1 to MAX_FRAMES_IN_FLIGHT
+        static constexpr int MAX_FRAMES_IN_FLIGHT = 4;
+        static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 3;
 
-        SwapChain(EngineDevice& _deviceRef, VkExtent2D _windowExtent, SlVkProxies& _slProxies);
-        SwapChain(EngineDevice& _deviceRef, VkExtent2D _windowExtent, std::shared_ptr<SwapChain> _previous, SlVkProxies& _slProxies);
+        struct Settings
+        {
+            uint32_t m_framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+            // Requested mode. Unsupported modes fall back to the nearest one that is, see chooseSwapPresentMode
+            VkPresentModeKHR m_presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            // Recreation keeps the previous render pass and pooled colour/depth/MV images when they still fit.
+            // Off rebuilds everything, as a baseline for the resize benchmark
+            bool m_reuseRenderTargets = true;
+        };
+
+        // Pooled render targets grow to a multiple of this, so a resize storm reallocates rarely
+        static constexpr uint32_t RENDER_TARGET_GRANULARITY = 256;
+
+        SwapChain(EngineDevice& _deviceRef, VkExtent2D _windowExtent, const Settings& _settings, SlVkProxies& _slProxies);
+        SwapChain(EngineDevice& _deviceRef, VkExtent2D _windowExtent, const Settings& _settings, std::shared_ptr<SwapChain> _previous, SlVkProxies& _slProxies);
         ~SwapChain();
 
         SwapChain(const SwapChain&) = delete;
@@ -23,14 +40,30 @@ namespace Engine
         size_t imageCount() { return m_swapChainImages.size(); }
         VkFormat getSwapChainImageFormat() { return m_swapChainImageFormat; }
         VkExtent2D getSwapChainExtent() { return m_swapChainExtent; }
+        // Allocated size of the scene colour, depth and MV images, at least the swap chain extent. Rendering
+        // only touches the top left, up to the render extent the frame was drawn at
+        VkExtent2D getRenderTargetExtent() const { return m_renderTargetExtent; }
+        // True if this swap chain rebuilt its render targets rather than taking over the previous ones
+        bool allocatedRenderTargets() const { return m_allocatedRenderTargets; }
         uint32_t width() { return m_swapChainExtent.width; }
         uint32_t height() { return m_swapChainExtent.height; }
+        uint32_t framesInFlight() const { return m_framesInFlight; }
+        VkPresentModeKHR presentMode() const { return m_presentMode; } // The mode actually in use
+        VkSwapchainKHR handle() const { return m_swapChain; }
+        static const char* presentModeName(VkPresentModeKHR _presentMode);
 
         float extentAspectRatio() { return static_cast<float>(m_swapChainExtent.width) / static_cast<float>(m_swapChainExtent.height); }
         VkFormat findDepthFormat();
 
         VkResult acquireNextImage(uint32_t* _imageIndex);
-        VkResult submitCommandBuffers(const VkCommandBuffer* _buffers, uint32_t* _imageIndex, FrameGenerationHandler* _frameGen);
+        // Records the scale of the top left _sourceExtent of _source, in TRANSFER_SRC_OPTIMAL, onto the whole swap chain
+        // image, leaving it ready to present. Outside a render pass. The source is the image's scene colour, or the
+        // upscaler's output when the scene was drawn below the swap chain extent
+        void recordScaleToSwapChain(VkCommandBuffer _commandBuffer, uint32_t _imageIndex, VkImage _source, VkExtent2D _sourceExtent);
+        // Submits, then hands the present to _presentThread, which runs it inline unless enabled
+        VkResult submitCommandBuffers(const VkCommandBuffer* _buffers, uint32_t* _imageIndex, FrameGenerationHandler* _frameGen, PresentThread& _presentThread);
+        // Time the last submitCommandBuffers() waited for the graphics queue
+        double getSubmitWaitMs() const { return m_submitWaitMs; }
 
         bool compareSwapFormats(const SwapChain& _swapChain) const 
         {
@@ -41,6 +74,8 @@ namespace Engine
         // Getters for Streamline tagging
         VkImageView getSwapChainImageView(uint32_t _index) const { return m_swapChainImageViews[_index]; }
         VkImage getSwapChainImage(uint32_t _index) const { return m_swapChainImages[_index]; }
+        VkImage getSceneColourImage(uint32_t _index) const { return m_sceneColourImages[_index]; }
+        VkImageView getSceneColourImageView(uint32_t _index) const { return m_sceneColourImageViews[_index]; }
         VkImageView getDepthImageView(uint32_t _index) const { return m_depthImageViews[_index]; }
         VkDeviceMemory getDepthImageMemory(uint32_t _index) const { return m_depthImageMemories[_index]; }
         VkImage getDepthImage(uint32_t _index) const { return m_depthImages[_index]; }
@@ -52,11 +87,17 @@ namespace Engine
         void init();
         void createSwapChain();
         void createImageViews();
+        void createSceneColourResources();
         void createDepthResources();
         void createMotionVectorResources();
         void createRenderPass();
         void createFramebuffers();
         void createSyncObjects();
+        // Take over the previous swap chain's render pass when the colour format is unchanged, and its
+        // scene colour, depth and motion vector images while the new extent still fits them. False if they must be rebuilt
+        bool adoptRenderPass();
+        bool adoptRenderTargets();
+        VkExtent2D renderTargetExtentFor(VkExtent2D _extent) const;
 
         // Helper functions
         VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& _availableFormats);
@@ -66,10 +107,18 @@ namespace Engine
         VkFormat m_swapChainImageFormat;
         VkFormat m_swapChainDepthFormat;
         VkExtent2D m_swapChainExtent;
+        VkExtent2D m_renderTargetExtent;
+        bool m_allocatedRenderTargets = true;
+        double m_submitWaitMs = 0.0;
 
         std::vector<VkFramebuffer> m_swapChainFramebuffers;
         VkRenderPass m_renderPass;
 
+        // The scene is drawn here at the render extent, then scaled onto the swap chain image
+        std::vector<VkImage> m_sceneColourImages;
+        std::vector<VkDeviceMemory> m_sceneColourImageMemories;
+        std::vector<VkImageView> m_sceneColourImageViews;
+
         std::vector<VkImage> m_depthImages;
         std::vector<VkDeviceMemory> m_depthImageMemories;
         std::vector<VkImageView> m_depthImageViews;
@@ -84,14 +133,19 @@ namespace Engine
         SlVkProxies& m_slProxies;
         EngineDevice& m_device;
         VkExtent2D m_windowExtent;
+        uint32_t m_framesInFlight;
+        VkPresentModeKHR m_requestedPresentMode;
+        bool m_reuseRenderTargets;
+        VkPresentModeKHR m_presentMode = VK_PRESENT_MODE_FIFO_KHR;
 
         VkSwapchainKHR m_swapChain;
         std::shared_ptr<SwapChain> m_oldSwapChain;
 
+        // Frame completion is tracked on the device's frame timeline. Acquire and present still
+        // need binary semaphores, one per frame slot and one per image
         std::vector<VkSemaphore> m_imageAvailableSemaphores;
         std::vector<VkSemaphore> m_renderFinishedSemaphores;
-        std::vector<VkFence> m_inFlightFences;
-        std::vector<VkFence> m_imagesInFlight;
-        size_t m_currentFrame = 0;
+        std::vector<uint64_t> m_imagesInFlight; // Frame last rendered to each image and its render targets, UINT64_MAX if none
+        size_t frameSlot() { return m_device.currentFrame() % MAX_FRAMES_IN_FLIGHT; }
     };
 }
\ No newline at end of file
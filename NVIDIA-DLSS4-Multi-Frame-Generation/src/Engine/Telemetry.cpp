@@ -0,0 +1,153 @@
+#include "Telemetry.h"
+
+#include "FrameGenerationHandler.h"
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace Engine
+{
+    Telemetry::Telemetry(EngineDevice& _device, FrameGenerationHandler& _frameGen)
+        : m_device(_device), m_frameGen(_frameGen)
+    {}
+
+    void Telemetry::tick(float _deltaTime, GLFWwindow* _window, size_t _arenaHighWater, double _gpuSceneMs, double _latencyMs, double _submitWaitMs,
+        uint64_t _triangles)
+    {
+        m_accumTime += _deltaTime;
+        m_accumFrames += 1;
+        m_accumTriangles += _triangles;
+        m_accumLatencyMs += _latencyMs;
+        m_accumSubmitWaitMs += _submitWaitMs;
+        m_sectionTime += _deltaTime;
+        m_sectionFrames += 1;
+        m_sectionTriangles += _triangles;
+        m_sectionLatencyMs += _latencyMs;
+        m_sectionSubmitWaitMs += _submitWaitMs;
+
+        uint64_t allocations = AllocationCounter::totalAllocations();
+        m_frameAllocations = allocations - m_lastAllocationCount;
+        m_lastAllocationCount = allocations;
+        m_accumAllocations += m_frameAllocations;
+        m_maxFrameAllocations = std::max(m_maxFrameAllocations, m_frameAllocations);
+        m_arenaHighWater = _arenaHighWater;
+        if (_gpuSceneMs > 0.0)
+        {
+            m_accumGpuMs += _gpuSceneMs;
+            m_gpuSamples++;
+            m_sectionGpuMs += _gpuSceneMs;
+            m_sectionGpuSamples++;
+        }
+
+        if (m_accumTime >= 1.0)
+        {
+            updateTitle(_window);
+
+            m_accumTime = 0.0;
+            m_accumFrames = 0;
+            m_accumAllocations = 0;
+            m_maxFrameAllocations = 0;
+            m_accumGpuMs = 0.0;
+            m_gpuSamples = 0;
+            m_accumTriangles = 0;
+            m_accumLatencyMs = 0.0;
+            m_accumSubmitWaitMs = 0.0;
+            // Don't count the title update against the next frame
+            m_lastAllocationCount = AllocationCounter::totalAllocations();
+        }
+    }
+
+    int Telemetry::formatAllocations(char* _buffer, size_t _size) const
+    {
+        if (!AllocationCounter::isEnabled())
+        {
+            _buffer[0] = '\0';
+            return 0;
+        }
+
+        return std::snprintf(_buffer, _size, " | Heap allocs/frame: %.1f (max %llu) | Arena: %zu KB",
+            static_cast<double>(m_accumAllocations) / std::max<uint64_t>(m_accumFrames, 1),
+            static_cast<unsigned long long>(m_maxFrameAllocations), m_arenaHighWater / 1024);
+    }
+
+    void Telemetry::updateTitle(GLFWwindow* _window)
+    {
+        FrameStats frameStats{};
+        m_frameGen.getFrameStats(frameStats);
+
+        // Device local heaps are the ones that matter for render targets and assets
+        VkDeviceSize vramUsage = 0;
+        VkDeviceSize vramBudget = 0;
+        m_device.queryMemoryBudget(m_heaps);
+        for (const HeapBudget& heap : m_heaps)
+        {
+            if (!heap.m_deviceLocal) continue;
+            vramUsage += heap.m_usage;
+            vramBudget += heap.m_budget;
+        }
+        const double usageMB = static_cast<double>(vramUsage) / (1024.0 * 1024.0);
+        const double budgetMB = static_cast<double>(vramBudget) / (1024.0 * 1024.0);
+
+        char allocations[96];
+        formatAllocations(allocations, sizeof(allocations));
+
+        char gpu[128] = "";
+        const double triangles = static_cast<double>(m_accumTriangles) / std::max<uint64_t>(m_accumFrames, 1) / 1.0e6;
+        const double latencyMs = m_accumLatencyMs / std::max<uint64_t>(m_accumFrames, 1);
+        const double submitWaitMs = m_accumSubmitWaitMs / std::max<uint64_t>(m_accumFrames, 1);
+        if (m_gpuSamples > 0)
+            std::snprintf(gpu, sizeof(gpu), " | GPU: %.2f ms | Latency: %.1f ms | Submit wait: %.2f ms | Tris: %.2fM",
+                m_accumGpuMs / m_gpuSamples, latencyMs, submitWaitMs, triangles);
+        else
+            std::snprintf(gpu, sizeof(gpu), " | Latency: %.1f ms | Submit wait: %.2f ms | Tris: %.2fM", latencyMs, submitWaitMs, triangles);
+
+        char title[384];
+        if (frameStats.m_isFrameGenerationEnabled)
+        {
+            uint64_t genframes = m_accumFrames * frameStats.m_totalPresentedFrameCount;
+            uint64_t totalFrames = m_accumFrames + genframes;
+            double percentIncrease = (static_cast<double>(totalFrames - m_accumFrames) / m_accumFrames) * 100.0;
+
+            std::snprintf(title, sizeof(title),
+                "Vulkan Engine | Render: %llu FPS%s | Output: %llu FPS | FG: +%llu FPS (+%.0f%%) | VRAM: %.0f / %.0f MB%s",
+                static_cast<unsigned long long>(m_accumFrames), gpu, static_cast<unsigned long long>(totalFrames),
+                static_cast<unsigned long long>(genframes), percentIncrease, usageMB, budgetMB, allocations);
+        }
+        else
+        {
+            std::snprintf(title, sizeof(title),
+                "Vulkan Engine | Render: %llu FPS (FG off)%s | VRAM: %.0f / %.0f MB%s",
+                static_cast<unsigned long long>(m_accumFrames), gpu, usageMB, budgetMB, allocations);
+        }
+
+        glfwSetWindowTitle(_window, title);
+    }
+
+    void Telemetry::beginSection(const std::string& _label)
+    {
+        if (!m_sectionLabel.empty() && m_sectionFrames > 0)
+        {
+            std::printf("%s: %llu frames, %.2f ms/frame (%.1f FPS), latency %.2f ms, submit wait %.3f ms, GPU %.2f ms, %.3fM triangles/frame\n",
+                m_sectionLabel.c_str(), static_cast<unsigned long long>(m_sectionFrames), m_sectionTime * 1000.0 / m_sectionFrames,
+                m_sectionFrames / std::max(m_sectionTime, 1.0e-9), m_sectionLatencyMs / m_sectionFrames, m_sectionSubmitWaitMs / m_sectionFrames,
+                m_sectionGpuSamples > 0 ? m_sectionGpuMs / m_sectionGpuSamples : 0.0,
+                static_cast<double>(m_sectionTriangles) / m_sectionFrames / 1.0e6);
+        }
+
+        m_sectionLabel = _label;
+        m_sectionTime = 0.0;
+        m_sectionFrames = 0;
+        m_sectionGpuMs = 0.0;
+        m_sectionGpuSamples = 0;
+        m_sectionTriangles = 0;
+        m_sectionLatencyMs = 0.0;
+        m_sectionSubmitWaitMs = 0.0;
+    }
+
+    void Telemetry::dumpReport()
+    {
+        m_device.resourceRegistry().writeReport(std::cout, m_device.queryMemoryBudget());
+    }
+}
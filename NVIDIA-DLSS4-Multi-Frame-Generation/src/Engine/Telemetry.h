@@ -0,0 +1,67 @@
+#pragma once
+#include "EngineDevice.h"
+
+#include <string>
+
+namespace Engine
+{
+    struct FrameGenerationHandler;
+
+    /*
+     * Frame rate, GPU time, frame generation and memory stats, shown in the window
+     * title once per second. dumpReport() prints the full resource report.
+     */
+    struct Telemetry
+    {
+        Telemetry(EngineDevice& _device, FrameGenerationHandler& _frameGen);
+
+        Telemetry(const Telemetry&) = delete;
+        Telemetry& operator=(const Telemetry&) = delete;
+
+        void tick(float _deltaTime, GLFWwindow* _window, size_t _arenaHighWater, double _gpuSceneMs, double _latencyMs, double _submitWaitMs,
+            uint64_t _triangles);
+        void dumpReport();
+        // Global heap allocations during the frame of the last tick(), the title update excluded. 0 outside debug builds
+        uint64_t getFrameAllocations() const { return m_frameAllocations; }
+
+        // Prints the averages since the last section and starts a new one under _label.
+        // Used to compare settings such as LOD policies on the same scene
+        void beginSection(const std::string& _label);
+
+    private:
+        void updateTitle(GLFWwindow* _window);
+        int formatAllocations(char* _buffer, size_t _size) const;
+
+        EngineDevice& m_device;
+        FrameGenerationHandler& m_frameGen;
+
+        double m_accumTime = 0.0;
+        uint64_t m_accumFrames = 0;
+
+        // Reused every title update so the frame loop itself stays allocation free
+        std::vector<HeapBudget> m_heaps;
+
+        // Global heap allocations between ticks (debug builds only)
+        uint64_t m_lastAllocationCount = 0;
+        uint64_t m_accumAllocations = 0;
+        uint64_t m_maxFrameAllocations = 0;
+        uint64_t m_frameAllocations = 0;
+        size_t m_arenaHighWater = 0;
+
+        // Scene render pass GPU time, averaged over the frames that reported one
+        double m_accumGpuMs = 0.0;
+        uint64_t m_gpuSamples = 0;
+        uint64_t m_accumTriangles = 0;
+        double m_accumLatencyMs = 0.0;
+        double m_accumSubmitWaitMs = 0.0; // Shows whether submits queue up behind presents
+
+        std::string m_sectionLabel;
+        double m_sectionTime = 0.0;
+        uint64_t m_sectionFrames = 0;
+        double m_sectionGpuMs = 0.0;
+        uint64_t m_sectionGpuSamples = 0;
+        uint64_t m_sectionTriangles = 0;
+        double m_sectionLatencyMs = 0.0;
+        double m_sectionSubmitWaitMs = 0.0;
+    };
+}
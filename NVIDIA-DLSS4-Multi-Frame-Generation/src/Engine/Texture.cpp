@@ -1,9 +1,12 @@
 #include "Texture.h"
+#include "Ktx2File.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image/stb_image.h>
 
+#include <algorithm>
 #include <cmath>
+#include <filesystem>
 #include <stdexcept>
 
 namespace Engine
@@ -11,7 +14,18 @@ namespace Engine
     Texture::Texture(EngineDevice& _device, const std::string& _textureFilePath) :
         m_device(_device)
     {
-        createTextureImage(_textureFilePath);
+        SourceImage source;
+        loadSource(m_device, _textureFilePath, source);
+        createTextureImage(source);
+        createTextureImageView(VK_IMAGE_VIEW_TYPE_2D);
+        createTextureSampler();
+        updateDescriptor();
+    }
+
+    Texture::Texture(EngineDevice& _device, const SourceImage& _source) :
+        m_device(_device)
+    {
+        createTextureImage(_source);
         createTextureImageView(VK_IMAGE_VIEW_TYPE_2D);
         createTextureSampler();
         updateDescriptor();
@@ -54,7 +68,8 @@ namespace Engine
             imageInfo,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             m_textureImage,
-            m_textureImageMemory
+            m_textureImageMemory,
+            ResourceTag::RenderTarget
         );
 
         VkImageViewCreateInfo viewInfo{};
@@ -102,10 +117,13 @@ namespace Engine
 
     Texture::~Texture() 
     {
-        vkDestroySampler(m_device.device(), m_textureSampler, nullptr);
-        vkDestroyImageView(m_device.device(), m_textureImageView, nullptr);
-        vkDestroyImage(m_device.device(), m_textureImage, nullptr);
-        vkFreeMemory(m_device.device(), m_textureImageMemory, nullptr);
+        m_device.deferDestroy([device = m_device.device(), sampler = m_textureSampler, baseLevelSampler = m_baseLevelSampler, imageView = m_textureImageView]()
+            {
+                vkDestroySampler(device, sampler, nullptr);
+                vkDestroySampler(device, baseLevelSampler, nullptr);
+                vkDestroyImageView(device, imageView, nullptr);
+            });
+        m_device.destroyImage(m_textureImage, m_textureImageMemory);
     }
 
     std::unique_ptr<Texture> Texture::createTextureFromFile(EngineDevice& _device, const std::string& _filepath) 
@@ -115,42 +133,93 @@ namespace Engine
 
     void Texture::updateDescriptor() 
     {
-        m_descriptor.sampler = m_textureSampler;
+        m_descriptor.sampler = m_mipmapsEnabled ? m_textureSampler : m_baseLevelSampler;
         m_descriptor.imageView = m_textureImageView;
         m_descriptor.imageLayout = m_textureLayout;
     }
 
-    void Texture::createTextureImage(const std::string& _filepath) 
+    void Texture::loadSource(EngineDevice& _device, const std::string& _filepath, SourceImage& _outSource, bool _preferKtx2)
     {
+        if (std::filesystem::path(_filepath).extension() == ".ktx2")
+        {
+            if (!openKtx2(_device, _filepath, _outSource))
+                throw std::runtime_error("failed to load texture image " + _filepath);
+            return;
+        }
+
+        // A converted KTX2 next to the source skips the decode, unless the source has changed since
+        const std::string ktx2Path = Ktx2File::pathFor(_filepath);
+        std::error_code error;
+        const auto ktx2Time = std::filesystem::last_write_time(ktx2Path, error);
+        if (_preferKtx2 && !error)
+        {
+            const auto sourceTime = std::filesystem::last_write_time(_filepath, error);
+            if ((error || ktx2Time >= sourceTime) && openKtx2(_device, ktx2Path, _outSource))
+                return;
+        }
+
         int texWidth, texHeight, texChannels;
         stbi_uc* pixels = stbi_load(_filepath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        VkDeviceSize imageSize = texWidth * texHeight * 4;
 
         if (!pixels) 
             throw std::runtime_error("failed to load texture image!");
 
-        m_mipLevels = 1;
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
+        _outSource.m_pixels = std::shared_ptr<uint8_t>(pixels, stbi_image_free);
+        _outSource.m_format = VK_FORMAT_R8G8B8A8_SRGB;
+        _outSource.m_extent = { static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1 };
+        _outSource.m_levels = { { pixels, static_cast<uint64_t>(texWidth) * texHeight * 4 } };
+    }
 
-        m_device.createBuffer(
-            imageSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory);
+    bool Texture::openKtx2(EngineDevice& _device, const std::string& _filepath, SourceImage& _outSource)
+    {
+        Ktx2File& file = _outSource.m_ktx2;
+        if (!file.open(_filepath)) return false;
+
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(_device.physicalDevice(), file.format(), &formatProperties);
+        if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) ||
+            (Ktx2File::isBlockCompressed(file.format()) && !_device.textureCompressionBCEnabled()))
+            return false;
+
+        _outSource.m_format = file.format();
+        _outSource.m_extent = { file.width(), file.height(), 1 };
+        _outSource.m_levels.resize(file.levelCount());
+        for (uint32_t level = 0; level < file.levelCount(); level++)
+            _outSource.m_levels[level] = file.level(level);
+        return true;
+    }
 
-        void* data;
-        vkMapMemory(m_device.device(), stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, pixels, static_cast<size_t>(imageSize));
-        vkUnmapMemory(m_device.device(), stagingBufferMemory);
+    void Texture::createTextureImage(const SourceImage& _source)
+    {
+        m_format = _source.m_format;
+        m_extent = _source.m_extent;
+
+        // Block compressed files ship their levels pre-built. A single uncompressed level gets
+        // the full chain down to 1x1, generated with linear blits when the format supports them
+        const uint32_t levelCount = static_cast<uint32_t>(_source.m_levels.size());
+        m_mipLevels = levelCount;
+        if (m_mipLevels == 1 && canBlitMipmaps(m_format))
+            m_mipLevels = fullMipCount();
+
+        createImage();
+        uploadLevels(_source.m_levels.data(), levelCount);
+    }
 
-        stbi_image_free(pixels);
+    bool Texture::canBlitMipmaps(VkFormat _format) const
+    {
+        constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(m_device.physicalDevice(), _format, &formatProperties);
+        return !Ktx2File::isBlockCompressed(_format) && (formatProperties.optimalTilingFeatures & required) == required;
+    }
 
-        m_format = VK_FORMAT_R8G8B8A8_SRGB;
-        m_extent = { static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1 };
+    uint32_t Texture::fullMipCount() const
+    {
+        return static_cast<uint32_t>(std::floor(std::log2(std::max(m_extent.width, m_extent.height)))) + 1;
+    }
 
+    void Texture::createImage()
+    {
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -168,37 +237,164 @@ namespace Engine
             imageInfo,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             m_textureImage,
-            m_textureImageMemory
-        );
-        m_device.transitionImageLayout(
-            m_textureImage,
-            VK_FORMAT_R8G8B8A8_SRGB,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            m_mipLevels,
-            m_layerCount
+            m_textureImageMemory,
+            ResourceTag::Texture
         );
-        m_device.copyBufferToImage(
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(m_device.device(), m_textureImage, &memoryRequirements);
+        m_memorySize = memoryRequirements.size;
+    }
+
+    void Texture::uploadLevels(const Ktx2File::Level* _levels, uint32_t _levelCount)
+    {
+        // Offsets into the staging buffer must be multiples of the texel block size
+        std::vector<VkDeviceSize> offsets(_levelCount);
+        VkDeviceSize stagingSize = 0;
+        for (uint32_t level = 0; level < _levelCount; level++)
+        {
+            offsets[level] = stagingSize;
+            stagingSize = (stagingSize + _levels[level].m_size + 15) & ~VkDeviceSize(15);
+        }
+
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+
+        m_device.createBuffer(
+            stagingSize,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
             stagingBuffer,
-            m_textureImage,
-            static_cast<uint32_t>(texWidth),
-            static_cast<uint32_t>(texHeight),
-            m_layerCount
-        );
+            stagingBufferMemory,
+            ResourceTag::Staging);
 
-        // Comment this out while using mips
-        m_device.transitionImageLayout(
-            m_textureImage,
-            VK_FORMAT_R8G8B8A8_SRGB,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            m_mipLevels,
-            m_layerCount);
+        void* data;
+        vkMapMemory(m_device.device(), stagingBufferMemory, 0, stagingSize, 0, &data);
+        for (uint32_t level = 0; level < _levelCount; level++)
+            memcpy(static_cast<uint8_t*>(data) + offsets[level], _levels[level].m_data, static_cast<size_t>(_levels[level].m_size));
+        vkUnmapMemory(m_device.device(), stagingBufferMemory);
+
+        // Upload and mip generation share one submission
+        VkCommandBuffer commandBuffer = m_device.beginSingleTimeCommands();
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = m_textureImage;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = m_mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = m_layerCount;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+            0, nullptr, 0, nullptr, 1, &barrier);
+
+        std::vector<VkBufferImageCopy> regions(_levelCount);
+        for (uint32_t level = 0; level < _levelCount; level++)
+        {
+            VkBufferImageCopy& region = regions[level];
+            region.bufferOffset = offsets[level];
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = m_layerCount;
+            region.imageExtent = { std::max(m_extent.width >> level, 1u), std::max(m_extent.height >> level, 1u), 1 };
+        }
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            _levelCount, regions.data());
+
+        if (_levelCount < m_mipLevels)
+        {
+            recordMipmaps(commandBuffer);
+        }
+        else
+        {
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+        m_device.endSingleTimeCommands(commandBuffer);
 
         m_textureLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-        vkDestroyBuffer(m_device.device(), stagingBuffer, nullptr);
-        vkFreeMemory(m_device.device(), stagingBufferMemory, nullptr);
+        m_device.destroyBuffer(stagingBuffer, stagingBufferMemory);
+    }
+
+    void Texture::recordMipmaps(VkCommandBuffer _commandBuffer)
+    {
+        // Level i is blitted from level i - 1, which is moved to TRANSFER_SRC first and to
+        // SHADER_READ_ONLY once consumed. The last level is only ever a destination
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = m_textureImage;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = m_layerCount;
+
+        int32_t mipWidth = static_cast<int32_t>(m_extent.width);
+        int32_t mipHeight = static_cast<int32_t>(m_extent.height);
+
+        for (uint32_t level = 1; level < m_mipLevels; level++)
+        {
+            barrier.subresourceRange.baseMipLevel = level - 1;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                0, nullptr, 0, nullptr, 1, &barrier);
+
+            const int32_t nextWidth = std::max(mipWidth / 2, 1);
+            const int32_t nextHeight = std::max(mipHeight / 2, 1);
+
+            VkImageBlit blit{};
+            blit.srcOffsets[0] = { 0, 0, 0 };
+            blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+            blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit.srcSubresource.mipLevel = level - 1;
+            blit.srcSubresource.baseArrayLayer = 0;
+            blit.srcSubresource.layerCount = m_layerCount;
+            blit.dstOffsets[0] = { 0, 0, 0 };
+            blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+            blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit.dstSubresource.mipLevel = level;
+            blit.dstSubresource.baseArrayLayer = 0;
+            blit.dstSubresource.layerCount = m_layerCount;
+            vkCmdBlitImage(_commandBuffer,
+                m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1, &blit, VK_FILTER_LINEAR);
+
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                0, nullptr, 0, nullptr, 1, &barrier);
+
+            mipWidth = nextWidth;
+            mipHeight = nextHeight;
+        }
+
+        barrier.subresourceRange.baseMipLevel = m_mipLevels - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+            0, nullptr, 0, nullptr, 1, &barrier);
     }
 
     void Texture::createTextureImageView(VkImageViewType _viewType) 
@@ -207,7 +403,7 @@ namespace Engine
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image = m_textureImage;
         viewInfo.viewType = _viewType;
-        viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+        viewInfo.format = m_format;
         viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         viewInfo.subresourceRange.baseMipLevel = 0;
         viewInfo.subresourceRange.levelCount = m_mipLevels;
@@ -242,10 +438,22 @@ namespace Engine
         samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerInfo.mipLodBias = 0.0f;
         samplerInfo.minLod = 0.0f;
-        samplerInfo.maxLod = static_cast<float>(m_mipLevels);
+        samplerInfo.maxLod = static_cast<float>(m_mipLevels - 1);
 
         if (vkCreateSampler(m_device.device(), &samplerInfo, nullptr, &m_textureSampler) != VK_SUCCESS) 
             throw std::runtime_error("failed to create texture sampler!");
+
+        // Same filtering clamped to level 0, to compare against the full chain
+        samplerInfo.maxLod = 0.0f;
+        if (vkCreateSampler(m_device.device(), &samplerInfo, nullptr, &m_baseLevelSampler) != VK_SUCCESS) 
+            throw std::runtime_error("failed to create texture sampler!");
+    }
+
+    void Texture::setMipmapsEnabled(bool _enabled)
+    {
+        if (m_baseLevelSampler == nullptr) return;
+        m_mipmapsEnabled = _enabled;
+        updateDescriptor();
     }
 
     void Texture::transitionLayout(VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout) 
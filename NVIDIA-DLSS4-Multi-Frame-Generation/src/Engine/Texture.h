@@ -1,15 +1,28 @@
 #pragma once
 #include "EngineDevice.h"
+#include "Ktx2File.h"
 
 #include <vulkan/vulkan.h>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace Engine
 {
     struct Texture
     {
+        // CPU side of a texture file, either a mapped KTX2 or a decoded image
+        struct SourceImage
+        {
+            VkFormat m_format = VK_FORMAT_UNDEFINED;
+            VkExtent3D m_extent{};
+            std::vector<Ktx2File::Level> m_levels; // Point into m_ktx2 or m_pixels
+            Ktx2File m_ktx2;
+            std::shared_ptr<uint8_t> m_pixels;
+        };
+
         Texture(EngineDevice& _device, const std::string& _textureFilePath);
+        Texture(EngineDevice& _device, const SourceImage& _source);
         Texture(
             EngineDevice& _device,
             VkFormat _format,
@@ -32,22 +45,45 @@ namespace Engine
         VkFormat getFormat() const { return m_format; }
 
         void updateDescriptor();
+
+        // Samples only the base level when disabled, for measuring what the mip chain saves
+        void setMipmapsEnabled(bool _enabled);
+        uint32_t getMipLevels() const { return m_mipLevels; }
+        VkDeviceSize getMemorySize() const { return m_memorySize; }
         void transitionLayout(VkCommandBuffer _commandBuffer, VkImageLayout _oldLayout, VkImageLayout _newLayout);
 
         static std::unique_ptr<Texture> createTextureFromFile(EngineDevice& _device, const std::string& _filePath);
 
+        // Loads "*.ktx2" directly. Other images prefer an up to date KTX2 next to them, unless
+        // !_preferKtx2, and fall back to decoding with stb_image. Only queries format support from
+        // the device, so it is safe to run on a worker thread. Throws if nothing usable can be loaded
+        static void loadSource(EngineDevice& _device, const std::string& _filePath, SourceImage& _outSource, bool _preferKtx2 = true);
+
     private:
-        void createTextureImage(const std::string& _filePath);
+        // False when the file is unusable or its format isn't supported by the device
+        static bool openKtx2(EngineDevice& _device, const std::string& _filePath, SourceImage& _outSource);
+        void createTextureImage(const SourceImage& _source);
+        bool canBlitMipmaps(VkFormat _format) const;
+        uint32_t fullMipCount() const;
+        void createImage();
+        // Copies the given leading levels and blits the rest, in one submission
+        void uploadLevels(const Ktx2File::Level* _levels, uint32_t _levelCount);
         void createTextureImageView(VkImageViewType _viewType);
         void createTextureSampler();
+        // Blits each level from the previous one and leaves the whole chain in SHADER_READ_ONLY.
+        // Expects every level in TRANSFER_DST with level 0 filled
+        void recordMipmaps(VkCommandBuffer _commandBuffer);
 
         VkDescriptorImageInfo m_descriptor{};
 
         EngineDevice& m_device;
         VkImage m_textureImage = nullptr;
         VkDeviceMemory m_textureImageMemory = nullptr;
+        VkDeviceSize m_memorySize = 0;
         VkImageView m_textureImageView = nullptr;
         VkSampler m_textureSampler = nullptr;
+        VkSampler m_baseLevelSampler = nullptr;
+        bool m_mipmapsEnabled = true;
         VkFormat m_format;
         VkImageLayout m_textureLayout;
         uint32_t m_mipLevels{1};
@@ -0,0 +1,541 @@
+#include "TextureCompressor.h"
+#include "Ktx2File.h"
+
+#include <stb_image/stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace Engine
+{
+    namespace
+    {
+        using Block = std::array<std::array<float, 4>, 16>;
+
+        float srgbToLinear(uint8_t _value)
+        {
+            static const std::array<float, 256> table = []()
+            {
+                std::array<float, 256> values{};
+                for (int i = 0; i < 256; i++)
+                {
+                    const float c = i / 255.0f;
+                    values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                return values;
+            }();
+            return table[_value];
+        }
+
+        uint8_t linearToSrgb(float _value)
+        {
+            const float c = std::clamp(_value, 0.0f, 1.0f);
+            const float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            return static_cast<uint8_t>(s * 255.0f + 0.5f);
+        }
+
+        float distanceSquared(const float* _a, const float* _b, int _channels)
+        {
+            float sum = 0.0f;
+            for (int c = 0; c < _channels; c++)
+                sum += (_a[c] - _b[c]) * (_a[c] - _b[c]);
+            return sum;
+        }
+
+        // Endpoints spanning the block along its principal axis, found by power iteration
+        void fitPrincipalAxis(const Block& _block, int _channels, float* _outLow, float* _outHigh)
+        {
+            float mean[4] = {};
+            for (const auto& pixel : _block)
+                for (int c = 0; c < _channels; c++)
+                    mean[c] += pixel[c] / 16.0f;
+
+            float covariance[4][4] = {};
+            for (const auto& pixel : _block)
+                for (int i = 0; i < _channels; i++)
+                    for (int j = 0; j < _channels; j++)
+                        covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+
+            float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            for (int iteration = 0; iteration < 8; iteration++)
+            {
+                float next[4] = {};
+                float length = 0.0f;
+                for (int i = 0; i < _channels; i++)
+                {
+                    for (int j = 0; j < _channels; j++)
+                        next[i] += covariance[i][j] * axis[j];
+                    length = std::max(length, std::abs(next[i]));
+                }
+                if (length < 1e-6f) break;
+                for (int i = 0; i < _channels; i++)
+                    axis[i] = next[i] / length;
+            }
+
+            float minProjection = std::numeric_limits<float>::max();
+            float maxProjection = std::numeric_limits<float>::lowest();
+            float axisLengthSquared = 0.0f;
+            for (int c = 0; c < _channels; c++)
+                axisLengthSquared += axis[c] * axis[c];
+            for (const auto& pixel : _block)
+            {
+                float projection = 0.0f;
+                for (int c = 0; c < _channels; c++)
+                    projection += (pixel[c] - mean[c]) * axis[c];
+                minProjection = std::min(minProjection, projection / axisLengthSquared);
+                maxProjection = std::max(maxProjection, projection / axisLengthSquared);
+            }
+
+            for (int c = 0; c < _channels; c++)
+            {
+                _outLow[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+                _outHigh[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+            }
+        }
+
+        // Least squares endpoints for fixed interpolation weights. False when the weights are degenerate
+        bool refineEndpoints(const Block& _block, const float* _weights, int _channels, float* _outLow, float* _outHigh)
+        {
+            float a = 0.0f, b = 0.0f, c = 0.0f;
+            float x[4] = {}, y[4] = {};
+            for (int i = 0; i < 16; i++)
+            {
+                const float t = _weights[i];
+                a += (1.0f - t) * (1.0f - t);
+                b += (1.0f - t) * t;
+                c += t * t;
+                for (int ch = 0; ch < _channels; ch++)
+                {
+                    x[ch] += (1.0f - t) * _block[i][ch];
+                    y[ch] += t * _block[i][ch];
+                }
+            }
+
+            const float determinant = a * c - b * b;
+            if (std::abs(determinant) < 1e-6f) return false;
+            for (int ch = 0; ch < _channels; ch++)
+            {
+                _outLow[ch] = std::clamp((c * x[ch] - b * y[ch]) / determinant, 0.0f, 255.0f);
+                _outHigh[ch] = std::clamp((a * y[ch] - b * x[ch]) / determinant, 0.0f, 255.0f);
+            }
+            return true;
+        }
+
+        // Nearest palette entry per pixel, returns the total squared error
+        float assignIndices(const Block& _block, const float (*_palette)[4], int _paletteSize, int _channels, uint8_t* _outIndices)
+        {
+            float total = 0.0f;
+            for (int i = 0; i < 16; i++)
+            {
+                float best = std::numeric_limits<float>::max();
+                for (int p = 0; p < _paletteSize; p++)
+                {
+                    const float error = distanceSquared(_block[i].data(), _palette[p], _channels);
+                    if (error < best)
+                    {
+                        best = error;
+                        _outIndices[i] = static_cast<uint8_t>(p);
+                    }
+                }
+                total += best;
+            }
+            return total;
+        }
+
+        uint16_t packRgb565(const float* _colour)
+        {
+            const uint32_t r = static_cast<uint32_t>(_colour[0] * 31.0f / 255.0f + 0.5f);
+            const uint32_t g = static_cast<uint32_t>(_colour[1] * 63.0f / 255.0f + 0.5f);
+            const uint32_t b = static_cast<uint32_t>(_colour[2] * 31.0f / 255.0f + 0.5f);
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        void unpackRgb565(uint16_t _packed, float* _outColour)
+        {
+            const uint32_t r = (_packed >> 11) & 31, g = (_packed >> 5) & 63, b = _packed & 31;
+            _outColour[0] = static_cast<float>((r << 3) | (r >> 2));
+            _outColour[1] = static_cast<float>((g << 2) | (g >> 4));
+            _outColour[2] = static_cast<float>((b << 3) | (b >> 2));
+            _outColour[3] = 0.0f;
+        }
+
+        // Four colour mode palette, index order 0, 1, 2/3 + 1/3, 1/3 + 2/3
+        void bc1Palette(uint16_t _c0, uint16_t _c1, float (*_outPalette)[4])
+        {
+            unpackRgb565(_c0, _outPalette[0]);
+            unpackRgb565(_c1, _outPalette[1]);
+            for (int c = 0; c < 3; c++)
+            {
+                _outPalette[2][c] = (2.0f * _outPalette[0][c] + _outPalette[1][c]) / 3.0f;
+                _outPalette[3][c] = (_outPalette[0][c] + 2.0f * _outPalette[1][c]) / 3.0f;
+            }
+        }
+
+        void encodeBC1(const Block& _block, uint8_t* _out)
+        {
+            static constexpr float WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+            float low[4], high[4];
+            fitPrincipalAxis(_block, 3, low, high);
+
+            uint16_t bestC0 = 0, bestC1 = 0;
+            uint8_t bestIndices[16] = {};
+            float bestError = std::numeric_limits<float>::max();
+            for (int iteration = 0; iteration < 3; iteration++)
+            {
+                const uint16_t c0 = packRgb565(high);
+                const uint16_t c1 = packRgb565(low);
+                float palette[4][4];
+                bc1Palette(c0, c1, palette);
+
+                uint8_t indices[16];
+                const float error = assignIndices(_block, palette, 4, 3, indices);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestC0 = c0;
+                    bestC1 = c1;
+                    std::memcpy(bestIndices, indices, sizeof(indices));
+                }
+
+                float weights[16];
+                for (int i = 0; i < 16; i++)
+                    weights[i] = WEIGHTS[indices[i]];
+                if (!refineEndpoints(_block, weights, 3, high, low)) break;
+            }
+
+            // c0 > c1 selects the four colour mode. Equal endpoints decode index 0 either way
+            if (bestC0 < bestC1)
+            {
+                std::swap(bestC0, bestC1);
+                for (uint8_t& index : bestIndices)
+                    index ^= 1;
+            }
+            else if (bestC0 == bestC1)
+            {
+                std::memset(bestIndices, 0, sizeof(bestIndices));
+            }
+
+            uint32_t packedIndices = 0;
+            for (int i = 0; i < 16; i++)
+                packedIndices |= uint32_t(bestIndices[i]) << (2 * i);
+
+            std::memcpy(_out, &bestC0, 2);
+            std::memcpy(_out + 2, &bestC1, 2);
+            std::memcpy(_out + 4, &packedIndices, 4);
+        }
+
+        // Eight value alpha block: endpoints at the block's extremes, six interpolated between
+        void encodeBC3Alpha(const Block& _block, uint8_t* _out)
+        {
+            float minAlpha = 255.0f, maxAlpha = 0.0f;
+            for (const auto& pixel : _block)
+            {
+                minAlpha = std::min(minAlpha, pixel[3]);
+                maxAlpha = std::max(maxAlpha, pixel[3]);
+            }
+            const uint8_t a0 = static_cast<uint8_t>(maxAlpha + 0.5f);
+            const uint8_t a1 = static_cast<uint8_t>(minAlpha + 0.5f);
+
+            float palette[8] = { float(a0), float(a1) };
+            for (int k = 1; k < 7; k++)
+                palette[k + 1] = ((7 - k) * a0 + k * a1) / 7.0f;
+
+            uint64_t packedIndices = 0;
+            if (a0 > a1)
+            {
+                for (int i = 0; i < 16; i++)
+                {
+                    int bestIndex = 0;
+                    for (int p = 1; p < 8; p++)
+                    {
+                        if (std::abs(palette[p] - _block[i][3]) < std::abs(palette[bestIndex] - _block[i][3]))
+                            bestIndex = p;
+                    }
+                    packedIndices |= uint64_t(bestIndex) << (3 * i);
+                }
+            }
+
+            _out[0] = a0;
+            _out[1] = a1;
+            for (int byte = 0; byte < 6; byte++)
+                _out[2 + byte] = static_cast<uint8_t>(packedIndices >> (8 * byte));
+        }
+
+        struct BitWriter
+        {
+            uint8_t* m_data;
+            uint32_t m_position = 0;
+
+            void write(uint32_t _value, uint32_t _bits)
+            {
+                for (uint32_t bit = 0; bit < _bits; bit++, m_position++)
+                {
+                    if ((_value >> bit) & 1)
+                        m_data[m_position / 8] |= static_cast<uint8_t>(1u << (m_position % 8));
+                }
+            }
+        };
+
+        // 7 bit endpoint plus a p-bit shared by its four channels, picking the p-bit that fits best
+        void quantizeBC7Endpoint(const float* _endpoint, uint32_t* _outValues, uint32_t& _outPBit)
+        {
+            float bestError = std::numeric_limits<float>::max();
+            for (uint32_t p = 0; p < 2; p++)
+            {
+                uint32_t values[4];
+                float error = 0.0f;
+                for (int c = 0; c < 4; c++)
+                {
+                    values[c] = static_cast<uint32_t>(std::clamp(std::round((_endpoint[c] - p) / 2.0f), 0.0f, 127.0f));
+                    const float decoded = float(values[c] * 2 + p);
+                    error += (decoded - _endpoint[c]) * (decoded - _endpoint[c]);
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    _outPBit = p;
+                    std::memcpy(_outValues, values, sizeof(values));
+                }
+            }
+        }
+
+        // Mode 6: one subset, 7.7.7.7 endpoints with unique p-bits, 4 bit indices
+        void encodeBC7(const Block& _block, uint8_t* _out)
+        {
+            static constexpr uint32_t WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+            float low[4], high[4];
+            fitPrincipalAxis(_block, 4, low, high);
+
+            uint32_t bestEndpoints[2][4] = {};
+            uint32_t bestPBits[2] = {};
+            uint8_t bestIndices[16] = {};
+            float bestError = std::numeric_limits<float>::max();
+            for (int iteration = 0; iteration < 3; iteration++)
+            {
+                uint32_t endpoints[2][4];
+                uint32_t pBits[2];
+                quantizeBC7Endpoint(low, endpoints[0], pBits[0]);
+                quantizeBC7Endpoint(high, endpoints[1], pBits[1]);
+
+                float palette[16][4];
+                for (int p = 0; p < 16; p++)
+                {
+                    for (int c = 0; c < 4; c++)
+                    {
+                        const uint32_t e0 = endpoints[0][c] * 2 + pBits[0];
+                        const uint32_t e1 = endpoints[1][c] * 2 + pBits[1];
+                        palette[p][c] = float(((64 - WEIGHTS[p]) * e0 + WEIGHTS[p] * e1 + 32) >> 6);
+                    }
+                }
+
+                uint8_t indices[16];
+                const float error = assignIndices(_block, palette, 16, 4, indices);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    std::memcpy(bestEndpoints, endpoints, sizeof(endpoints));
+                    std::memcpy(bestPBits, pBits, sizeof(pBits));
+                    std::memcpy(bestIndices, indices, sizeof(indices));
+                }
+
+                float weights[16];
+                for (int i = 0; i < 16; i++)
+                    weights[i] = WEIGHTS[indices[i]] / 64.0f;
+                if (!refineEndpoints(_block, weights, 4, low, high)) break;
+            }
+
+            // The anchor index is stored without its top bit, so it must be below 8
+            if (bestIndices[0] >= 8)
+            {
+                std::swap(bestEndpoints[0], bestEndpoints[1]);
+                std::swap(bestPBits[0], bestPBits[1]);
+                for (uint8_t& index : bestIndices)
+                    index = static_cast<uint8_t>(15 - index);
+            }
+
+            std::memset(_out, 0, 16);
+            BitWriter writer{ _out };
+            writer.write(1u << 6, 7);
+            for (int c = 0; c < 4; c++)
+            {
+                writer.write(bestEndpoints[0][c], 7);
+                writer.write(bestEndpoints[1][c], 7);
+            }
+            writer.write(bestPBits[0], 1);
+            writer.write(bestPBits[1], 1);
+            writer.write(bestIndices[0], 3);
+            for (int i = 1; i < 16; i++)
+                writer.write(bestIndices[i], 4);
+        }
+    }
+
+    namespace TextureCompressor
+    {
+        bool parseFormat(const std::string& _name, Format& _outFormat)
+        {
+            for (Format format : { Format::BC1, Format::BC3, Format::BC7, Format::RGBA8 })
+            {
+                if (_name == formatName(format))
+                {
+                    _outFormat = format;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const char* formatName(Format _format)
+        {
+            switch (_format)
+            {
+            case Format::BC1: return "bc1";
+            case Format::BC3: return "bc3";
+            case Format::BC7: return "bc7";
+            default: return "rgba8";
+            }
+        }
+
+        VkFormat vkFormat(Format _format)
+        {
+            switch (_format)
+            {
+            case Format::BC1: return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+            case Format::BC3: return VK_FORMAT_BC3_SRGB_BLOCK;
+            case Format::BC7: return VK_FORMAT_BC7_SRGB_BLOCK;
+            default: return VK_FORMAT_R8G8B8A8_SRGB;
+            }
+        }
+
+        std::vector<std::vector<uint8_t>> buildMipChain(const uint8_t* _rgba, uint32_t _width, uint32_t _height)
+        {
+            std::vector<std::vector<uint8_t>> levels;
+            levels.emplace_back(_rgba, _rgba + size_t(_width) * _height * 4);
+
+            uint32_t width = _width, height = _height;
+            while (width > 1 || height > 1)
+            {
+                const std::vector<uint8_t>& source = levels.back();
+                const uint32_t nextWidth = std::max(width / 2, 1u);
+                const uint32_t nextHeight = std::max(height / 2, 1u);
+                std::vector<uint8_t> next(size_t(nextWidth) * nextHeight * 4);
+
+                // 2x2 box, colour averaged in linear light and alpha as stored.
+                // A 1 texel wide side repeats its row or column
+                for (uint32_t y = 0; y < nextHeight; y++)
+                {
+                    const uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+                    for (uint32_t x = 0; x < nextWidth; x++)
+                    {
+                        const uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                        const uint8_t* texels[4] = {
+                            &source[(size_t(y0) * width + x0) * 4], &source[(size_t(y0) * width + x1) * 4],
+                            &source[(size_t(y1) * width + x0) * 4], &source[(size_t(y1) * width + x1) * 4]
+                        };
+
+                        uint8_t* out = &next[(size_t(y) * nextWidth + x) * 4];
+                        for (int c = 0; c < 3; c++)
+                            out[c] = linearToSrgb((srgbToLinear(texels[0][c]) + srgbToLinear(texels[1][c]) + srgbToLinear(texels[2][c]) + srgbToLinear(texels[3][c])) * 0.25f);
+                        out[3] = static_cast<uint8_t>((texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3] + 2) / 4);
+                    }
+                }
+
+                levels.push_back(std::move(next));
+                width = nextWidth;
+                height = nextHeight;
+            }
+            return levels;
+        }
+
+        std::vector<uint8_t> compressLevel(const uint8_t* _rgba, uint32_t _width, uint32_t _height, Format _format)
+        {
+            if (_format == Format::RGBA8)
+                return std::vector<uint8_t>(_rgba, _rgba + size_t(_width) * _height * 4);
+
+            const uint32_t blockBytes = _format == Format::BC1 ? 8 : 16;
+            const uint32_t blocksWide = (_width + 3) / 4;
+            const uint32_t blocksHigh = (_height + 3) / 4;
+            std::vector<uint8_t> output(size_t(blocksWide) * blocksHigh * blockBytes);
+
+            Block block;
+            for (uint32_t by = 0; by < blocksHigh; by++)
+            {
+                for (uint32_t bx = 0; bx < blocksWide; bx++)
+                {
+                    for (uint32_t i = 0; i < 16; i++)
+                    {
+                        const uint32_t x = std::min(bx * 4 + i % 4, _width - 1);
+                        const uint32_t y = std::min(by * 4 + i / 4, _height - 1);
+                        const uint8_t* texel = &_rgba[(size_t(y) * _width + x) * 4];
+                        for (int c = 0; c < 4; c++)
+                            block[i][c] = texel[c];
+                    }
+
+                    uint8_t* out = &output[(size_t(by) * blocksWide + bx) * blockBytes];
+                    switch (_format)
+                    {
+                    case Format::BC1:
+                        encodeBC1(block, out);
+                        break;
+                    case Format::BC3:
+                        encodeBC3Alpha(block, out);
+                        encodeBC1(block, out + 8);
+                        break;
+                    default:
+                        encodeBC7(block, out);
+                        break;
+                    }
+                }
+            }
+            return output;
+        }
+
+        bool compressFile(const std::string& _sourcePath, Format _format, const std::string& _outputPath)
+        {
+            const std::string outputPath = _outputPath.empty() ? Ktx2File::pathFor(_sourcePath) : _outputPath;
+            auto start = std::chrono::high_resolution_clock::now();
+
+            int width, height, channels;
+            stbi_uc* pixels = stbi_load(_sourcePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+            if (!pixels)
+            {
+                std::cerr << _sourcePath << ": " << stbi_failure_reason() << std::endl;
+                return false;
+            }
+
+            const std::vector<std::vector<uint8_t>> mips = buildMipChain(pixels, uint32_t(width), uint32_t(height));
+            stbi_image_free(pixels);
+
+            std::vector<std::vector<uint8_t>> levels;
+            uint64_t uncompressedBytes = 0, compressedBytes = 0;
+            for (size_t level = 0; level < mips.size(); level++)
+            {
+                const uint32_t levelWidth = std::max(uint32_t(width) >> level, 1u);
+                const uint32_t levelHeight = std::max(uint32_t(height) >> level, 1u);
+                levels.push_back(compressLevel(mips[level].data(), levelWidth, levelHeight, _format));
+                uncompressedBytes += mips[level].size();
+                compressedBytes += levels.back().size();
+            }
+
+            if (!Ktx2File::write(outputPath, vkFormat(_format), uint32_t(width), uint32_t(height), levels))
+            {
+                std::cerr << "Failed to write " << outputPath << std::endl;
+                return false;
+            }
+
+            const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            std::printf("%s -> %s: %dx%d, %zu levels, %s, %llu KB (RGBA8 chain %llu KB, %.1fx smaller, %.1f ms)\n",
+                _sourcePath.c_str(), outputPath.c_str(), width, height, levels.size(), formatName(_format),
+                static_cast<unsigned long long>(compressedBytes / 1024), static_cast<unsigned long long>(uncompressedBytes / 1024),
+                double(uncompressedBytes) / double(compressedBytes), milliseconds);
+            return true;
+        }
+    }
+}
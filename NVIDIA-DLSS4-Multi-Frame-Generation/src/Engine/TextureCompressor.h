@@ -0,0 +1,40 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    /*
+     * Offline texture conversion behind --compress-texture. Decodes a PNG/JPG, builds the mip chain
+     * with a box filter in linear light and block compresses every level into a KTX2 file.
+     * The encoders fit endpoints along the principal axis of each 4x4 block, then refine them by
+     * least squares against the chosen indices. BC7 uses mode 6 only (one subset, RGBA endpoints).
+     */
+    namespace TextureCompressor
+    {
+        enum class Format
+        {
+            BC1,  // RGB, 4 bits per texel, alpha dropped
+            BC3,  // RGBA, 8 bits per texel, separate alpha block
+            BC7,  // RGBA, 8 bits per texel, best quality
+            RGBA8 // Uncompressed, mips only
+        };
+
+        // Accepts "bc1", "bc3", "bc7" and "rgba8"
+        bool parseFormat(const std::string& _name, Format& _outFormat);
+        const char* formatName(Format _format);
+        VkFormat vkFormat(Format _format);
+
+        // Levels of an sRGB RGBA8 image down to 1x1, level 0 being a copy of _rgba
+        std::vector<std::vector<uint8_t>> buildMipChain(const uint8_t* _rgba, uint32_t _width, uint32_t _height);
+
+        // Encodes one RGBA8 level into rows of 4x4 blocks, edge blocks padded by clamping
+        std::vector<uint8_t> compressLevel(const uint8_t* _rgba, uint32_t _width, uint32_t _height, Format _format);
+
+        // Writes _outputPath, or Ktx2File::pathFor(_sourcePath) when it is empty
+        bool compressFile(const std::string& _sourcePath, Format _format, const std::string& _outputPath = "");
+    }
+}
@@ -0,0 +1,46 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    ThreadPool::ThreadPool(uint32_t _threadCount)
+    {
+        if (_threadCount == 0)
+            _threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+        m_threads.reserve(_threadCount);
+        for (uint32_t i = 0; i < _threadCount; i++)
+            m_threads.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_tasks.clear();
+        }
+        m_condition.notify_all();
+
+        for (std::thread& thread : m_threads)
+            thread.join();
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                if (m_stopping) return;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+}
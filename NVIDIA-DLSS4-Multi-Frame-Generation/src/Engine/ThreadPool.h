@@ -0,0 +1,50 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Engine
+{
+    // Fixed set of worker threads draining one FIFO queue. Exceptions thrown by a task are
+    // stored in its future. The destructor waits for running tasks and drops queued ones,
+    // whose futures then report std::future_errc::broken_promise
+    struct ThreadPool
+    {
+        // _threadCount of 0 leaves one hardware thread for the main loop
+        explicit ThreadPool(uint32_t _threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        template<typename F>
+        std::future<std::invoke_result_t<F>> submit(F&& _task)
+        {
+            auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(_task));
+            std::future<std::invoke_result_t<F>> future = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.emplace_back([task]() { (*task)(); });
+            }
+            m_condition.notify_one();
+            return future;
+        }
+
+        uint32_t threadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> m_threads;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stopping = false;
+    };
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Engine
+{
+    /*
+     * Lock free hand off of the latest value from one producer thread to one consumer thread.
+     * The producer fills back() and publishes it, the consumer takes the newest published value
+     * into front(). Each side owns one of the three buffers and the third is swapped through an
+     * atomic, so neither side ever copies or waits on the other's buffer. Both sides can also
+     * block until the other has caught up, which turns the exchange into a one deep pipeline.
+     */
+    template<typename T>
+    struct TripleBuffer
+    {
+        TripleBuffer() { reset(); }
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // Neither side may be using the buffer. Keeps the buffers' contents, forgets any publish
+        void reset()
+        {
+            m_back = 0;
+            m_front = 2;
+            m_state.store(1, std::memory_order_relaxed);
+        }
+
+        // Producer
+        T& back() { return m_buffers[m_back]; }
+        void publish()
+        {
+            uint32_t state = m_state.load(std::memory_order_relaxed);
+            while (!m_state.compare_exchange_weak(state, m_back | FRESH | (state & CLOSED), std::memory_order_acq_rel)) {}
+            m_back = state & INDEX_MASK;
+            m_state.notify_all();
+        }
+        // Producer. Blocks until the last publish has been taken. False once the exchange is closed
+        bool waitUntilTaken()
+        {
+            uint32_t state = m_state.load(std::memory_order_acquire);
+            while ((state & FRESH) && !(state & CLOSED))
+            {
+                m_state.wait(state, std::memory_order_acquire);
+                state = m_state.load(std::memory_order_acquire);
+            }
+            return !(state & CLOSED);
+        }
+
+        // Consumer. Moves the newest publish into front(), false if there was none
+        bool take()
+        {
+            uint32_t state = m_state.load(std::memory_order_relaxed);
+            do
+            {
+                if (!(state & FRESH)) return false;
+            } while (!m_state.compare_exchange_weak(state, m_front | (state & CLOSED), std::memory_order_acq_rel));
+
+            m_front = state & INDEX_MASK;
+            m_state.notify_all();
+            return true;
+        }
+        // Consumer. Blocks until something is published or the exchange is closed
+        void waitForPublish()
+        {
+            uint32_t state = m_state.load(std::memory_order_acquire);
+            while (!(state & FRESH) && !(state & CLOSED))
+            {
+                m_state.wait(state, std::memory_order_acquire);
+                state = m_state.load(std::memory_order_acquire);
+            }
+        }
+        const T& front() const { return m_buffers[m_front]; }
+
+        // Releases both sides from their waits for good, until reopen() or reset()
+        void close()
+        {
+            m_state.fetch_or(CLOSED, std::memory_order_acq_rel);
+            m_state.notify_all();
+        }
+        // Undoes close(), a publish not yet taken stays available
+        void reopen() { m_state.fetch_and(~CLOSED, std::memory_order_acq_rel); }
+
+    private:
+        static constexpr uint32_t INDEX_MASK = 0x3;
+        static constexpr uint32_t FRESH = 0x4; // The middle buffer holds a publish not yet taken
+        static constexpr uint32_t CLOSED = 0x8;
+
+        std::array<T, 3> m_buffers{};
+        uint32_t m_back;  // Producer only
+        uint32_t m_front; // Consumer only
+        std::atomic<uint32_t> m_state; // Index of the middle buffer and flags
+    };
+}
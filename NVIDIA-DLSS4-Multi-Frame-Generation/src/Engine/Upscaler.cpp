@@ -0,0 +1,313 @@
+#include "Upscaler.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace Engine
+{
+    namespace
+    {
+        // Matches local_size in Upscale.comp and Sharpen.comp
+        constexpr uint32_t GROUP_SIZE = 8;
+
+        // Matches Push in Upscale.comp and Sharpen.comp
+        struct UpscalePushConstantData
+        {
+            glm::vec2 m_inputSize;
+            glm::vec2 m_outputSize;
+            float m_sharpness;
+            uint32_t m_encodeSrgb;
+        };
+
+        VkImageView createView(EngineDevice& _device, VkImage _image, VkFormat _format, VkImageUsageFlags _usage)
+        {
+            // The sRGB view leaves out storage, which sRGB formats don't support
+            VkImageViewUsageCreateInfo usageInfo{};
+            usageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+            usageInfo.usage = _usage;
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.pNext = &usageInfo;
+            viewInfo.image = _image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = _format;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            VkImageView view = VK_NULL_HANDLE;
+            if (vkCreateImageView(_device.device(), &viewInfo, nullptr, &view) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create upscaler image view!");
+            return view;
+        }
+
+        VkImageMemoryBarrier imageBarrier(VkImage _image, VkImageLayout _oldLayout, VkImageLayout _newLayout, VkAccessFlags _srcAccess, VkAccessFlags _dstAccess)
+        {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = _image;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = 1;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+            barrier.oldLayout = _oldLayout;
+            barrier.newLayout = _newLayout;
+            barrier.srcAccessMask = _srcAccess;
+            barrier.dstAccessMask = _dstAccess;
+            return barrier;
+        }
+    }
+
+    Upscaler::Upscaler(EngineDevice& _device)
+        : m_device(_device), m_gpuTimer(_device, SwapChain::MAX_FRAMES_IN_FLIGHT)
+    {
+        createPipelineLayout();
+        createPipelines();
+        createSampler();
+
+        // Two sets per frame slot, rewritten each time the slot records since the images change with the swap chain
+        m_pool = DescriptorPool::Builder(m_device)
+            .setMaxSets(SwapChain::MAX_FRAMES_IN_FLIGHT * 2)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, SwapChain::MAX_FRAMES_IN_FLIGHT * 2)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, SwapChain::MAX_FRAMES_IN_FLIGHT * 2)
+            .build();
+        for (FrameResources& frame : m_frames)
+        {
+            if (!m_pool->allocateDescriptorSet(m_setLayout->getDescriptorSetLayout(), frame.m_upscaleSet) ||
+                !m_pool->allocateDescriptorSet(m_setLayout->getDescriptorSetLayout(), frame.m_sharpenSet))
+                throw std::runtime_error("Failed to allocate upscaler descriptor sets!");
+        }
+    }
+
+    Upscaler::~Upscaler()
+    {
+        for (FrameResources& frame : m_frames)
+        {
+            release(frame.m_upscaled);
+            release(frame.m_output);
+        }
+        vkDestroySampler(m_device.device(), m_sampler, nullptr);
+        vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
+    }
+
+    void Upscaler::createPipelineLayout()
+    {
+        m_setLayout =
+            DescriptorSetLayout::Builder(m_device)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT) // Input
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT) // Output
+            .build();
+
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(UpscalePushConstantData);
+
+        VkDescriptorSetLayout setLayout = m_setLayout->getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(m_device.device(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create upscaler pipeline layout!");
+    }
+
+    void Upscaler::createPipelines()
+    {
+        assert(m_pipelineLayout != nullptr && "Cannot create compute pipeline: No pipelineLayout provided");
+
+        m_upscalePipeline = std::make_unique<Pipeline>(m_device, "Shaders/Upscale.comp.spv", m_pipelineLayout);
+        m_sharpenPipeline = std::make_unique<Pipeline>(m_device, "Shaders/Sharpen.comp.spv", m_pipelineLayout);
+    }
+
+    void Upscaler::createSampler()
+    {
+        // The shaders only use texelFetch, and clamp their own coordinates
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = samplerInfo.addressModeU;
+        samplerInfo.addressModeW = samplerInfo.addressModeU;
+        samplerInfo.maxAnisotropy = 1.0f;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = 0.0f;
+
+        if (vkCreateSampler(m_device.device(), &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create upscaler sampler!");
+    }
+
+    void Upscaler::setPreset(size_t _preset)
+    {
+        m_preset = std::min(_preset, std::size(PRESETS) - 1);
+        m_gpuTotal = 0.0;
+        m_timedFrames = 0;
+    }
+
+    VkFormat Upscaler::outputFormat(VkFormat _sceneFormat)
+    {
+        const bool srgb = _sceneFormat == VK_FORMAT_B8G8R8A8_SRGB || _sceneFormat == VK_FORMAT_R8G8B8A8_SRGB;
+        return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
+
+    void Upscaler::reserve(Target& _target, VkExtent2D _extent, VkFormat _format)
+    {
+        if (_target.m_image != VK_NULL_HANDLE && _target.m_extent.width == _extent.width && _target.m_extent.height == _extent.height &&
+            _target.m_format == _format)
+            return;
+        release(_target);
+        const bool srgb = _format != VK_FORMAT_R8G8B8A8_UNORM;
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = { _extent.width, _extent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = _format;
+        if (srgb)
+            imageInfo.flags = VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        m_device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _target.m_image, _target.m_memory, ResourceTag::RenderTarget);
+        _target.m_extent = _extent;
+        _target.m_format = _format;
+
+        if (srgb)
+        {
+            _target.m_view = createView(m_device, _target.m_image, _format, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+            _target.m_storageView = createView(m_device, _target.m_image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_STORAGE_BIT);
+        }
+        else
+        {
+            _target.m_view = createView(m_device, _target.m_image, _format, imageInfo.usage);
+            _target.m_storageView = _target.m_view;
+        }
+    }
+
+    void Upscaler::release(Target& _target)
+    {
+        if (_target.m_image == VK_NULL_HANDLE) return;
+
+        // Frame generation may still read the output at present, so it goes once its frames retire
+        m_device.deferDestroy([&device = m_device, image = _target.m_image, memory = _target.m_memory, view = _target.m_view,
+            storageView = _target.m_storageView]()
+            {
+                if (storageView != view)
+                    vkDestroyImageView(device.device(), storageView, nullptr);
+                vkDestroyImageView(device.device(), view, nullptr);
+                device.destroyImage(image, memory);
+            });
+        _target = Target{};
+    }
+
+    void Upscaler::prepare(uint32_t _frameIndex, VkExtent2D _displayExtent, VkFormat _sceneFormat)
+    {
+        FrameResources& frame = m_frames[_frameIndex];
+        const VkFormat format = outputFormat(_sceneFormat);
+        reserve(frame.m_output, _displayExtent, format);
+        if (PRESETS[m_preset].m_sharpness > 0.0f)
+            reserve(frame.m_upscaled, _displayExtent, format);
+    }
+
+    void Upscaler::record(VkCommandBuffer _commandBuffer, uint32_t _frameIndex, VkImage _sceneColour, VkImageView _sceneColourView,
+        VkExtent2D _renderExtent, VkExtent2D _displayExtent)
+    {
+        FrameResources& frame = m_frames[_frameIndex];
+        const bool sharpen = PRESETS[m_preset].m_sharpness > 0.0f;
+        assert(frame.m_output.m_extent.width == _displayExtent.width && frame.m_output.m_extent.height == _displayExtent.height &&
+            (!sharpen || frame.m_upscaled.m_image != VK_NULL_HANDLE) && "Upscaler::prepare was not called for this frame");
+        Target& upscaled = sharpen ? frame.m_upscaled : frame.m_output;
+
+        m_gpuTimer.begin(_commandBuffer, _frameIndex);
+
+        // The scene render pass makes its colour writes visible to compute, the slot's targets were last used by a retired frame
+        std::array<VkImageMemoryBarrier, 2> barriers = {
+            imageBarrier(_sceneColour, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT),
+            imageBarrier(upscaled.m_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT)
+        };
+        vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+            0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+        dispatch(_commandBuffer, frame.m_upscaleSet, _sceneColourView, upscaled, _renderExtent, _displayExtent, *m_upscalePipeline);
+
+        if (sharpen)
+        {
+            barriers = {
+                imageBarrier(upscaled.m_image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT),
+                imageBarrier(frame.m_output.m_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT)
+            };
+            vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+            dispatch(_commandBuffer, frame.m_sharpenSet, upscaled.m_view, frame.m_output, _displayExtent, _displayExtent, *m_sharpenPipeline);
+        }
+
+        // Copied to the swap chain image next
+        VkImageMemoryBarrier toTransfer = imageBarrier(frame.m_output.m_image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+        vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+            0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        m_gpuTimer.end(_commandBuffer, _frameIndex);
+    }
+
+    void Upscaler::dispatch(VkCommandBuffer _commandBuffer, VkDescriptorSet _set, VkImageView _input, const Target& _output,
+        VkExtent2D _inputExtent, VkExtent2D _outputExtent, Pipeline& _pipeline)
+    {
+        VkDescriptorImageInfo inputInfo{ m_sampler, _input, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        VkDescriptorImageInfo outputInfo{ VK_NULL_HANDLE, _output.m_storageView, VK_IMAGE_LAYOUT_GENERAL };
+        DescriptorWriter(*m_setLayout, *m_pool)
+            .writeImage(0, &inputInfo)
+            .writeImage(1, &outputInfo)
+            .overwrite(_set);
+
+        _pipeline.bind(_commandBuffer);
+        vkCmdBindDescriptorSets(_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &_set, 0, nullptr);
+
+        UpscalePushConstantData push{};
+        push.m_inputSize = glm::vec2(_inputExtent.width, _inputExtent.height);
+        push.m_outputSize = glm::vec2(_outputExtent.width, _outputExtent.height);
+        push.m_sharpness = PRESETS[m_preset].m_sharpness;
+        push.m_encodeSrgb = _output.m_format != VK_FORMAT_R8G8B8A8_UNORM ? 1 : 0;
+        vkCmdPushConstants(_commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(UpscalePushConstantData), &push);
+
+        vkCmdDispatch(_commandBuffer, (_outputExtent.width + GROUP_SIZE - 1) / GROUP_SIZE, (_outputExtent.height + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+    }
+
+    void Upscaler::resolveTiming(uint32_t _frameIndex)
+    {
+        double gpuMs = 0.0;
+        if (!m_gpuTimer.resolve(_frameIndex, gpuMs)) return;
+
+        m_gpuTotal += gpuMs;
+        m_timedFrames++;
+    }
+
+    Upscaler::Stats Upscaler::stats() const
+    {
+        Stats stats;
+        if (m_timedFrames > 0)
+            stats.m_gpuMs = m_gpuTotal / m_timedFrames;
+        stats.m_frames = m_timedFrames;
+        return stats;
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "Pipeline.h"
+#include "Descriptors.h"
+#include "GpuTimer.h"
+#include "SwapChain.h"
+
+#include <array>
+#include <memory>
+
+namespace Engine
+{
+    /*
+     * Spatial upscaling of the scene from its render extent to the swap chain extent, for when the
+     * scene is drawn below display resolution and DLSS Super Resolution isn't loaded. Two compute
+     * passes: an edge adaptive Lanczos upscale (Upscale.comp), then contrast adaptive sharpening
+     * (Sharpen.comp) at the preset's strength. The result lands in a display sized image per frame
+     * slot, which frame generation is given as the hudless colour and is copied to the swap chain.
+     */
+    struct Upscaler
+    {
+        // Render scale used while dynamic resolution is off, and sharpening strength. 0 skips the sharpening pass
+        struct Preset
+        {
+            const char* m_name;
+            float m_renderScale;
+            float m_sharpness;
+        };
+        static constexpr Preset PRESETS[] = {
+            { "Native", 1.0f, 0.0f },
+            { "Ultra quality", 0.77f, 0.2f },
+            { "Quality", 0.67f, 0.3f },
+            { "Balanced", 0.59f, 0.4f },
+            { "Performance", 0.5f, 0.5f }
+        };
+
+        // Output format for a scene colour format. Storage on the swap chain's BGRA formats is optional, so the copy to
+        // it converts. An sRGB scene gets an sRGB output, written through a UNORM view with the shaders encoding, so the
+        // output is encoded like the swap chain image it is tagged alongside
+        static VkFormat outputFormat(VkFormat _sceneFormat);
+
+        struct Stats
+        {
+            double m_gpuMs = 0.0; // Average GPU time of both passes
+            uint64_t m_frames = 0;
+        };
+
+        Upscaler(EngineDevice& _device);
+        ~Upscaler();
+
+        Upscaler(const Upscaler&) = delete;
+        Upscaler& operator=(const Upscaler&) = delete;
+
+        size_t getPreset() const { return m_preset; }
+        const Preset& getPresetInfo() const { return PRESETS[m_preset]; }
+        // Also restarts the stats
+        void setPreset(size_t _preset);
+
+        // At the start of each upscaled frame, before its output is handed out. Creates or resizes the slot's targets
+        // for _displayExtent, _sceneFormat and the current preset
+        void prepare(uint32_t _frameIndex, VkExtent2D _displayExtent, VkFormat _sceneFormat);
+        // Records both passes into the targets prepare() made, outside a render pass. _sceneColour is in
+        // TRANSFER_SRC_OPTIMAL, as the scene render pass leaves it, and only its top left _renderExtent is read.
+        // Leaves getOutputImage(_frameIndex) in TRANSFER_SRC_OPTIMAL
+        void record(VkCommandBuffer _commandBuffer, uint32_t _frameIndex, VkImage _sceneColour, VkImageView _sceneColourView,
+            VkExtent2D _renderExtent, VkExtent2D _displayExtent);
+
+        // Once the slot's previous frame has retired, adds its GPU time to the stats if it was upscaled
+        void resolveTiming(uint32_t _frameIndex);
+        Stats stats() const;
+
+        VkImage getOutputImage(uint32_t _frameIndex) const { return m_frames[_frameIndex].m_output.m_image; }
+        VkImageView getOutputImageView(uint32_t _frameIndex) const { return m_frames[_frameIndex].m_output.m_view; }
+        VkDeviceMemory getOutputImageMemory(uint32_t _frameIndex) const { return m_frames[_frameIndex].m_output.m_memory; }
+        VkFormat getOutputFormat(uint32_t _frameIndex) const { return m_frames[_frameIndex].m_output.m_format; }
+
+    private:
+        struct Target
+        {
+            VkImage m_image = VK_NULL_HANDLE;
+            VkDeviceMemory m_memory = VK_NULL_HANDLE;
+            VkImageView m_view = VK_NULL_HANDLE; // In m_format, sampled and tagged
+            VkImageView m_storageView = VK_NULL_HANDLE; // UNORM, written by the shaders. m_view when m_format is UNORM
+            VkExtent2D m_extent{};
+            VkFormat m_format = VK_FORMAT_UNDEFINED;
+        };
+
+        struct FrameResources
+        {
+            Target m_upscaled; // Upscale output, sharpened into m_output. Unused without sharpening
+            Target m_output;
+            VkDescriptorSet m_upscaleSet = VK_NULL_HANDLE;
+            VkDescriptorSet m_sharpenSet = VK_NULL_HANDLE;
+        };
+
+        void createPipelineLayout();
+        void createPipelines();
+        void createSampler();
+        // Recreates _target when it isn't _extent in size and _format. Its previous contents are parked until their frames retire
+        void reserve(Target& _target, VkExtent2D _extent, VkFormat _format);
+        void release(Target& _target);
+        void dispatch(VkCommandBuffer _commandBuffer, VkDescriptorSet _set, VkImageView _input, const Target& _output,
+            VkExtent2D _inputExtent, VkExtent2D _outputExtent, Pipeline& _pipeline);
+
+        EngineDevice& m_device;
+        std::unique_ptr<Pipeline> m_upscalePipeline;
+        std::unique_ptr<Pipeline> m_sharpenPipeline;
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        std::unique_ptr<DescriptorSetLayout> m_setLayout;
+        std::unique_ptr<DescriptorPool> m_pool;
+        VkSampler m_sampler = VK_NULL_HANDLE;
+
+        std::array<FrameResources, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frames;
+        size_t m_preset = 0;
+
+        GpuTimer m_gpuTimer;
+        double m_gpuTotal = 0.0;
+        uint64_t m_timedFrames = 0;
+    };
+}
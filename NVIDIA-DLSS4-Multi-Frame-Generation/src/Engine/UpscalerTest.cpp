@@ -0,0 +1,640 @@
+#include "UpscalerTest.h"
+#include "Upscaler.h"
+#include "Pipeline.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr uint32_t DISPLAY_WIDTH = 640;
+        constexpr uint32_t DISPLAY_HEIGHT = 360;
+        constexpr int SUPERSAMPLES = 4; // Per axis, so edges are antialiased the same at every resolution
+
+        // Lowest PSNR against the display size render each preset may reach on the test image, about 2 dB under
+        // what the shaders reach on it. Native is the reference itself
+        constexpr double MIN_PSNR[] = { 0.0, 30.0, 27.5, 25.0, 21.5 };
+        static_assert(std::size(MIN_PSNR) == std::size(Upscaler::PRESETS), "One PSNR floor per upscaler preset");
+        // Each preset must also beat a bilinear upscale of the same frame by this much
+        constexpr double MIN_GAIN_OVER_BILINEAR = 1.0;
+
+        // Matches local_size and Push in Upscale.comp and Sharpen.comp
+        constexpr uint32_t GROUP_SIZE = 8;
+        struct UpscalePushConstantData
+        {
+            glm::vec2 m_inputSize;
+            glm::vec2 m_outputSize;
+            float m_sharpness;
+            uint32_t m_encodeSrgb;
+        };
+
+        struct Image
+        {
+            uint32_t m_width = 0;
+            uint32_t m_height = 0;
+            std::vector<uint8_t> m_rgba;
+        };
+
+        // Test pattern over the unit square: a gradient, a rotated checkerboard, rings that get finer outwards,
+        // hard edged discs and thin lines
+        glm::vec3 sceneColour(float _u, float _v)
+        {
+            const float x = _u * (16.0f / 9.0f);
+            const float y = _v;
+            glm::vec3 colour{ 0.25f + 0.5f * _v, 0.3f + 0.4f * _u, 0.6f - 0.3f * _v };
+
+            const float cx = x * std::cos(0.3f) - y * std::sin(0.3f);
+            const float cy = x * std::sin(0.3f) + y * std::cos(0.3f);
+            if (x > 0.08f && x < 0.62f && y > 0.1f && y < 0.55f)
+            {
+                const bool light = (static_cast<int>(std::floor(cx * 24.0f) + std::floor(cy * 24.0f)) & 1) != 0;
+                colour = light ? glm::vec3(0.9f, 0.85f, 0.8f) : glm::vec3(0.1f, 0.12f, 0.15f);
+            }
+
+            const float distance = glm::length(glm::vec2(x - 1.25f, y - 0.5f));
+            if (distance < 0.36f)
+            {
+                const float ring = 0.5f + 0.5f * std::cos(distance * distance * 900.0f);
+                colour = { ring, ring * 0.8f, 0.2f + 0.6f * ring };
+            }
+
+            struct Disc { glm::vec2 m_centre; float m_radius; glm::vec3 m_colour; };
+            constexpr Disc DISCS[] = {
+                { { 0.3f, 0.78f }, 0.12f, { 0.95f, 0.3f, 0.1f } },
+                { { 0.62f, 0.8f }, 0.08f, { 0.1f, 0.7f, 0.3f } },
+                { { 1.62f, 0.15f }, 0.06f, { 0.05f, 0.05f, 0.05f } }
+            };
+            for (const Disc& disc : DISCS)
+            {
+                const glm::vec2 offset = glm::vec2(x, y) - disc.m_centre;
+                if (glm::dot(offset, offset) < disc.m_radius * disc.m_radius)
+                    colour = disc.m_colour;
+            }
+
+            const float stripe = (x + y * 0.5f) * 10.0f;
+            if (x > 0.7f && x < 0.95f && y > 0.6f && std::abs(stripe - std::floor(stripe) - 0.5f) < 0.04f)
+                colour = glm::vec3(1.0f);
+
+            return colour;
+        }
+
+        // The test pattern as the scene render pass would draw it at _width x _height
+        Image renderScene(uint32_t _width, uint32_t _height)
+        {
+            Image image{ _width, _height, std::vector<uint8_t>(size_t(_width) * _height * 4) };
+            for (uint32_t y = 0; y < _height; y++)
+            {
+                for (uint32_t x = 0; x < _width; x++)
+                {
+                    glm::vec3 sum{ 0.0f };
+                    for (int sy = 0; sy < SUPERSAMPLES; sy++)
+                        for (int sx = 0; sx < SUPERSAMPLES; sx++)
+                            sum += sceneColour((x + (sx + 0.5f) / SUPERSAMPLES) / _width, (y + (sy + 0.5f) / SUPERSAMPLES) / _height);
+
+                    const glm::vec3 colour = glm::clamp(sum / float(SUPERSAMPLES * SUPERSAMPLES), 0.0f, 1.0f);
+                    uint8_t* texel = &image.m_rgba[(size_t(y) * _width + x) * 4];
+                    for (int channel = 0; channel < 3; channel++)
+                        texel[channel] = static_cast<uint8_t>(colour[channel] * 255.0f + 0.5f);
+                    texel[3] = 255;
+                }
+            }
+            return image;
+        }
+
+        // Baseline to beat, what a plain linear blit to the display size gives
+        Image bilinearUpscale(const Image& _source, uint32_t _width, uint32_t _height)
+        {
+            Image image{ _width, _height, std::vector<uint8_t>(size_t(_width) * _height * 4) };
+            auto at = [&_source](uint32_t _x, uint32_t _y, int _channel)
+                { return static_cast<float>(_source.m_rgba[(size_t(_y) * _source.m_width + _x) * 4 + _channel]); };
+
+            for (uint32_t y = 0; y < _height; y++)
+            {
+                const float py = std::clamp((y + 0.5f) * _source.m_height / _height - 0.5f, 0.0f, float(_source.m_height - 1));
+                const uint32_t y0 = static_cast<uint32_t>(py);
+                const uint32_t y1 = std::min(y0 + 1, _source.m_height - 1);
+                const float fy = py - y0;
+                for (uint32_t x = 0; x < _width; x++)
+                {
+                    const float px = std::clamp((x + 0.5f) * _source.m_width / _width - 0.5f, 0.0f, float(_source.m_width - 1));
+                    const uint32_t x0 = static_cast<uint32_t>(px);
+                    const uint32_t x1 = std::min(x0 + 1, _source.m_width - 1);
+                    const float fx = px - x0;
+
+                    uint8_t* texel = &image.m_rgba[(size_t(y) * _width + x) * 4];
+                    for (int channel = 0; channel < 3; channel++)
+                    {
+                        const float top = at(x0, y0, channel) * (1.0f - fx) + at(x1, y0, channel) * fx;
+                        const float bottom = at(x0, y1, channel) * (1.0f - fx) + at(x1, y1, channel) * fx;
+                        texel[channel] = static_cast<uint8_t>(top * (1.0f - fy) + bottom * fy + 0.5f);
+                    }
+                    texel[3] = 255;
+                }
+            }
+            return image;
+        }
+
+        // Over RGB. Infinite when the images match
+        double psnr(const Image& _image, const Image& _reference)
+        {
+            double squaredError = 0.0;
+            for (size_t texel = 0; texel < _image.m_rgba.size(); texel += 4)
+            {
+                for (size_t channel = 0; channel < 3; channel++)
+                {
+                    const double difference = double(_image.m_rgba[texel + channel]) - _reference.m_rgba[texel + channel];
+                    squaredError += difference * difference;
+                }
+            }
+            const double meanSquaredError = squaredError / (_image.m_rgba.size() / 4 * 3);
+            return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : INFINITY;
+        }
+
+        void check(VkResult _result, const char* _what)
+        {
+            if (_result != VK_SUCCESS)
+                throw std::runtime_error(std::string("Upscaler test: failed to ") + _what + "!");
+        }
+
+        // Just enough Vulkan to run the two compute passes and read the result back
+        struct ComputeContext
+        {
+            struct Target
+            {
+                VkImage m_image = VK_NULL_HANDLE;
+                VkDeviceMemory m_memory = VK_NULL_HANDLE;
+                VkImageView m_view = VK_NULL_HANDLE;
+            };
+
+            ComputeContext()
+            {
+                createDevice();
+                createPipelines();
+                createStaging();
+            }
+
+            ~ComputeContext()
+            {
+                if (m_device == VK_NULL_HANDLE)
+                {
+                    if (m_instance != VK_NULL_HANDLE) vkDestroyInstance(m_instance, nullptr);
+                    return;
+                }
+                vkDeviceWaitIdle(m_device);
+                vkUnmapMemory(m_device, m_stagingMemory);
+                vkDestroyBuffer(m_device, m_staging, nullptr);
+                vkFreeMemory(m_device, m_stagingMemory, nullptr);
+                vkDestroyPipeline(m_device, m_upscalePipeline, nullptr);
+                vkDestroyPipeline(m_device, m_sharpenPipeline, nullptr);
+                vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+                vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+                vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+                vkDestroySampler(m_device, m_sampler, nullptr);
+                vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+                vkDestroyDevice(m_device, nullptr);
+                vkDestroyInstance(m_instance, nullptr);
+            }
+
+            ComputeContext(const ComputeContext&) = delete;
+            ComputeContext& operator=(const ComputeContext&) = delete;
+
+            // Upscales _input to _width x _height, then sharpens it when _sharpness is above 0
+            Image upscale(const Image& _input, uint32_t _width, uint32_t _height, float _sharpness)
+            {
+                const bool sharpen = _sharpness > 0.0f;
+                Target input = createTarget(_input.m_width, _input.m_height, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+                Target upscaled = createTarget(_width, _height, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+                Target output = createTarget(_width, _height, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+                Target& upscaleOutput = sharpen ? upscaled : output;
+
+                std::memcpy(m_stagingMapped, _input.m_rgba.data(), _input.m_rgba.size());
+
+                VkCommandBuffer commandBuffer = beginCommands();
+                barrier(commandBuffer, input.m_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+                VkBufferImageCopy region = copyRegion(_input.m_width, _input.m_height);
+                vkCmdCopyBufferToImage(commandBuffer, m_staging, input.m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+                barrier(commandBuffer, input.m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+                barrier(commandBuffer, upscaleOutput.m_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                    0, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+                dispatch(commandBuffer, m_sets[0], input.m_view, upscaleOutput.m_view, { _input.m_width, _input.m_height },
+                    { _width, _height }, _sharpness, m_upscalePipeline);
+
+                if (sharpen)
+                {
+                    barrier(commandBuffer, upscaled.m_image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+                    barrier(commandBuffer, output.m_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                        0, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+                    dispatch(commandBuffer, m_sets[1], upscaled.m_view, output.m_view, { _width, _height }, { _width, _height },
+                        _sharpness, m_sharpenPipeline);
+                }
+
+                barrier(commandBuffer, output.m_image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+                region = copyRegion(_width, _height);
+                vkCmdCopyImageToBuffer(commandBuffer, output.m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_staging, 1, &region);
+
+                VkBufferMemoryBarrier toHost{};
+                toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+                toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                toHost.buffer = m_staging;
+                toHost.size = VK_WHOLE_SIZE;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                    0, nullptr, 1, &toHost, 0, nullptr);
+                submitAndWait(commandBuffer);
+
+                Image result{ _width, _height };
+                const uint8_t* texels = static_cast<const uint8_t*>(m_stagingMapped);
+                result.m_rgba.assign(texels, texels + size_t(_width) * _height * 4);
+
+                destroyTarget(input);
+                destroyTarget(upscaled);
+                destroyTarget(output);
+                return result;
+            }
+
+        private:
+            void createDevice()
+            {
+                VkApplicationInfo appInfo{};
+                appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+                appInfo.pApplicationName = "Upscaler test";
+                appInfo.apiVersion = VK_API_VERSION_1_3;
+
+                VkInstanceCreateInfo instanceInfo{};
+                instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+                instanceInfo.pApplicationInfo = &appInfo;
+                check(vkCreateInstance(&instanceInfo, nullptr, &m_instance), "create an instance");
+
+                uint32_t deviceCount = 0;
+                vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr);
+                std::vector<VkPhysicalDevice> devices(deviceCount);
+                vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
+
+                for (VkPhysicalDevice device : devices)
+                {
+                    uint32_t familyCount = 0;
+                    vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
+                    std::vector<VkQueueFamilyProperties> families(familyCount);
+                    vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
+                    for (uint32_t family = 0; family < familyCount; family++)
+                    {
+                        if (families[family].queueFlags & VK_QUEUE_COMPUTE_BIT)
+                        {
+                            m_physicalDevice = device;
+                            m_queueFamily = family;
+                            break;
+                        }
+                    }
+                    if (m_physicalDevice != VK_NULL_HANDLE) break;
+                }
+                if (m_physicalDevice == VK_NULL_HANDLE)
+                    throw std::runtime_error("Upscaler test: no Vulkan device with a compute queue!");
+
+                VkPhysicalDeviceProperties properties;
+                vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+                std::printf("Upscaler test on %s\n", properties.deviceName);
+                vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+
+                const float priority = 1.0f;
+                VkDeviceQueueCreateInfo queueInfo{};
+                queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+                queueInfo.queueFamilyIndex = m_queueFamily;
+                queueInfo.queueCount = 1;
+                queueInfo.pQueuePriorities = &priority;
+
+                VkDeviceCreateInfo deviceInfo{};
+                deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+                deviceInfo.queueCreateInfoCount = 1;
+                deviceInfo.pQueueCreateInfos = &queueInfo;
+                check(vkCreateDevice(m_physicalDevice, &deviceInfo, nullptr, &m_device), "create a device");
+                vkGetDeviceQueue(m_device, m_queueFamily, 0, &m_queue);
+
+                VkCommandPoolCreateInfo poolInfo{};
+                poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+                poolInfo.queueFamilyIndex = m_queueFamily;
+                poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+                check(vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool), "create a command pool");
+            }
+
+            void createPipelines()
+            {
+                // Same bindings and sampler as Upscaler
+                std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+                bindings[0] = { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+                bindings[1] = { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+                VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+                setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+                setLayoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+                setLayoutInfo.pBindings = bindings.data();
+                check(vkCreateDescriptorSetLayout(m_device, &setLayoutInfo, nullptr, &m_setLayout), "create a descriptor set layout");
+
+                std::array<VkDescriptorPoolSize, 2> poolSizes = { {
+                    { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 },
+                    { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2 }
+                } };
+                VkDescriptorPoolCreateInfo poolInfo{};
+                poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+                poolInfo.maxSets = 2;
+                poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+                poolInfo.pPoolSizes = poolSizes.data();
+                check(vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool), "create a descriptor pool");
+
+                std::array<VkDescriptorSetLayout, 2> layouts = { m_setLayout, m_setLayout };
+                VkDescriptorSetAllocateInfo allocInfo{};
+                allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+                allocInfo.descriptorPool = m_descriptorPool;
+                allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+                allocInfo.pSetLayouts = layouts.data();
+                check(vkAllocateDescriptorSets(m_device, &allocInfo, m_sets.data()), "allocate descriptor sets");
+
+                VkPushConstantRange pushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(UpscalePushConstantData) };
+                VkPipelineLayoutCreateInfo layoutInfo{};
+                layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+                layoutInfo.setLayoutCount = 1;
+                layoutInfo.pSetLayouts = &m_setLayout;
+                layoutInfo.pushConstantRangeCount = 1;
+                layoutInfo.pPushConstantRanges = &pushConstantRange;
+                check(vkCreatePipelineLayout(m_device, &layoutInfo, nullptr, &m_pipelineLayout), "create a pipeline layout");
+
+                m_upscalePipeline = createPipeline("Shaders/Upscale.comp.spv");
+                m_sharpenPipeline = createPipeline("Shaders/Sharpen.comp.spv");
+
+                VkSamplerCreateInfo samplerInfo{};
+                samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+                samplerInfo.magFilter = VK_FILTER_NEAREST;
+                samplerInfo.minFilter = VK_FILTER_NEAREST;
+                samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+                samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+                samplerInfo.addressModeV = samplerInfo.addressModeU;
+                samplerInfo.addressModeW = samplerInfo.addressModeU;
+                samplerInfo.maxAnisotropy = 1.0f;
+                check(vkCreateSampler(m_device, &samplerInfo, nullptr, &m_sampler), "create a sampler");
+            }
+
+            // Pipeline wants an EngineDevice, which needs a window surface, so this builds the same compute pipeline itself
+            VkPipeline createPipeline(const std::string& _compFilePath)
+            {
+                const std::vector<char> code = Pipeline::readFile(_compFilePath);
+                VkShaderModuleCreateInfo moduleInfo{};
+                moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+                moduleInfo.codeSize = code.size();
+                moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+                VkShaderModule module = VK_NULL_HANDLE;
+                check(vkCreateShaderModule(m_device, &moduleInfo, nullptr, &module), "create a shader module");
+
+                VkComputePipelineCreateInfo pipelineInfo{};
+                pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+                pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+                pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+                pipelineInfo.stage.module = module;
+                pipelineInfo.stage.pName = "main";
+                pipelineInfo.layout = m_pipelineLayout;
+                VkPipeline pipeline = VK_NULL_HANDLE;
+                const VkResult result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+                vkDestroyShaderModule(m_device, module, nullptr);
+                check(result, "create a compute pipeline");
+                return pipeline;
+            }
+
+            // Large enough for the display size image, uploads and readbacks both go through it
+            void createStaging()
+            {
+                const VkDeviceSize size = VkDeviceSize(DISPLAY_WIDTH) * DISPLAY_HEIGHT * 4;
+                VkBufferCreateInfo bufferInfo{};
+                bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+                bufferInfo.size = size;
+                bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+                bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                check(vkCreateBuffer(m_device, &bufferInfo, nullptr, &m_staging), "create the staging buffer");
+
+                VkMemoryRequirements requirements;
+                vkGetBufferMemoryRequirements(m_device, m_staging, &requirements);
+                m_stagingMemory = allocate(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+                check(vkBindBufferMemory(m_device, m_staging, m_stagingMemory, 0), "bind the staging buffer");
+                check(vkMapMemory(m_device, m_stagingMemory, 0, VK_WHOLE_SIZE, 0, &m_stagingMapped), "map the staging buffer");
+            }
+
+            VkDeviceMemory allocate(const VkMemoryRequirements& _requirements, VkMemoryPropertyFlags _properties)
+            {
+                for (uint32_t type = 0; type < m_memoryProperties.memoryTypeCount; type++)
+                {
+                    if ((_requirements.memoryTypeBits & (1u << type)) &&
+                        (m_memoryProperties.memoryTypes[type].propertyFlags & _properties) == _properties)
+                    {
+                        VkMemoryAllocateInfo allocInfo{};
+                        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+                        allocInfo.allocationSize = _requirements.size;
+                        allocInfo.memoryTypeIndex = type;
+                        VkDeviceMemory memory = VK_NULL_HANDLE;
+                        check(vkAllocateMemory(m_device, &allocInfo, nullptr, &memory), "allocate memory");
+                        return memory;
+                    }
+                }
+                throw std::runtime_error("Upscaler test: no suitable memory type!");
+            }
+
+            Target createTarget(uint32_t _width, uint32_t _height, VkImageUsageFlags _usage)
+            {
+                Target target;
+                VkImageCreateInfo imageInfo{};
+                imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                imageInfo.imageType = VK_IMAGE_TYPE_2D;
+                imageInfo.extent = { _width, _height, 1 };
+                imageInfo.mipLevels = 1;
+                imageInfo.arrayLayers = 1;
+                imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+                imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+                imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                imageInfo.usage = _usage;
+                imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+                imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                check(vkCreateImage(m_device, &imageInfo, nullptr, &target.m_image), "create an image");
+
+                VkMemoryRequirements requirements;
+                vkGetImageMemoryRequirements(m_device, target.m_image, &requirements);
+                target.m_memory = allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                check(vkBindImageMemory(m_device, target.m_image, target.m_memory, 0), "bind image memory");
+
+                VkImageViewCreateInfo viewInfo{};
+                viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                viewInfo.image = target.m_image;
+                viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                viewInfo.format = imageInfo.format;
+                viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+                check(vkCreateImageView(m_device, &viewInfo, nullptr, &target.m_view), "create an image view");
+                return target;
+            }
+
+            void destroyTarget(Target& _target)
+            {
+                vkDestroyImageView(m_device, _target.m_view, nullptr);
+                vkDestroyImage(m_device, _target.m_image, nullptr);
+                vkFreeMemory(m_device, _target.m_memory, nullptr);
+                _target = Target{};
+            }
+
+            static VkBufferImageCopy copyRegion(uint32_t _width, uint32_t _height)
+            {
+                VkBufferImageCopy region{};
+                region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+                region.imageExtent = { _width, _height, 1 };
+                return region;
+            }
+
+            static void barrier(VkCommandBuffer _commandBuffer, VkImage _image, VkImageLayout _oldLayout, VkImageLayout _newLayout,
+                VkAccessFlags _srcAccess, VkAccessFlags _dstAccess, VkPipelineStageFlags _srcStage, VkPipelineStageFlags _dstStage)
+            {
+                VkImageMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = _image;
+                barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+                barrier.oldLayout = _oldLayout;
+                barrier.newLayout = _newLayout;
+                barrier.srcAccessMask = _srcAccess;
+                barrier.dstAccessMask = _dstAccess;
+                vkCmdPipelineBarrier(_commandBuffer, _srcStage, _dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+            }
+
+            void dispatch(VkCommandBuffer _commandBuffer, VkDescriptorSet _set, VkImageView _input, VkImageView _output,
+                VkExtent2D _inputExtent, VkExtent2D _outputExtent, float _sharpness, VkPipeline _pipeline)
+            {
+                VkDescriptorImageInfo inputInfo{ m_sampler, _input, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+                VkDescriptorImageInfo outputInfo{ VK_NULL_HANDLE, _output, VK_IMAGE_LAYOUT_GENERAL };
+                std::array<VkWriteDescriptorSet, 2> writes{};
+                for (uint32_t binding = 0; binding < writes.size(); binding++)
+                {
+                    writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    writes[binding].dstSet = _set;
+                    writes[binding].dstBinding = binding;
+                    writes[binding].descriptorCount = 1;
+                }
+                writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                writes[0].pImageInfo = &inputInfo;
+                writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                writes[1].pImageInfo = &outputInfo;
+                vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+                vkCmdBindPipeline(_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+                vkCmdBindDescriptorSets(_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &_set, 0, nullptr);
+
+                UpscalePushConstantData push{};
+                push.m_inputSize = glm::vec2(_inputExtent.width, _inputExtent.height);
+                push.m_outputSize = glm::vec2(_outputExtent.width, _outputExtent.height);
+                push.m_sharpness = _sharpness;
+                vkCmdPushConstants(_commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(UpscalePushConstantData), &push);
+
+                vkCmdDispatch(_commandBuffer, (_outputExtent.width + GROUP_SIZE - 1) / GROUP_SIZE, (_outputExtent.height + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+            }
+
+            VkCommandBuffer beginCommands()
+            {
+                VkCommandBufferAllocateInfo allocInfo{};
+                allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                allocInfo.commandPool = m_commandPool;
+                allocInfo.commandBufferCount = 1;
+                VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+                check(vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer), "allocate a command buffer");
+
+                VkCommandBufferBeginInfo beginInfo{};
+                beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                check(vkBeginCommandBuffer(commandBuffer, &beginInfo), "begin a command buffer");
+                return commandBuffer;
+            }
+
+            void submitAndWait(VkCommandBuffer _commandBuffer)
+            {
+                check(vkEndCommandBuffer(_commandBuffer), "record a command buffer");
+
+                VkSubmitInfo submitInfo{};
+                submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submitInfo.commandBufferCount = 1;
+                submitInfo.pCommandBuffers = &_commandBuffer;
+                check(vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE), "submit");
+                check(vkQueueWaitIdle(m_queue), "wait for the queue");
+                vkFreeCommandBuffers(m_device, m_commandPool, 1, &_commandBuffer);
+            }
+
+            VkInstance m_instance = VK_NULL_HANDLE;
+            VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+            VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+            uint32_t m_queueFamily = 0;
+            VkDevice m_device = VK_NULL_HANDLE;
+            VkQueue m_queue = VK_NULL_HANDLE;
+            VkCommandPool m_commandPool = VK_NULL_HANDLE;
+
+            VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+            VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+            std::array<VkDescriptorSet, 2> m_sets{}; // Upscale, sharpen
+            VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+            VkPipeline m_upscalePipeline = VK_NULL_HANDLE;
+            VkPipeline m_sharpenPipeline = VK_NULL_HANDLE;
+            VkSampler m_sampler = VK_NULL_HANDLE;
+
+            VkBuffer m_staging = VK_NULL_HANDLE;
+            VkDeviceMemory m_stagingMemory = VK_NULL_HANDLE;
+            void* m_stagingMapped = nullptr;
+        };
+    }
+
+    namespace UpscalerTest
+    {
+        int run()
+        {
+            try
+            {
+                ComputeContext context;
+                const Image native = renderScene(DISPLAY_WIDTH, DISPLAY_HEIGHT);
+
+                std::printf("%-14s %10s %9s %12s %12s %10s %s\n", "preset", "render", "sharpness", "PSNR dB", "bilinear dB", "floor dB", "result");
+                bool passed = true;
+                for (size_t preset = 1; preset < std::size(Upscaler::PRESETS); preset++)
+                {
+                    // Sized like Renderer::beginFrame sizes the render extent
+                    const Upscaler::Preset& info = Upscaler::PRESETS[preset];
+                    const uint32_t width = std::max(1u, static_cast<uint32_t>(DISPLAY_WIDTH * info.m_renderScale + 0.5f));
+                    const uint32_t height = std::max(1u, static_cast<uint32_t>(DISPLAY_HEIGHT * info.m_renderScale + 0.5f));
+                    const Image rendered = renderScene(width, height);
+
+                    const double upscaled = psnr(context.upscale(rendered, DISPLAY_WIDTH, DISPLAY_HEIGHT, info.m_sharpness), native);
+                    const double bilinear = psnr(bilinearUpscale(rendered, DISPLAY_WIDTH, DISPLAY_HEIGHT), native);
+                    const bool ok = upscaled >= MIN_PSNR[preset] && upscaled >= bilinear + MIN_GAIN_OVER_BILINEAR;
+                    passed = passed && ok;
+
+                    char extent[32];
+                    std::snprintf(extent, sizeof(extent), "%ux%u", width, height);
+                    std::printf("%-14s %10s %9.2f %12.2f %12.2f %10.2f %s\n", info.m_name, extent, info.m_sharpness,
+                        upscaled, bilinear, MIN_PSNR[preset], ok ? "pass" : "FAIL");
+                }
+
+                std::printf("Upscaler test %s\n", passed ? "passed" : "FAILED");
+                return passed ? 0 : 1;
+            }
+            catch (const std::exception& e)
+            {
+                std::printf("%s\n", e.what());
+                return 1;
+            }
+        }
+    }
+}
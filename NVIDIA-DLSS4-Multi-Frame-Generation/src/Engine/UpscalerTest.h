@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Engine
+{
+    /*
+     * Offscreen image quality test of the upscaler's shaders, run with "--upscaler-test" instead of opening the window.
+     * It only needs a Vulkan device with a compute queue, no window, swap chain or Streamline, so it also runs on a
+     * software implementation such as lavapipe.
+     */
+    namespace UpscalerTest
+    {
+        // Renders a fixed test image at the display size and at each preset's render scale, upscales the smaller ones
+        // with Upscale.comp and Sharpen.comp and compares each result against the display size render. Returns the
+        // process exit code, 0 when every preset reaches its PSNR floor and beats a bilinear upscale of the same frame
+        int run();
+    }
+}
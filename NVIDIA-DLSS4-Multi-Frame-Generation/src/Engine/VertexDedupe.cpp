@@ -0,0 +1,98 @@
+#include "VertexDedupe.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr size_t VERTEX_WORDS = sizeof(Model::Vertex) / sizeof(uint32_t);
+        static_assert(sizeof(Model::Vertex) == 11 * sizeof(float), "Vertex is hashed as raw bytes, it can't have padding");
+
+        uint32_t foldHash(uint64_t _hash)
+        {
+            return static_cast<uint32_t>(_hash ^ (_hash >> 32));
+        }
+    }
+
+    VertexDedupe::VertexDedupe(std::vector<Model::Vertex>& _outVertices, size_t _indexCount)
+        : m_vertices(_outVertices)
+    {
+        // Closed meshes average around one unique vertex per six indices, so half the index
+        // count keeps the load low and only triangle soup ever has to grow
+        size_t capacity = 64;
+        while (capacity < _indexCount / 2) capacity *= 2;
+
+        m_slots.assign(capacity, Slot{ 0, EMPTY });
+        m_mask = static_cast<uint32_t>(capacity - 1);
+        m_vertices.reserve(m_vertices.size() + std::min(_indexCount, capacity / 2));
+    }
+
+    uint32_t VertexDedupe::insert(const Model::Vertex& _vertex)
+    {
+        if ((m_count + 1) * 4 > m_slots.size() * 3)
+            grow();
+
+        const uint32_t hashValue = foldHash(hash(_vertex));
+        for (uint32_t slot = hashValue & m_mask;; slot = (slot + 1) & m_mask)
+        {
+            Slot& entry = m_slots[slot];
+            if (entry.m_index == EMPTY)
+            {
+                entry.m_hash = hashValue;
+                entry.m_index = static_cast<uint32_t>(m_vertices.size());
+                m_vertices.push_back(_vertex);
+                m_count++;
+                return entry.m_index;
+            }
+            if (entry.m_hash == hashValue && m_vertices[entry.m_index] == _vertex)
+                return entry.m_index;
+        }
+    }
+
+    uint64_t VertexDedupe::hash(const Model::Vertex& _vertex)
+    {
+        uint32_t words[VERTEX_WORDS];
+        std::memcpy(words, &_vertex, sizeof(words));
+
+        uint64_t hashValue = 0;
+        for (size_t i = 0; i < VERTEX_WORDS; i += 2)
+        {
+            uint32_t low = words[i];
+            uint32_t high = i + 1 < VERTEX_WORDS ? words[i + 1] : 0;
+            // Only the sign bit set means -0.0
+            if ((low << 1) == 0) low = 0;
+            if ((high << 1) == 0) high = 0;
+
+            uint64_t lane = (uint64_t(high) << 32) | low;
+            hashValue = ((hashValue << 5) | (hashValue >> 59)) ^ lane;
+            hashValue *= 0x9e3779b97f4a7c15ull;
+        }
+
+        // Final avalanche (murmur3 fmix64) so the low bits used for the slot are well mixed
+        hashValue ^= hashValue >> 33;
+        hashValue *= 0xff51afd7ed558ccdull;
+        hashValue ^= hashValue >> 33;
+        hashValue *= 0xc4ceb9fe1a85ec53ull;
+        hashValue ^= hashValue >> 33;
+        return hashValue;
+    }
+
+    void VertexDedupe::grow()
+    {
+        std::vector<Slot> oldSlots(m_slots.size() * 2, Slot{ 0, EMPTY });
+        oldSlots.swap(m_slots);
+        m_mask = static_cast<uint32_t>(m_slots.size() - 1);
+
+        // Hashes are kept in the slots, so rehashing never touches the vertices
+        for (const Slot& entry : oldSlots)
+        {
+            if (entry.m_index == EMPTY) continue;
+            uint32_t slot = entry.m_hash & m_mask;
+            while (m_slots[slot].m_index != EMPTY)
+                slot = (slot + 1) & m_mask;
+            m_slots[slot] = entry;
+        }
+    }
+}
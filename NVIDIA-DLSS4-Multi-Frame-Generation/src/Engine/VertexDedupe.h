@@ -0,0 +1,44 @@
+#pragma once
+#include "ModelHandler.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    /*
+     * Maps each Model::Vertex to an index in an output vertex array, appending the ones it
+     * hasn't seen. Open addressing with linear probing: a slot is the vertex's 32 bit hash and
+     * its index, so a probe only reads the vertex array when the hashes match. Find and insert
+     * share one probe. Matches Vertex::operator==, so results are the same as a std::unordered_map.
+     */
+    struct VertexDedupe
+    {
+        // Presized from _indexCount, which bounds the number of unique vertices
+        VertexDedupe(std::vector<Model::Vertex>& _outVertices, size_t _indexCount);
+
+        VertexDedupe(const VertexDedupe&) = delete;
+        VertexDedupe& operator=(const VertexDedupe&) = delete;
+
+        uint32_t insert(const Model::Vertex& _vertex);
+
+        // Over the raw vertex bytes, with -0.0 folded into 0.0 since they compare equal
+        static uint64_t hash(const Model::Vertex& _vertex);
+
+    private:
+        static constexpr uint32_t EMPTY = UINT32_MAX;
+
+        struct Slot
+        {
+            uint32_t m_hash;
+            uint32_t m_index;
+        };
+
+        void grow();
+
+        std::vector<Model::Vertex>& m_vertices;
+        std::vector<Slot> m_slots;
+        uint32_t m_mask = 0;
+        size_t m_count = 0;
+    };
+}
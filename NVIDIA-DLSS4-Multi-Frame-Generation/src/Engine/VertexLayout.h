@@ -0,0 +1,98 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    // Packed attribute storage. The Vulkan format of an attribute is derived from its type
+    struct UNorm16x4 { uint16_t m_value[4]; };
+    struct SNorm16x2 { int16_t m_value[2]; };
+    struct Half2 { uint16_t m_value[2]; };
+    struct UNorm8x4 { uint8_t m_value[4]; };
+
+    template<typename T> struct VertexFormat; // No definition: unsupported attribute types fail to compile
+    template<> struct VertexFormat<float> { static constexpr VkFormat value = VK_FORMAT_R32_SFLOAT; };
+    template<> struct VertexFormat<glm::vec2> { static constexpr VkFormat value = VK_FORMAT_R32G32_SFLOAT; };
+    template<> struct VertexFormat<glm::vec3> { static constexpr VkFormat value = VK_FORMAT_R32G32B32_SFLOAT; };
+    template<> struct VertexFormat<glm::vec4> { static constexpr VkFormat value = VK_FORMAT_R32G32B32A32_SFLOAT; };
+    template<> struct VertexFormat<UNorm16x4> { static constexpr VkFormat value = VK_FORMAT_R16G16B16A16_UNORM; };
+    template<> struct VertexFormat<SNorm16x2> { static constexpr VkFormat value = VK_FORMAT_R16G16_SNORM; };
+    template<> struct VertexFormat<Half2> { static constexpr VkFormat value = VK_FORMAT_R16G16_SFLOAT; };
+    template<> struct VertexFormat<UNorm8x4> { static constexpr VkFormat value = VK_FORMAT_R8G8B8A8_UNORM; };
+
+    template<typename T>
+    constexpr VkVertexInputAttributeDescription vertexAttribute(uint32_t _location, uint32_t _offset)
+    {
+        return { _location, 0, VertexFormat<T>::value, _offset };
+    }
+
+    // Attribute description for a vertex member, format and offset taken from the member itself
+    #define VERTEX_ATTRIBUTE(_location, _vertex, _member) \
+        ::Engine::vertexAttribute<decltype(_vertex::_member)>(_location, static_cast<uint32_t>(offsetof(_vertex, _member)))
+
+    /*
+     * One vertex buffer binding. Vertex must provide a constexpr static attributes()
+     * returning a std::array of VkVertexInputAttributeDescription built with VERTEX_ATTRIBUTE.
+     */
+    template<typename Vertex, uint32_t Binding, VkVertexInputRate InputRate = VK_VERTEX_INPUT_RATE_VERTEX>
+    struct VertexStream
+    {
+        using VertexType = Vertex;
+        static constexpr uint32_t BINDING = Binding;
+        static constexpr VkVertexInputRate INPUT_RATE = InputRate;
+        static constexpr auto ATTRIBUTES = Vertex::attributes();
+    };
+
+    namespace detail
+    {
+        template<typename... Streams>
+        constexpr auto concatAttributes()
+        {
+            std::array<VkVertexInputAttributeDescription, (Streams::ATTRIBUTES.size() + ...)> result{};
+            size_t count = 0;
+            auto append = [&](const auto& _attributes, uint32_t _binding)
+            {
+                for (const VkVertexInputAttributeDescription& attribute : _attributes)
+                {
+                    result[count] = attribute;
+                    result[count].binding = _binding;
+                    count++;
+                }
+            };
+            (append(Streams::ATTRIBUTES, Streams::BINDING), ...);
+            return result;
+        }
+
+        template<size_t N>
+        constexpr bool uniqueLocations(const std::array<VkVertexInputAttributeDescription, N>& _attributes)
+        {
+            for (size_t i = 0; i < N; i++)
+                for (size_t j = i + 1; j < N; j++)
+                    if (_attributes[i].location == _attributes[j].location) return false;
+            return true;
+        }
+    }
+
+    // Binding and attribute descriptions for a set of streams, built at compile time
+    template<typename... Streams>
+    struct VertexLayout
+    {
+        static constexpr std::array<VkVertexInputBindingDescription, sizeof...(Streams)> BINDINGS{ {
+            { Streams::BINDING, static_cast<uint32_t>(sizeof(typename Streams::VertexType)), Streams::INPUT_RATE }...
+        } };
+        static constexpr auto ATTRIBUTES = detail::concatAttributes<Streams...>();
+
+        static_assert(detail::uniqueLocations(ATTRIBUTES), "Vertex attribute locations must be unique");
+
+        static std::vector<VkVertexInputBindingDescription> getBindingDescriptions() { return { BINDINGS.begin(), BINDINGS.end() }; }
+        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions() { return { ATTRIBUTES.begin(), ATTRIBUTES.end() }; }
+    };
+}
@@ -1,16 +1,113 @@
 // Engine Core
 #include "Core.h" 
+#include "AllocationCounter.h"
+#include "Benchmark.h"
+#include "MeshCache.h"
+#include "TextureCompressor.h"
+#include "UpscalerTest.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cstdlib>
 
 // Namespace from the custom engine for readability
 using namespace Engine; 
-int main() 
+int main(int argc, char** argv) 
 {
+    // Headless benchmarks, no window or device needed
+    if (argc >= 2 && std::string(argv[1]) == "--bench")
+    {
+        return Benchmark::run(argc >= 3 ? argv[2] : "", std::vector<std::string>(argv + std::min(argc, 3), argv + argc));
+    }
+
+    // Offscreen image quality check of each upscaler preset, fails below a PSNR floor: --upscaler-test
+    if (argc >= 2 && std::string(argv[1]) == "--upscaler-test")
+    {
+        return UpscalerTest::run();
+    }
+
+    // Offline mesh cache conversion: --bake-meshes <file.obj>...
+    if (argc >= 2 && std::string(argv[1]) == "--bake-meshes")
+    {
+        bool success = true;
+        for (int i = 2; i < argc; i++)
+            success = MeshCache::bake(argv[i]) && success;
+        return success ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Offline texture conversion to KTX2: --compress-texture [--format bc1|bc3|bc7|rgba8] <image>...
+    if (argc >= 2 && std::string(argv[1]) == "--compress-texture")
+    {
+        TextureCompressor::Format format = TextureCompressor::Format::BC7;
+        int first = 2;
+        if (argc >= 4 && std::string(argv[2]) == "--format")
+        {
+            if (!TextureCompressor::parseFormat(argv[3], format))
+            {
+                std::cerr << "Unknown texture format " << argv[3] << std::endl;
+                return EXIT_FAILURE;
+            }
+            first = 4;
+        }
+
+        bool success = true;
+        for (int i = first; i < argc; i++)
+            success = TextureCompressor::compressFile(argv[i], format) && success;
+        return success ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     // Initialize the engine core
     Core engineCore(std::make_shared<EngineWindow>(Core::WIDTH, Core::HEIGHT, "Vulkan Engine"));
 
+    // Latency against FPS for each frame pacing profile or present mode, with and without frame generation:
+    // --pacing-sweep [seconds per step], --present-sweep [seconds per step]
+    if (argc >= 2 && (std::string(argv[1]) == "--pacing-sweep" || std::string(argv[1]) == "--present-sweep"))
+    {
+        Core::Sweep sweep = std::string(argv[1]) == "--pacing-sweep" ? Core::Sweep::FramePacing : Core::Sweep::PresentModes;
+        engineCore.enableSweep(sweep, argc >= 3 ? std::max(1.0f, static_cast<float>(std::atof(argv[2]))) : 10.0f);
+    }
+
+    // Latency against FPS for each frame pacing profile, without the latency limiter and with it: --latency-sweep [seconds per step]
+    if (argc >= 2 && std::string(argv[1]) == "--latency-sweep")
+    {
+        engineCore.enableSweep(Core::Sweep::LatencyLimiter, argc >= 3 ? std::max(1.0f, static_cast<float>(std::atof(argv[2]))) : 10.0f);
+    }
+
+    // Render resolution scaled to hold a GPU frame time: --dynamic-resolution [target ms]
+    if (argc >= 2 && std::string(argv[1]) == "--dynamic-resolution")
+    {
+        engineCore.enableDynamicResolution(argc >= 3 ? std::max(1.0, std::atof(argv[2])) : 1000.0 / 120.0);
+    }
+
+    // Scene drawn below display resolution and upscaled: --upscaler <preset, 0 native to 4 performance>
+    if (argc >= 3 && std::string(argv[1]) == "--upscaler")
+    {
+        engineCore.enableUpscalerPreset(static_cast<size_t>(std::max(0, std::atoi(argv[2]))));
+    }
+
+    // Worst frame time during a resize storm, full swap chain rebuilds against the fast path: --resize-bench [seconds per phase]
+    if (argc >= 2 && std::string(argv[1]) == "--resize-bench")
+    {
+        engineCore.enableResizeBenchmark(argc >= 3 ? std::max(1.0f, static_cast<float>(std::atof(argv[2]))) : 10.0f);
+    }
+
+    // Image quality of each upscaler preset against native in the scene itself, on one fixed view: --upscaler-scene-test
+    if (argc >= 2 && std::string(argv[1]) == "--upscaler-scene-test")
+    {
+        engineCore.enableUpscalerTest();
+    }
+
+    // Fails when a frame still allocates from the global heap once warmed up, debug builds only: --alloc-check [frames]
+    if (argc >= 2 && std::string(argv[1]) == "--alloc-check")
+    {
+        if (!AllocationCounter::isEnabled())
+        {
+            std::cerr << "--alloc-check needs a debug build" << std::endl;
+            return EXIT_FAILURE;
+        }
+        engineCore.enableAllocationCheck(argc >= 3 ? static_cast<uint32_t>(std::max(1, std::atoi(argv[2]))) : 1000u);
+    }
+
     try 
     {
         engineCore.run();
@@ -21,5 +118,5 @@ int main()
         return EXIT_FAILURE;
     }
 
-    return EXIT_SUCCESS;
+    return engineCore.exitCode();
 }
\ No newline at end of file
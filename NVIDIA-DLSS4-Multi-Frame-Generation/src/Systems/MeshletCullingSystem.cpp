@@ -0,0 +1,243 @@
+#include "MeshletCullingSystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+
+namespace Engine
+{
+    namespace
+    {
+        // Guaranteed minimum of maxComputeWorkGroupCount on every axis
+        constexpr uint32_t MAX_DISPATCH = 65535;
+
+        // Matches Instance in MeshletCull.comp. Planes and camera are in the object's model space
+        struct CullInstance
+        {
+            glm::vec4 m_planes[6];
+            glm::vec4 m_camera;
+            uint32_t m_outputOffset;
+            uint32_t m_commandIndex;
+            uint32_t m_padding[2];
+        };
+        static_assert(sizeof(CullInstance) == 128, "CullInstance must match the std430 layout in MeshletCull.comp");
+
+        struct CullPushConstantData
+        {
+            uint32_t m_meshletCount;
+            uint32_t m_firstInstance;
+            uint32_t m_indexIs16Bit;
+            uint32_t m_coneCulling;
+        };
+
+        // Gribb/Hartmann plane extraction for 0..1 depth, normalised so the sphere test is in model units
+        void extractFrustumPlanes(const glm::mat4& _clipFromModel, glm::vec4 _outPlanes[6])
+        {
+            auto row = [&_clipFromModel](int _i) { return glm::vec4(_clipFromModel[0][_i], _clipFromModel[1][_i], _clipFromModel[2][_i], _clipFromModel[3][_i]); };
+            const glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+
+            _outPlanes[0] = w + x;
+            _outPlanes[1] = w - x;
+            _outPlanes[2] = w + y;
+            _outPlanes[3] = w - y;
+            _outPlanes[4] = z;
+            _outPlanes[5] = w - z;
+            for (int i = 0; i < 6; i++)
+            {
+                float length = glm::length(glm::vec3(_outPlanes[i]));
+                if (length > 0.0f) _outPlanes[i] /= length;
+            }
+        }
+    }
+
+    MeshletCullingSystem::MeshletCullingSystem(EngineDevice& _device)
+        : m_device(_device)
+    {
+        createPipelineLayout();
+        createPipeline();
+    }
+
+    MeshletCullingSystem::~MeshletCullingSystem()
+    {
+        vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
+    }
+
+    void MeshletCullingSystem::createPipelineLayout()
+    {
+        m_setLayout =
+            DescriptorSetLayout::Builder(m_device)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Meshlets
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Model indices
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Instances
+            .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Compacted indices
+            .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Draw commands
+            .build();
+
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(CullPushConstantData);
+
+        VkDescriptorSetLayout setLayout = m_setLayout->getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(m_device.device(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create meshlet culling pipeline layout!");
+    }
+
+    void MeshletCullingSystem::createPipeline()
+    {
+        assert(m_pipelineLayout != nullptr && "Cannot create compute pipeline: No pipelineLayout provided");
+
+        m_pipeline = std::make_unique<Pipeline>(m_device, "Shaders/MeshletCull.comp.spv", m_pipelineLayout);
+    }
+
+    void MeshletCullingSystem::reserve(std::unique_ptr<Buffer>& _buffer, VkDeviceSize _elementSize, uint32_t _count, VkBufferUsageFlags _usage, VkMemoryPropertyFlags _properties)
+    {
+        if (_buffer && _buffer->getInstanceCount() >= _count) return;
+
+        // Grow geometrically so a scene that keeps adding objects doesn't reallocate every frame
+        uint32_t capacity = _buffer ? _buffer->getInstanceCount() : 64;
+        while (capacity < _count)
+            capacity = capacity > UINT32_MAX / 2 ? _count : capacity * 2;
+
+        _buffer = std::make_unique<Buffer>(m_device, _elementSize, capacity, _usage, _properties, 1, ResourceTag::Other);
+        if (_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+            _buffer->map();
+    }
+
+    void MeshletCullingSystem::cull(FrameInfo& _frameInfo)
+    {
+        FrameResources& frame = m_frames[_frameInfo.m_frameIndex];
+        GameObject::Map& objects = _frameInfo.m_gameObjects;
+        frame.m_drawSlots.assign(objects.size(), UINT32_MAX);
+
+        m_candidates.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(objects.size()); i++)
+        {
+            const GameObject& obj = objects.data()[i];
+            if (!obj.m_meshletCulling || obj.m_model == nullptr || !obj.m_model->hasMeshlets()) continue;
+            if (obj.m_model->getMeshletCount() > MAX_DISPATCH) continue;
+            // Meshlets only cover LOD 0, coarser levels are cheap enough to draw whole
+            if (_frameInfo.selectLod(objects.data()[i]) != 0) continue;
+            m_candidates.push_back({ obj.m_model.get(), i, 0 });
+        }
+        if (m_candidates.empty()) return;
+
+        // One dispatch per model, so group the instances of each
+        std::sort(m_candidates.begin(), m_candidates.end(),
+            [](const Candidate& _a, const Candidate& _b) { return std::less<Model*>()(_a.m_model, _b.m_model); });
+
+        // Each object gets room for all of its LOD 0 indices, whatever survives is packed at the front
+        uint32_t outputCount = 0;
+        size_t kept = 0;
+        for (const Candidate& candidate : m_candidates)
+        {
+            const uint32_t indexCount = candidate.m_model->getTriangleCount(0) * 3;
+            if (indexCount > MAX_OUTPUT_INDICES - outputCount) continue;
+            m_candidates[kept] = candidate;
+            m_candidates[kept].m_outputOffset = outputCount;
+            outputCount += indexCount;
+            kept++;
+        }
+        m_candidates.resize(kept);
+        if (m_candidates.empty()) return;
+
+        const uint32_t instanceCount = static_cast<uint32_t>(m_candidates.size());
+        const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        reserve(frame.m_instances, sizeof(CullInstance), instanceCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible);
+        reserve(frame.m_commands, sizeof(VkDrawIndexedIndirectCommand), instanceCount,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, hostVisible);
+        reserve(frame.m_indices, sizeof(uint32_t), outputCount,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        auto* instances = static_cast<CullInstance*>(frame.m_instances->getMappedMemory());
+        auto* commands = static_cast<VkDrawIndexedIndirectCommand*>(frame.m_commands->getMappedMemory());
+        const glm::mat4 clipFromWorld = _frameInfo.m_camera.getProjectionMatrix() * _frameInfo.m_camera.getViewMatrix();
+        const glm::vec4 cameraPosition{ _frameInfo.m_camera.getPosition(), 1.0f };
+
+        for (uint32_t k = 0; k < instanceCount; k++)
+        {
+            const Candidate& candidate = m_candidates[k];
+            GameObject& obj = objects.data()[candidate.m_objectIndex];
+            const glm::mat4 worldFromModel = obj.m_transform.mat4();
+
+            CullInstance& instance = instances[k];
+            extractFrustumPlanes(clipFromWorld * worldFromModel, instance.m_planes);
+            instance.m_camera = glm::inverse(worldFromModel) * cameraPosition;
+            instance.m_outputOffset = candidate.m_outputOffset;
+            instance.m_commandIndex = k;
+
+            // indexCount is accumulated by the shader
+            commands[k] = VkDrawIndexedIndirectCommand{ 0, 1, candidate.m_outputOffset, 0, 0 };
+            frame.m_drawSlots[candidate.m_objectIndex] = k;
+        }
+
+        VkCommandBuffer commandBuffer = _frameInfo.m_commandBuffer;
+        m_pipeline->bind(commandBuffer);
+
+        VkDescriptorBufferInfo instanceInfo = frame.m_instances->descriptorInfo();
+        VkDescriptorBufferInfo outputInfo = frame.m_indices->descriptorInfo();
+        VkDescriptorBufferInfo commandInfo = frame.m_commands->descriptorInfo();
+
+        for (uint32_t first = 0; first < instanceCount;)
+        {
+            Model* model = m_candidates[first].m_model;
+            uint32_t end = first + 1;
+            while (end < instanceCount && m_candidates[end].m_model == model && end - first < MAX_DISPATCH)
+                end++;
+
+            VkDescriptorBufferInfo meshletInfo = model->getMeshletBuffer().descriptorInfo();
+            VkDescriptorBufferInfo indexInfo = model->getIndexBuffer().descriptorInfo();
+            VkDescriptorSet descriptorSet;
+            DescriptorWriter(*m_setLayout, _frameInfo.m_frameDescriptorPool, &_frameInfo.m_frameArena)
+                .writeBuffer(0, &meshletInfo)
+                .writeBuffer(1, &indexInfo)
+                .writeBuffer(2, &instanceInfo)
+                .writeBuffer(3, &outputInfo)
+                .writeBuffer(4, &commandInfo)
+                .build(descriptorSet);
+
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+
+            CullPushConstantData push{};
+            push.m_meshletCount = model->getMeshletCount();
+            push.m_firstInstance = first;
+            push.m_indexIs16Bit = model->getIndexType() == VK_INDEX_TYPE_UINT16 ? 1 : 0;
+            push.m_coneCulling = m_coneCulling ? 1 : 0;
+            vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstantData), &push);
+
+            // One workgroup per meshlet and instance
+            vkCmdDispatch(commandBuffer, push.m_meshletCount, end - first, 1);
+            first = end;
+        }
+
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    bool MeshletCullingSystem::drawCulled(FrameInfo& _frameInfo, const GameObject& _obj)
+    {
+        FrameResources& frame = m_frames[_frameInfo.m_frameIndex];
+        GameObject::Map& objects = _frameInfo.m_gameObjects;
+        if (!_obj.m_meshletCulling || objects.size() == 0) return false;
+
+        const size_t objectIndex = static_cast<size_t>(&_obj - objects.data());
+        if (objectIndex >= frame.m_drawSlots.size() || frame.m_drawSlots[objectIndex] == UINT32_MAX) return false;
+
+        const VkDeviceSize commandOffset = VkDeviceSize(frame.m_drawSlots[objectIndex]) * sizeof(VkDrawIndexedIndirectCommand);
+        vkCmdBindIndexBuffer(_frameInfo.m_commandBuffer, frame.m_indices->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+        vkCmdDrawIndexedIndirect(_frameInfo.m_commandBuffer, frame.m_commands->getBuffer(), commandOffset, 1, sizeof(VkDrawIndexedIndirectCommand));
+        return true;
+    }
+}
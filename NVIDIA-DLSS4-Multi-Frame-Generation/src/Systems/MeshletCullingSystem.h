@@ -0,0 +1,70 @@
+#pragma once
+#include "..\Engine\Pipeline.h"
+#include "..\Engine\GameObject.h"
+#include "..\Engine\FrameInfo.h"
+#include "..\Engine\Buffer.h"
+#include "..\Engine\SwapChain.h"
+
+#include <array>
+
+namespace Engine
+{
+    /*
+     * Culls meshlets of opted-in GameObjects (m_meshletCulling) on the GPU. A compute pass tests
+     * each meshlet against the frustum and its normal cone and appends the survivors' indices to
+     * a per frame index stream, with one indirect draw per object. Plain compute and
+     * vkCmdDrawIndexedIndirect, so it needs no mesh shader support and runs under lavapipe.
+     */
+    struct MeshletCullingSystem
+    {
+        // Compacted indices per frame (64 MB). Objects that don't fit are drawn unculled
+        static constexpr uint32_t MAX_OUTPUT_INDICES = 16 * 1024 * 1024;
+
+        MeshletCullingSystem(EngineDevice& _device);
+        ~MeshletCullingSystem();
+        MeshletCullingSystem(const MeshletCullingSystem&) = delete;
+        MeshletCullingSystem& operator=(const MeshletCullingSystem&) = delete;
+
+        // Records the culling dispatches, call before the render pass begins
+        void cull(FrameInfo& _frameInfo);
+
+        // Draws _obj from this frame's compacted stream, with the model's vertex buffers already bound.
+        // Returns false when the object wasn't culled this frame and should be drawn normally
+        bool drawCulled(FrameInfo& _frameInfo, const GameObject& _obj);
+
+        // The engine's pipelines draw both faces, so cone culling is opt-in
+        void setConeCulling(bool _enabled) { m_coneCulling = _enabled; }
+
+    private:
+        struct Candidate
+        {
+            Model* m_model;
+            uint32_t m_objectIndex; // Dense index in the GameObject map
+            uint32_t m_outputOffset;
+        };
+
+        struct FrameResources
+        {
+            std::unique_ptr<Buffer> m_instances; // Host visible, written each frame
+            std::unique_ptr<Buffer> m_commands;  // Host visible, indexCount accumulated by the shader
+            std::unique_ptr<Buffer> m_indices;   // Device local compacted index stream
+            std::vector<uint32_t> m_drawSlots;   // Object index to command index, UINT32_MAX if not culled
+        };
+
+        void createPipelineLayout();
+        void createPipeline();
+        // Reallocates _buffer when it holds fewer than _count elements. The frame slot's previous
+        // submission has retired by the time cull() runs, so the old buffer can go immediately
+        void reserve(std::unique_ptr<Buffer>& _buffer, VkDeviceSize _elementSize, uint32_t _count, VkBufferUsageFlags _usage, VkMemoryPropertyFlags _properties);
+
+        std::unique_ptr<Pipeline> m_pipeline;
+        VkPipelineLayout m_pipelineLayout;
+        std::unique_ptr<DescriptorSetLayout> m_setLayout;
+
+        std::array<FrameResources, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frames;
+        std::vector<Candidate> m_candidates;
+        bool m_coneCulling = false;
+
+        EngineDevice& m_device;
+    };
+}
@@ -3,7 +3,7 @@
 #include <glm/gtc/constants.hpp>
 
 #include <stdexcept>
-#include <map>
+#include <algorithm>
 
 namespace Engine
 {
@@ -52,8 +52,7 @@ namespace Engine
         PipelineConfigInfo pipelineConfig = {};
         Pipeline::defaultPipelineConfigInfo(pipelineConfig);
         Pipeline::enableAlphaBlending(pipelineConfig);
-        pipelineConfig.m_attributeDescriptions.clear();
-        pipelineConfig.m_bindingDescriptions.clear();
+        Pipeline::clearVertexInput(pipelineConfig);
         pipelineConfig.m_renderPass = _renderPass;
         pipelineConfig.m_pipelineLayout = m_pipelineLayout;
 
@@ -68,27 +67,16 @@ namespace Engine
         m_pipeline = std::make_unique<Pipeline>(m_device, "Shaders/PointLight.vert.spv", "Shaders/PointLight.frag.spv", pipelineConfig);
     }
 
-    void PointLightSystem::update(FrameInfo& _frameInfo, GlobalUbo& _globalUbo, bool _rotate)
+    void PointLightSystem::update(FrameInfo& _frameInfo, GlobalUbo& _globalUbo)
     {
-        float rotateAngle = _rotate ? _frameInfo.m_frameTime : 0;
-        auto rotateLight = glm::rotate(
-            glm::mat4(1.0f),
-            rotateAngle,
-            glm::vec3(0.0f, -1.0f, 0.0f)
-        );
-
         int lightIndex = 0;
-        for (auto& keyValue : _frameInfo.m_gameObjects)
+        for (GameObject& gameObject : _frameInfo.m_gameObjects)
         {
-            GameObject& gameObject = keyValue.second;
             if (gameObject.m_pointLight == nullptr) continue;
 
             assert(lightIndex < MAX_LIGHTS && "Exceeded maximum number of point lights!");
 
-            // Update light pos
-            gameObject.m_transform.m_translation = glm::vec3(rotateLight * glm::vec4(gameObject.m_transform.m_translation, 1.0f));
-
-            // Copt light to ubo
+            // Copy light to ubo
             _globalUbo.m_pointLights[lightIndex].m_position = glm::vec4(gameObject.m_transform.m_translation, 1.0f);
             _globalUbo.m_pointLights[lightIndex].m_color = glm::vec4(gameObject.m_colour, gameObject.m_pointLight->m_intensity);
 
@@ -99,17 +87,19 @@ namespace Engine
 
     void PointLightSystem::render(FrameInfo& _frameInfo)
     {
-        // Sort lights
-        std::map<float, GameObject::id_t> sortedLights;
-        for (auto& keyValue : _frameInfo.m_gameObjects)
+        // Sort lights, furthest first for blending. Lives in the frame arena so there is no per-frame heap allocation
+        ArenaVector<std::pair<float, GameObject*>> sortedLights{ ArenaAllocator<std::pair<float, GameObject*>>(&_frameInfo.m_frameArena) };
+        sortedLights.reserve(MAX_LIGHTS);
+        for (GameObject& gameObject : _frameInfo.m_gameObjects)
         {
-            GameObject& gameObject = keyValue.second;
             if (gameObject.m_pointLight == nullptr) continue;
 
             auto offset = _frameInfo.m_camera.getPosition() - gameObject.m_transform.m_translation;
             float distanceSquared = glm::dot(offset, offset);
-            sortedLights[distanceSquared] = gameObject.getId();
+            sortedLights.emplace_back(distanceSquared, &gameObject);
         }
+        std::sort(sortedLights.begin(), sortedLights.end(), 
+            [](const auto& _a, const auto& _b) { return _a.first > _b.first; });
 
         m_pipeline->bind(_frameInfo.m_commandBuffer);
 
@@ -122,10 +112,10 @@ namespace Engine
             0, nullptr
         );
 
-        // Iterate through sorted lights in reverse order (furthest to closest)
-        for (auto it = sortedLights.rbegin(); it != sortedLights.rend(); ++it)
+        // Iterate through sorted lights (furthest to closest)
+        for (auto& [distanceSquared, light] : sortedLights)
         {
-            GameObject& gameObject = _frameInfo.m_gameObjects.at(it->second);
+            GameObject& gameObject = *light;
 
             PointLightPushConstants pushConstants = {};
             pushConstants.m_position = glm::vec4(gameObject.m_transform.m_translation, 1.0f);
@@ -12,7 +12,8 @@ namespace Engine
         PointLightSystem(const PointLightSystem&) = delete;
         PointLightSystem& operator=(const PointLightSystem&) = delete;
 
-        void update(FrameInfo& _frameInfo, GlobalUbo& _globalUbo, bool _rotate);
+        // Copies the lights into the UBO. They are moved by the Simulation
+        void update(FrameInfo& _frameInfo, GlobalUbo& _globalUbo);
         void render(FrameInfo& _frameInfo);
 
     private:
@@ -4,6 +4,7 @@
 
 #include <stdexcept>
 #include "TextureRenderSystem.h"
+#include "MeshletCullingSystem.h"
 
 namespace Engine
 {
@@ -79,20 +80,24 @@ namespace Engine
             0, nullptr
         );
 
-        for (auto& keyValue : _frameInfo.m_gameObjects)
+        for (GameObject& obj : _frameInfo.m_gameObjects)
         {
-            GameObject& obj = keyValue.second;
             if (obj.m_model == nullptr || obj.m_diffuseMap != nullptr) continue;
 
             SimplePushConstantData push = {};
-            push.m_modelMatrix = obj.m_transform.mat4();
+            const glm::mat4& dequantize = obj.m_model->getDequantizeMatrix();
+            push.m_modelMatrix = obj.m_transform.mat4() * dequantize;
             push.m_normalMatrix = obj.m_transform.normalMatrix();
-            push.m_prevModelMatrix = obj.m_transform.m_prevModelMatrix;
+            push.m_prevModelMatrix = obj.m_transform.m_prevModelMatrix * dequantize;
 
             vkCmdPushConstants(_frameInfo.m_commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &push);
 
+            const uint32_t lod = _frameInfo.selectLod(obj);
+            _frameInfo.m_trianglesSubmitted += obj.m_model->getTriangleCount(lod);
+
             obj.m_model->bind(_frameInfo.m_commandBuffer);
-            obj.m_model->draw(_frameInfo.m_commandBuffer);
+            if (lod != 0 || _frameInfo.m_meshletCulling == nullptr || !_frameInfo.m_meshletCulling->drawCulled(_frameInfo, obj))
+                obj.m_model->draw(_frameInfo.m_commandBuffer, lod);
         }
     }
 }
\ No newline at end of file
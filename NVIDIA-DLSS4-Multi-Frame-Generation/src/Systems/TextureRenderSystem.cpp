@@ -1,4 +1,5 @@
 #include "TextureRenderSystem.h"
+#include "MeshletCullingSystem.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -100,15 +101,13 @@ namespace Engine
             nullptr
         );
 
-        for (auto& kv : _frameInfo.m_gameObjects) 
+        for (GameObject& obj : _frameInfo.m_gameObjects)
         {
-            auto& obj = kv.second;
-
             if (obj.m_model == nullptr || obj.m_diffuseMap == nullptr) continue;
 
             auto imageInfo = obj.m_diffuseMap->getImageInfo();
             VkDescriptorSet descriptorSet1;
-            DescriptorWriter(*m_renderSystemLayout, _frameInfo.m_frameDescriptorPool)
+            DescriptorWriter(*m_renderSystemLayout, _frameInfo.m_frameDescriptorPool, &_frameInfo.m_frameArena)
                 .writeImage(0, &imageInfo)
                 .build(descriptorSet1);
 
@@ -124,9 +123,10 @@ namespace Engine
             );
 
             TexturePushConstantData push{};
-            push.m_modelMatrix = obj.m_transform.mat4();
+            const glm::mat4& dequantize = obj.m_model->getDequantizeMatrix();
+            push.m_modelMatrix = obj.m_transform.mat4() * dequantize;
             push.m_normalMatrix = obj.m_transform.normalMatrix();
-            push.m_prevModelMatrix = obj.m_transform.m_prevModelMatrix;
+            push.m_prevModelMatrix = obj.m_transform.m_prevModelMatrix * dequantize;
 
             vkCmdPushConstants(
                 _frameInfo.m_commandBuffer,
@@ -137,8 +137,12 @@ namespace Engine
                 &push
             );
 
+            const uint32_t lod = _frameInfo.selectLod(obj);
+            _frameInfo.m_trianglesSubmitted += obj.m_model->getTriangleCount(lod);
+
             obj.m_model->bind(_frameInfo.m_commandBuffer);
-            obj.m_model->draw(_frameInfo.m_commandBuffer);
+            if (lod != 0 || _frameInfo.m_meshletCulling == nullptr || !_frameInfo.m_meshletCulling->drawCulled(_frameInfo, obj))
+                obj.m_model->draw(_frameInfo.m_commandBuffer, lod);
         }
     }
 }
\ No newline at end of file